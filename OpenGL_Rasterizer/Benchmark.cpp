@@ -0,0 +1,256 @@
+#include "Benchmark.h"
+#include "RenderState.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <thread>
+
+// milliseconds between two steady clock points
+static double elapsedMs(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+// escapes the characters JSON doesn't allow raw inside a string, windows paths have backslashes
+static std::string escapeJson(const std::string& text) {
+    std::string escaped;
+    for (char c : text) {
+        if (c == '\\' || c == '"') {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+// writes min/mean/percentiles of a set of timings as a JSON object, negative (missing) values are skipped
+static void writeStats(std::ofstream& stream, const std::string& name, std::vector<double> values, const char* indent = "  ") {
+    values.erase(std::remove_if(values.begin(), values.end(), [](double v) { return v < 0.0; }), values.end());
+    stream << indent << "\"" << escapeJson(name) << "\": {";
+    if (values.empty()) {
+        stream << "}";
+        return;
+    }
+    std::sort(values.begin(), values.end());
+    double sum = 0.0;
+    for (double v : values) {
+        sum += v;
+    }
+    // nearest rank percentile
+    auto percentile = [&values](double p) {
+        size_t rank = (size_t)std::ceil(p / 100.0 * values.size());
+        return values[rank == 0 ? 0 : rank - 1];
+    };
+    stream << "\"min\": " << values.front() << ", \"mean\": " << sum / values.size() << ", \"p50\": " << percentile(50.0)
+        << ", \"p95\": " << percentile(95.0) << ", \"p99\": " << percentile(99.0) << ", \"max\": " << values.back() << "}";
+}
+
+Benchmark::Benchmark() : totalSeconds(0.0) {
+    for (unsigned int i = 0; i < QUERY_FRAMES; i++) {
+        glGenQueries(2, queries[i]);
+        queryFrame[i] = -1;
+    }
+}
+
+Benchmark::~Benchmark() {
+    for (unsigned int i = 0; i < QUERY_FRAMES; i++) {
+        glDeleteQueries(2, queries[i]);
+    }
+}
+
+void Benchmark::collectQuery(unsigned int slot, bool wait) {
+    if (queryFrame[slot] < 0) {
+        return;
+    }
+    if (!wait) {
+        GLint available = 0;
+        glGetQueryObjectiv(queries[slot][1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) {
+            return;
+        }
+    }
+    GLuint64 start = 0, end = 0;
+    glGetQueryObjectui64v(queries[slot][0], GL_QUERY_RESULT, &start);
+    glGetQueryObjectui64v(queries[slot][1], GL_QUERY_RESULT, &end);
+    samples[queryFrame[slot]].gpuMs = (end - start) / 1.0e6;
+    queryFrame[slot] = -1;
+}
+
+void Benchmark::BeginFrame() {
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (samples.empty()) {
+        runStart = now;
+    }
+    else {
+        samples.back().frameMs = elapsedMs(frameStart, now);
+    }
+    frameStart = now;
+    samples.push_back({ 0.0, 0.0, -1.0, 0, 0, 0, 0 });
+
+    // the slot was last used QUERY_FRAMES frames ago, so this only blocks if the GPU is that far behind
+    unsigned int slot = (samples.size() - 1) % QUERY_FRAMES;
+    collectQuery(slot, true);
+    glQueryCounter(queries[slot][0], GL_TIMESTAMP);
+}
+
+void Benchmark::EndCpu() {
+    samples.back().cpuMs = elapsedMs(frameStart, std::chrono::steady_clock::now());
+    RenderStateStats stats = RenderState::Stats();
+    samples.back().stateChangesIssued = stats.issued;
+    samples.back().stateChangesElided = stats.elided;
+}
+
+void Benchmark::SetCullCounts(unsigned int visible, unsigned int culled) {
+    samples.back().objectsVisible = visible;
+    samples.back().objectsCulled = culled;
+}
+
+void Benchmark::EndFrame() {
+    unsigned int slot = (samples.size() - 1) % QUERY_FRAMES;
+    glQueryCounter(queries[slot][1], GL_TIMESTAMP);
+    queryFrame[slot] = (int)samples.size() - 1;
+
+    // pick up any older frames whose results already arrived
+    for (unsigned int i = 0; i < QUERY_FRAMES; i++) {
+        if (i != slot) {
+            collectQuery(i, false);
+        }
+    }
+}
+
+void Benchmark::Finish() {
+    glFinish();
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (!samples.empty()) {
+        samples.back().frameMs = elapsedMs(frameStart, now);
+        totalSeconds = elapsedMs(runStart, now) / 1000.0;
+    }
+    for (unsigned int i = 0; i < QUERY_FRAMES; i++) {
+        collectQuery(i, true);
+    }
+}
+
+const std::vector<FrameSample>& Benchmark::Samples() const {
+    return samples;
+}
+
+void Benchmark::AddSetting(const std::string& name, const std::string& value) {
+    settings.push_back(std::make_pair(name, value));
+}
+
+void Benchmark::AddMeshReport(const MeshOptimizeReport& report) {
+    meshReports.push_back(report);
+}
+
+bool Benchmark::WriteReport(const std::string& filepath, const std::string& pathName, unsigned int width, unsigned int height, const GpuProfiler& profiler) const {
+    std::ofstream stream(filepath);
+    if (!stream) {
+        return false;
+    }
+
+    std::vector<double> frameMs, cpuMs, gpuMs, issued, elided, objectsVisible, objectsCulled;
+    for (const FrameSample& sample : samples) {
+        frameMs.push_back(sample.frameMs);
+        cpuMs.push_back(sample.cpuMs);
+        gpuMs.push_back(sample.gpuMs);
+        issued.push_back(sample.stateChangesIssued);
+        elided.push_back(sample.stateChangesElided);
+        objectsVisible.push_back(sample.objectsVisible);
+        objectsCulled.push_back(sample.objectsCulled);
+    }
+
+    stream << "{\n";
+    stream << "  \"camera_path\": \"" << escapeJson(pathName) << "\",\n";
+    stream << "  \"width\": " << width << ",\n";
+    stream << "  \"height\": " << height << ",\n";
+    stream << "  \"frames\": " << samples.size() << ",\n";
+    stream << "  \"total_seconds\": " << totalSeconds << ",\n";
+    stream << "  \"settings\": {";
+    for (size_t i = 0; i < settings.size(); i++) {
+        stream << (i == 0 ? "" : ", ") << "\"" << escapeJson(settings[i].first) << "\": \"" << escapeJson(settings[i].second) << "\"";
+    }
+    stream << "},\n";
+    stream << "  \"fps\": " << (totalSeconds > 0.0 ? samples.size() / totalSeconds : 0.0) << ",\n";
+    writeStats(stream, "frame_ms", frameMs);
+    stream << ",\n";
+    writeStats(stream, "cpu_ms", cpuMs);
+    stream << ",\n";
+    writeStats(stream, "gpu_ms", gpuMs);
+    stream << ",\n";
+    stream << "  \"gpu_passes\": {\n";
+    const std::vector<std::string>& passes = profiler.PassNames();
+    for (size_t i = 0; i < passes.size(); i++) {
+        writeStats(stream, passes[i], profiler.History(passes[i]), "    ");
+        stream << (i + 1 < passes.size() ? ",\n" : "\n");
+    }
+    stream << "  },\n";
+    stream << "  \"gpu_dropped_frames\": " << profiler.DroppedFrames() << ",\n";
+    writeStats(stream, "state_changes_issued", issued);
+    stream << ",\n";
+    writeStats(stream, "state_changes_elided", elided);
+    stream << ",\n";
+    writeStats(stream, "objects_visible", objectsVisible);
+    stream << ",\n";
+    writeStats(stream, "objects_culled", objectsCulled);
+    stream << ",\n";
+    stream << "  \"meshes\": [\n";
+    for (size_t i = 0; i < meshReports.size(); i++) {
+        const MeshOptimizeReport& mesh = meshReports[i];
+        stream << "    {\"name\": \"" << escapeJson(mesh.name) << "\", \"vertices\": " << mesh.vertexCount << ", \"triangles\": " << mesh.triangleCount
+            << ", \"acmr_before\": " << mesh.before.acmr << ", \"acmr_after\": " << mesh.after.acmr
+            << ", \"atvr_before\": " << mesh.before.atvr << ", \"atvr_after\": " << mesh.after.atvr << "}"
+            << (i + 1 < meshReports.size() ? ",\n" : "\n");
+    }
+    stream << "  ],\n";
+    stream << "  \"samples\": [\n";
+    for (size_t i = 0; i < samples.size(); i++) {
+        stream << "    {\"frame_ms\": " << samples[i].frameMs << ", \"cpu_ms\": " << samples[i].cpuMs << ", \"gpu_ms\": " << samples[i].gpuMs
+            << ", \"state_changes_issued\": " << samples[i].stateChangesIssued << ", \"state_changes_elided\": " << samples[i].stateChangesElided
+            << ", \"objects_visible\": " << samples[i].objectsVisible << ", \"objects_culled\": " << samples[i].objectsCulled << "}"
+            << (i + 1 < samples.size() ? ",\n" : "\n");
+    }
+    stream << "  ]\n";
+    stream << "}\n";
+    return stream.good();
+}
+
+bool WriteThreadScalingReport(const std::string& filepath, const std::string& pathName, unsigned int width, unsigned int height,
+    const std::vector<std::pair<std::string, std::string>>& settings, const std::vector<ThreadScalingRun>& runs) {
+    std::ofstream stream(filepath);
+    if (!stream) {
+        return false;
+    }
+    stream << "{\n";
+    stream << "  \"camera_path\": \"" << escapeJson(pathName) << "\",\n";
+    stream << "  \"width\": " << width << ",\n";
+    stream << "  \"height\": " << height << ",\n";
+    stream << "  \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n";
+    stream << "  \"settings\": {";
+    for (size_t i = 0; i < settings.size(); i++) {
+        stream << (i == 0 ? "" : ", ") << "\"" << escapeJson(settings[i].first) << "\": \"" << escapeJson(settings[i].second) << "\"";
+    }
+    stream << "},\n";
+    stream << "  \"runs\": [\n";
+    double baseSeconds = runs.empty() ? 0.0 : runs.front().totalSeconds;
+    for (size_t i = 0; i < runs.size(); i++) {
+        const ThreadScalingRun& run = runs[i];
+        double fps = run.totalSeconds > 0.0 ? run.frameMs.size() / run.totalSeconds : 0.0;
+        stream << "    {\n";
+        stream << "      \"threads\": " << run.threads << ",\n";
+        stream << "      \"frames\": " << run.frameMs.size() << ",\n";
+        stream << "      \"total_seconds\": " << run.totalSeconds << ",\n";
+        stream << "      \"fps\": " << fps << ",\n";
+        stream << "      \"speedup\": " << (run.totalSeconds > 0.0 ? baseSeconds / run.totalSeconds : 0.0) << ",\n";
+        stream << "      \"steals\": " << run.steals << ",\n";
+        stream << "      \"matches_single_thread\": " << (run.matchesSingleThread ? "true" : "false") << ",\n";
+        writeStats(stream, "frame_ms", run.frameMs, "      ");
+        stream << ",\n";
+        writeStats(stream, "geometry_ms", run.geometryMs, "      ");
+        stream << ",\n";
+        writeStats(stream, "tiles_ms", run.tilesMs, "      ");
+        stream << "\n    }" << (i + 1 < runs.size() ? ",\n" : "\n");
+    }
+    stream << "  ]\n";
+    stream << "}\n";
+    return stream.good();
+}
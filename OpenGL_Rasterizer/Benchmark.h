@@ -0,0 +1,72 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <glad/glad.h>
+
+#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "GpuProfiler.h"
+#include "MeshOptimizer.h"
+
+// timings for one rendered frame, all in milliseconds
+struct FrameSample {
+    double frameMs; // wall time from the start of this frame to the start of the next
+    double cpuMs; // time the CPU spent building and submitting the frame
+    double gpuMs; // GPU time between the first and last command of the frame, -1 until its query is read back
+    unsigned int stateChangesIssued; // binds that reached the driver, from RenderState
+    unsigned int stateChangesElided; // redundant binds RenderState skipped
+    unsigned int objectsVisible; // objects that passed frustum culling
+    unsigned int objectsCulled;
+};
+
+// one replay of the camera path by the software renderer at a fixed thread count
+struct ThreadScalingRun {
+    unsigned int threads;
+    double totalSeconds;
+    std::vector<double> frameMs;
+    std::vector<double> geometryMs; // per frame wall times of the two parallel phases, see SoftwareRenderStats
+    std::vector<double> tilesMs;
+    unsigned int steals; // over the whole run
+    bool matchesSingleThread; // the last frame came out byte for byte the same as with one thread
+};
+
+// collects per frame CPU/GPU timings during a benchmark run and writes the summary as JSON
+// GPU time comes from GL_TIMESTAMP queries kept in a small ring, so results are read back a few frames late instead of stalling
+class Benchmark {
+private:
+    static const unsigned int QUERY_FRAMES = 4;
+    unsigned int queries[QUERY_FRAMES][2]; // start and end timestamp per frame in flight
+    int queryFrame[QUERY_FRAMES]; // frame index the slot is waiting on, -1 if free
+    std::vector<FrameSample> samples;
+    std::chrono::steady_clock::time_point frameStart;
+    std::chrono::steady_clock::time_point runStart;
+    double totalSeconds;
+    std::vector<MeshOptimizeReport> meshReports;
+    std::vector<std::pair<std::string, std::string>> settings;
+
+    void collectQuery(unsigned int slot, bool wait); // stores the GPU time of a slot if it's ready (or waits for it)
+public:
+    Benchmark(); // constructor, needs a current GL context
+    ~Benchmark(); // destructor
+
+    // methods
+    void BeginFrame(); // call before the first GL command of a frame
+    void EndCpu(); // call once everything for the frame has been submitted, also records RenderState's counters
+    void EndFrame(); // call after the last GL command of a frame
+    void SetCullCounts(unsigned int visible, unsigned int culled); // for the current frame
+    void Finish(); // waits for outstanding queries, call after the last frame
+    const std::vector<FrameSample>& Samples() const;
+    void AddSetting(const std::string& name, const std::string& value); // written under "settings" so runs with different options can be told apart
+    void AddMeshReport(const MeshOptimizeReport& report); // vertex cache stats of a mesh optimized at load, written under "meshes"
+    // the profiler's per pass history is added to the report as gpu_passes
+    bool WriteReport(const std::string& filepath, const std::string& pathName, unsigned int width, unsigned int height, const GpuProfiler& profiler) const;
+};
+
+// the --software benchmark report, the same frames rendered once per thread count with the speedup over the first run, no GL needed
+bool WriteThreadScalingReport(const std::string& filepath, const std::string& pathName, unsigned int width, unsigned int height,
+    const std::vector<std::pair<std::string, std::string>>& settings, const std::vector<ThreadScalingRun>& runs);
+
+#endif
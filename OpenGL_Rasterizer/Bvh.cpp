@@ -0,0 +1,421 @@
+#include "Bvh.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+const int Bvh::NONE; // objectLeaves.assign/resize take it by reference
+
+static float surfaceArea(const glm::vec3& boundsMin, const glm::vec3& boundsMax) {
+    glm::vec3 size = boundsMax - boundsMin;
+    return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+// slab test, entry distance in entry (0 if the origin is inside), false if the box is missed or only hit past maxDistance
+static bool rayHitsBox(const glm::vec3& boundsMin, const glm::vec3& boundsMax, const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance, float& entry) {
+    float tMin = 0.0f;
+    float tMax = maxDistance;
+    for (int axis = 0; axis < 3; axis++) {
+        float t1 = (boundsMin[axis] - origin[axis]) * inverseDirection[axis];
+        float t2 = (boundsMax[axis] - origin[axis]) * inverseDirection[axis];
+        // fmin/fmax drop the NaN of 0 * inf, when the origin lies on a slab of an axis the ray is parallel to
+        tMin = std::fmax(tMin, std::fmin(t1, t2));
+        tMax = std::fmin(tMax, std::fmax(t1, t2));
+    }
+    entry = tMin;
+    return tMin <= tMax;
+}
+
+Bvh::Bvh() : root(NONE), objectCount(0), stats() {
+}
+
+int Bvh::allocateNode() {
+    int node;
+    if (!freeNodes.empty()) {
+        node = freeNodes.back();
+        freeNodes.pop_back();
+    }
+    else {
+        node = (int)nodes.size();
+        nodes.push_back(Node());
+    }
+    nodes[node].parent = NONE;
+    nodes[node].left = NONE;
+    nodes[node].right = NONE;
+    nodes[node].object = NONE;
+    return node;
+}
+
+void Bvh::freeNode(int node) {
+    freeNodes.push_back(node);
+}
+
+void Bvh::Build(const std::vector<BoundingBox>& boxes) {
+    nodes.clear();
+    freeNodes.clear();
+    objectLeaves.assign(boxes.size(), NONE);
+    root = NONE;
+    objectCount = (unsigned int)boxes.size();
+    if (boxes.empty()) {
+        return;
+    }
+    std::vector<unsigned int> objects(boxes.size());
+    for (unsigned int i = 0; i < objects.size(); i++) {
+        objects[i] = i;
+    }
+    nodes.reserve(2 * boxes.size() - 1);
+    root = buildRange(objects, boxes, 0, (unsigned int)objects.size(), NONE);
+}
+
+// splits objects[first, last) where the binned SAH cost (objects times surface area on each side) is lowest
+// along the axis the centres spread out the most
+int Bvh::buildRange(std::vector<unsigned int>& objects, const std::vector<BoundingBox>& boxes, unsigned int first, unsigned int last, int parent) {
+    int node = allocateNode();
+    nodes[node].parent = parent;
+    if (last - first == 1) {
+        const BoundingBox& box = boxes[objects[first]];
+        nodes[node].boundsMin = box.center - box.extents;
+        nodes[node].boundsMax = box.center + box.extents;
+        nodes[node].object = (int)objects[first];
+        objectLeaves[objects[first]] = node;
+        return node;
+    }
+
+    glm::vec3 centerMin(std::numeric_limits<float>::max());
+    glm::vec3 centerMax(-std::numeric_limits<float>::max());
+    for (unsigned int i = first; i < last; i++) {
+        centerMin = glm::min(centerMin, boxes[objects[i]].center);
+        centerMax = glm::max(centerMax, boxes[objects[i]].center);
+    }
+    glm::vec3 spread = centerMax - centerMin;
+    int axis = spread.x > spread.y ? (spread.x > spread.z ? 0 : 2) : (spread.y > spread.z ? 1 : 2);
+
+    unsigned int middle = (first + last) / 2;
+    if (spread[axis] > 0.0f) {
+        struct Bin {
+            glm::vec3 boundsMin, boundsMax;
+            unsigned int count;
+        };
+        Bin bins[SAH_BINS];
+        for (Bin& bin : bins) {
+            bin.boundsMin = glm::vec3(std::numeric_limits<float>::max());
+            bin.boundsMax = glm::vec3(-std::numeric_limits<float>::max());
+            bin.count = 0;
+        }
+        float binScale = SAH_BINS / spread[axis];
+        auto binOf = [&](unsigned int object) {
+            return std::min(SAH_BINS - 1, (unsigned int)((boxes[object].center[axis] - centerMin[axis]) * binScale));
+        };
+        for (unsigned int i = first; i < last; i++) {
+            const BoundingBox& box = boxes[objects[i]];
+            Bin& bin = bins[binOf(objects[i])];
+            bin.boundsMin = glm::min(bin.boundsMin, box.center - box.extents);
+            bin.boundsMax = glm::max(bin.boundsMax, box.center + box.extents);
+            bin.count++;
+        }
+        // sweep from the right so the cost of every split between bins is known in one more pass from the left
+        float rightCost[SAH_BINS];
+        glm::vec3 sweepMin(std::numeric_limits<float>::max()), sweepMax(-std::numeric_limits<float>::max());
+        unsigned int sweepCount = 0;
+        for (unsigned int b = SAH_BINS - 1; b > 0; b--) {
+            sweepMin = glm::min(sweepMin, bins[b].boundsMin);
+            sweepMax = glm::max(sweepMax, bins[b].boundsMax);
+            sweepCount += bins[b].count;
+            rightCost[b] = sweepCount == 0 ? 0.0f : sweepCount * surfaceArea(sweepMin, sweepMax);
+        }
+        sweepMin = glm::vec3(std::numeric_limits<float>::max());
+        sweepMax = glm::vec3(-std::numeric_limits<float>::max());
+        sweepCount = 0;
+        float bestCost = std::numeric_limits<float>::max();
+        unsigned int bestSplit = 0; // the left side is bins [0, bestSplit]
+        for (unsigned int b = 0; b + 1 < SAH_BINS; b++) {
+            sweepMin = glm::min(sweepMin, bins[b].boundsMin);
+            sweepMax = glm::max(sweepMax, bins[b].boundsMax);
+            sweepCount += bins[b].count;
+            if (sweepCount == 0 || sweepCount == last - first) {
+                continue;
+            }
+            float cost = sweepCount * surfaceArea(sweepMin, sweepMax) + rightCost[b + 1];
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestSplit = b;
+            }
+        }
+        if (bestCost < std::numeric_limits<float>::max()) {
+            middle = (unsigned int)(std::partition(objects.begin() + first, objects.begin() + last,
+                [&](unsigned int object) { return binOf(object) <= bestSplit; }) - objects.begin());
+        }
+    }
+
+    int left = buildRange(objects, boxes, first, middle, node);
+    int right = buildRange(objects, boxes, middle, last, node);
+    nodes[node].left = left;
+    nodes[node].right = right;
+    nodes[node].boundsMin = glm::min(nodes[left].boundsMin, nodes[right].boundsMin);
+    nodes[node].boundsMax = glm::max(nodes[left].boundsMax, nodes[right].boundsMax);
+    return node;
+}
+
+void Bvh::refitAncestors(int node) {
+    while (node != NONE) {
+        int left = nodes[node].left;
+        int right = nodes[node].right;
+        nodes[node].boundsMin = glm::min(nodes[left].boundsMin, nodes[right].boundsMin);
+        nodes[node].boundsMax = glm::max(nodes[left].boundsMax, nodes[right].boundsMax);
+        node = nodes[node].parent;
+    }
+}
+
+// walks down towards the node whose box would grow the least (plus what every ancestor grows by),
+// and puts the new leaf next to it under a new parent
+void Bvh::Insert(unsigned int object, const BoundingBox& box) {
+    if (Contains(object)) {
+        Update(object, box);
+        return;
+    }
+    int leaf = allocateNode();
+    nodes[leaf].boundsMin = box.center - box.extents;
+    nodes[leaf].boundsMax = box.center + box.extents;
+    nodes[leaf].object = (int)object;
+    if (object >= objectLeaves.size()) {
+        objectLeaves.resize(object + 1, NONE);
+    }
+    objectLeaves[object] = leaf;
+    objectCount++;
+    if (root == NONE) {
+        root = leaf;
+        return;
+    }
+
+    glm::vec3 leafMin = nodes[leaf].boundsMin;
+    glm::vec3 leafMax = nodes[leaf].boundsMax;
+    int sibling = root;
+    while (nodes[sibling].left != NONE) {
+        const Node& current = nodes[sibling];
+        float area = surfaceArea(current.boundsMin, current.boundsMax);
+        float combinedArea = surfaceArea(glm::min(current.boundsMin, leafMin), glm::max(current.boundsMax, leafMax));
+        float cost = 2.0f * combinedArea; // pairing the leaf with this whole subtree
+        float inheritance = 2.0f * (combinedArea - area); // every ancestor grows by at least this much
+        auto descendCost = [&](int child) {
+            const Node& node = nodes[child];
+            float grownArea = surfaceArea(glm::min(node.boundsMin, leafMin), glm::max(node.boundsMax, leafMax));
+            return node.left == NONE ? grownArea + inheritance : grownArea - surfaceArea(node.boundsMin, node.boundsMax) + inheritance;
+        };
+        float leftCost = descendCost(current.left);
+        float rightCost = descendCost(current.right);
+        if (cost < leftCost && cost < rightCost) {
+            break;
+        }
+        sibling = leftCost < rightCost ? current.left : current.right;
+    }
+
+    int oldParent = nodes[sibling].parent;
+    int newParent = allocateNode();
+    nodes[newParent].parent = oldParent;
+    nodes[newParent].left = sibling;
+    nodes[newParent].right = leaf;
+    nodes[sibling].parent = newParent;
+    nodes[leaf].parent = newParent;
+    if (oldParent == NONE) {
+        root = newParent;
+    }
+    else if (nodes[oldParent].left == sibling) {
+        nodes[oldParent].left = newParent;
+    }
+    else {
+        nodes[oldParent].right = newParent;
+    }
+    refitAncestors(newParent);
+}
+
+// the leaf's parent goes away and the sibling takes its place
+void Bvh::Remove(unsigned int object) {
+    if (!Contains(object)) {
+        return;
+    }
+    int leaf = objectLeaves[object];
+    objectLeaves[object] = NONE;
+    objectCount--;
+    int parent = nodes[leaf].parent;
+    freeNode(leaf);
+    if (parent == NONE) {
+        root = NONE;
+        return;
+    }
+    int sibling = nodes[parent].left == leaf ? nodes[parent].right : nodes[parent].left;
+    int grandparent = nodes[parent].parent;
+    nodes[sibling].parent = grandparent;
+    freeNode(parent);
+    if (grandparent == NONE) {
+        root = sibling;
+        return;
+    }
+    if (nodes[grandparent].left == parent) {
+        nodes[grandparent].left = sibling;
+    }
+    else {
+        nodes[grandparent].right = sibling;
+    }
+    refitAncestors(grandparent);
+}
+
+void Bvh::Update(unsigned int object, const BoundingBox& box) {
+    if (!Contains(object)) {
+        return;
+    }
+    int leaf = objectLeaves[object];
+    nodes[leaf].boundsMin = box.center - box.extents;
+    nodes[leaf].boundsMax = box.center + box.extents;
+    refitAncestors(nodes[leaf].parent);
+}
+
+void Bvh::Refit() {
+    if (root == NONE) {
+        return;
+    }
+    // children come after their parent in pre-order, so walking it backwards refits bottom up
+    refitOrder.clear();
+    nodeStack.clear();
+    nodeStack.push_back(root);
+    while (!nodeStack.empty()) {
+        int node = nodeStack.back();
+        nodeStack.pop_back();
+        if (nodes[node].left != NONE) {
+            refitOrder.push_back(node);
+            nodeStack.push_back(nodes[node].left);
+            nodeStack.push_back(nodes[node].right);
+        }
+    }
+    for (size_t i = refitOrder.size(); i-- > 0;) {
+        Node& node = nodes[refitOrder[i]];
+        node.boundsMin = glm::min(nodes[node.left].boundsMin, nodes[node.right].boundsMin);
+        node.boundsMax = glm::max(nodes[node.left].boundsMax, nodes[node.right].boundsMax);
+    }
+}
+
+bool Bvh::Contains(unsigned int object) const {
+    return object < objectLeaves.size() && objectLeaves[object] != NONE;
+}
+
+void Bvh::collectLeaves(int node) {
+    nodeStack.clear();
+    nodeStack.push_back(node);
+    while (!nodeStack.empty()) {
+        int current = nodeStack.back();
+        nodeStack.pop_back();
+        if (nodes[current].left == NONE) {
+            visible.push_back((unsigned int)nodes[current].object);
+        }
+        else {
+            nodeStack.push_back(nodes[current].right);
+            nodeStack.push_back(nodes[current].left);
+        }
+    }
+}
+
+void Bvh::Cull(const Frustum& frustum) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    visible.clear();
+    stats = CullStats();
+    glm::vec3 absNormals[6];
+    for (int p = 0; p < 6; p++) {
+        absNormals[p] = glm::abs(glm::vec3(frustum.planes[p]));
+    }
+    cullStack.clear();
+    if (root != NONE) {
+        cullStack.push_back(std::make_pair(root, 0x3Fu));
+    }
+    while (!cullStack.empty()) {
+        int node = cullStack.back().first;
+        unsigned int planeMask = cullStack.back().second;
+        cullStack.pop_back();
+        const Node& current = nodes[node];
+        glm::vec3 center = (current.boundsMin + current.boundsMax) * 0.5f;
+        glm::vec3 extents = (current.boundsMax - current.boundsMin) * 0.5f;
+        stats.boxTests++;
+        bool outside = false;
+        for (int p = 0; p < 6; p++) {
+            if (!(planeMask & (1u << p))) {
+                continue;
+            }
+            float distance = glm::dot(glm::vec3(frustum.planes[p]), center) + frustum.planes[p].w;
+            float radius = glm::dot(absNormals[p], extents);
+            if (distance + radius < 0.0f) {
+                outside = true;
+                break;
+            }
+            if (distance - radius >= 0.0f) {
+                planeMask &= ~(1u << p); // everything below is inside this plane too
+            }
+        }
+        if (outside) {
+            continue;
+        }
+        if (current.left == NONE) {
+            visible.push_back((unsigned int)current.object);
+        }
+        else if (planeMask == 0) {
+            collectLeaves(node);
+        }
+        else {
+            cullStack.push_back(std::make_pair(current.right, planeMask));
+            cullStack.push_back(std::make_pair(current.left, planeMask));
+        }
+    }
+    stats.tested = objectCount;
+    stats.visible = (unsigned int)visible.size();
+    stats.cullMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+const std::vector<unsigned int>& Bvh::Visible() const {
+    return visible;
+}
+
+CullStats Bvh::Stats() const {
+    return stats;
+}
+
+bool Bvh::Raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, unsigned int& object, float& distance) {
+    glm::vec3 inverseDirection(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+    float closest = maxDistance;
+    bool hit = false;
+    float entry;
+    nodeStack.clear();
+    if (root != NONE && rayHitsBox(nodes[root].boundsMin, nodes[root].boundsMax, origin, inverseDirection, closest, entry)) {
+        nodeStack.push_back(root);
+    }
+    while (!nodeStack.empty()) {
+        int node = nodeStack.back();
+        nodeStack.pop_back();
+        const Node& current = nodes[node];
+        if (current.left == NONE) {
+            // boxes were only tested against the closest hit when pushed, it may have moved closer since
+            if (rayHitsBox(current.boundsMin, current.boundsMax, origin, inverseDirection, closest, entry)) {
+                closest = entry;
+                object = (unsigned int)current.object;
+                hit = true;
+            }
+            continue;
+        }
+        float leftEntry, rightEntry;
+        bool hitsLeft = rayHitsBox(nodes[current.left].boundsMin, nodes[current.left].boundsMax, origin, inverseDirection, closest, leftEntry);
+        bool hitsRight = rayHitsBox(nodes[current.right].boundsMin, nodes[current.right].boundsMax, origin, inverseDirection, closest, rightEntry);
+        // the nearer child goes on top so the closest hit shrinks the search early
+        if (hitsLeft && hitsRight) {
+            bool leftFirst = leftEntry <= rightEntry;
+            nodeStack.push_back(leftFirst ? current.right : current.left);
+            nodeStack.push_back(leftFirst ? current.left : current.right);
+        }
+        else if (hitsLeft) {
+            nodeStack.push_back(current.left);
+        }
+        else if (hitsRight) {
+            nodeStack.push_back(current.right);
+        }
+    }
+    if (hit) {
+        distance = closest;
+    }
+    return hit;
+}
@@ -0,0 +1,64 @@
+#ifndef BVH_H
+#define BVH_H
+
+#include <glm/glm.hpp>
+
+#include <utility>
+#include <vector>
+
+#include "Culling.h"
+
+// bounding volume hierarchy over object boxes, one object per leaf
+// Build() splits top down with the surface area heuristic, Insert/Remove patch the tree in place (greedy SAH descent like Box2D's dynamic tree)
+// and Update/Refit grow or shrink the boxes of the ancestors, so moving objects never need a full rebuild
+// object ids are the caller's, e.g. indices into its own object list
+class Bvh {
+private:
+    static const int NONE = -1;
+    static const unsigned int SAH_BINS = 12;
+
+    struct Node {
+        glm::vec3 boundsMin;
+        glm::vec3 boundsMax;
+        int parent;
+        int left, right; // NONE for leaves
+        int object; // NONE for inner nodes
+    };
+
+    std::vector<Node> nodes;
+    std::vector<int> freeNodes;
+    std::vector<int> objectLeaves; // object id -> leaf node, NONE if the object isn't in the tree
+    int root;
+    unsigned int objectCount;
+    std::vector<unsigned int> visible;
+    std::vector<std::pair<int, unsigned int>> cullStack; // node and the planes it still has to be tested against
+    std::vector<int> nodeStack; // for walks that don't need plane masks
+    std::vector<int> refitOrder; // Refit's inner nodes in pre-order, capacity kept between frames
+    CullStats stats;
+
+    int allocateNode();
+    void freeNode(int node);
+    int buildRange(std::vector<unsigned int>& objects, const std::vector<BoundingBox>& boxes, unsigned int first, unsigned int last, int parent);
+    void refitAncestors(int node);
+    void collectLeaves(int node); // adds every object under node to visible, no tests
+public:
+    Bvh(); // constructor
+
+    // methods
+    void Build(const std::vector<BoundingBox>& boxes); // object i gets boxes[i], replaces whatever the tree held
+    void Insert(unsigned int object, const BoundingBox& box);
+    void Remove(unsigned int object);
+    void Update(unsigned int object, const BoundingBox& box); // moves the object's leaf box, the tree shape stays
+    void Refit(); // recomputes every inner box bottom up, after many updates
+    bool Contains(unsigned int object) const;
+
+    // skips whole subtrees outside a plane and stops testing planes a subtree is fully inside of
+    void Cull(const Frustum& frustum); // refills Visible()
+    const std::vector<unsigned int>& Visible() const; // in tree order, not sorted
+    CullStats Stats() const;
+
+    // closest object box the ray hits within maxDistance, direction doesn't have to be normalized (distance is then in its units)
+    bool Raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, unsigned int& object, float& distance);
+};
+
+#endif
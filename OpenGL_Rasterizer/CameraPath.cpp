@@ -0,0 +1,99 @@
+#include "CameraPath.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+bool CameraPath::Load(const std::string& filepath) {
+    std::ifstream stream(filepath);
+    if (!stream) {
+        return false;
+    }
+
+    keyframes.clear();
+    std::string line;
+    while (getline(stream, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::stringstream ss(line);
+        CameraKeyframe keyframe;
+        if (ss >> keyframe.time >> keyframe.position.x >> keyframe.position.y >> keyframe.position.z >> keyframe.yaw >> keyframe.pitch >> keyframe.zoom) {
+            AddKeyframe(keyframe);
+        }
+    }
+    return !keyframes.empty();
+}
+
+bool CameraPath::Save(const std::string& filepath) const {
+    std::ofstream stream(filepath);
+    if (!stream) {
+        return false;
+    }
+    stream << "# time posX posY posZ yaw pitch zoom" << '\n';
+    for (const CameraKeyframe& keyframe : keyframes) {
+        stream << keyframe.time << ' ' << keyframe.position.x << ' ' << keyframe.position.y << ' ' << keyframe.position.z << ' '
+            << keyframe.yaw << ' ' << keyframe.pitch << ' ' << keyframe.zoom << '\n';
+    }
+    return stream.good();
+}
+
+void CameraPath::AddKeyframe(const CameraKeyframe& keyframe) {
+    // keyframes are kept sorted by time so Sample can walk them in order, recording only ever appends
+    std::vector<CameraKeyframe>::iterator it = std::upper_bound(keyframes.begin(), keyframes.end(), keyframe,
+        [](const CameraKeyframe& a, const CameraKeyframe& b) { return a.time < b.time; });
+    keyframes.insert(it, keyframe);
+}
+
+void CameraPath::AddKeyframe(float time, const Camera& camera) {
+    AddKeyframe({ time, camera.Position, camera.Yaw, camera.Pitch, camera.Zoom });
+}
+
+bool CameraPath::Empty() const {
+    return keyframes.empty();
+}
+
+float CameraPath::Duration() const {
+    return keyframes.empty() ? 0.0f : keyframes.back().time - keyframes.front().time;
+}
+
+CameraKeyframe CameraPath::Sample(float time) const {
+    time += keyframes.front().time;
+    if (time <= keyframes.front().time) {
+        return keyframes.front();
+    }
+    if (time >= keyframes.back().time) {
+        return keyframes.back();
+    }
+
+    size_t next = 1;
+    while (keyframes[next].time < time) {
+        next++;
+    }
+    const CameraKeyframe& a = keyframes[next - 1];
+    const CameraKeyframe& b = keyframes[next];
+    float span = b.time - a.time;
+    float t = span > 0.0f ? (time - a.time) / span : 1.0f;
+
+    CameraKeyframe result;
+    result.time = time;
+    result.position = a.position + (b.position - a.position) * t;
+    result.yaw = a.yaw + (b.yaw - a.yaw) * t;
+    result.pitch = a.pitch + (b.pitch - a.pitch) * t;
+    result.zoom = a.zoom + (b.zoom - a.zoom) * t;
+    return result;
+}
+
+void CameraPath::Apply(Camera& camera, float time) const {
+    if (keyframes.empty()) {
+        return;
+    }
+    CameraKeyframe target = Sample(time);
+
+    // orientation and zoom go through the same handlers as the mouse, so the benchmark exercises the interactive code path
+    camera.ProcessMouseMovement((target.yaw - camera.Yaw) / camera.MouseSensitivity, (target.pitch - camera.Pitch) / camera.MouseSensitivity);
+    camera.ProcessMouseScroll(camera.Zoom - target.zoom);
+
+    // position is set directly, ProcessKeyboard only moves along Front and Right and would leave the height off
+    camera.Position = target.position;
+}
@@ -0,0 +1,39 @@
+#ifndef CAMERA_PATH_H
+#define CAMERA_PATH_H
+
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+
+#include "Camera.h"
+
+// one recorded camera pose, time is in seconds from the start of the path
+struct CameraKeyframe {
+    float time;
+    glm::vec3 position;
+    float yaw;
+    float pitch;
+    float zoom;
+};
+
+// a scripted camera path for repeatable benchmark runs
+// file format is one keyframe per line: time posX posY posZ yaw pitch zoom, lines starting with # are comments
+class CameraPath {
+private:
+    std::vector<CameraKeyframe> keyframes;
+public:
+    bool Load(const std::string& filepath);
+    bool Save(const std::string& filepath) const;
+
+    void AddKeyframe(const CameraKeyframe& keyframe);
+    void AddKeyframe(float time, const Camera& camera); // records the camera's current pose
+    bool Empty() const;
+    float Duration() const;
+
+    // times below are seconds from the first keyframe
+    CameraKeyframe Sample(float time) const; // linear interpolation between the surrounding keyframes
+    void Apply(Camera& camera, float time) const; // drives the camera to the pose at time, orientation and zoom through the mouse handlers
+};
+
+#endif
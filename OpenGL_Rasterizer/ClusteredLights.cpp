@@ -0,0 +1,166 @@
+#include "ClusteredLights.h"
+#include "RenderState.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+float ClusterLightRange(const ClusterLight& light) {
+    float brightest = std::max(std::max(std::max(light.diffuse.r, light.diffuse.g), light.diffuse.b), std::max(std::max(light.ambient.r, light.ambient.g), light.ambient.b));
+    brightest = std::max(brightest, std::max(std::max(light.specular.r, light.specular.g), light.specular.b));
+    // solve Kq*d*d + Kl*d + Kc = (256 / 5) * brightest for d, past that the light adds less than 5/256
+    float target = 256.0f / 5.0f * brightest;
+    if (target <= light.constant) {
+        return 0.0f; // too dim to ever reach 5/256
+    }
+    if (light.quadratic <= 0.0f) {
+        return light.linear > 0.0f ? (target - light.constant) / light.linear : 1.0e30f;
+    }
+    return (-light.linear + std::sqrt(light.linear * light.linear - 4.0f * light.quadratic * (light.constant - target))) / (2.0f * light.quadratic);
+}
+
+// creates a texture buffer over a new buffer object
+static void createTextureBuffer(unsigned int& buffer, unsigned int& texture, GLenum format) {
+    glGenBuffers(1, &buffer);
+    glGenTextures(1, &texture);
+    RenderState::BindBuffer(GL_TEXTURE_BUFFER, buffer);
+    glBufferData(GL_TEXTURE_BUFFER, 16, nullptr, GL_DYNAMIC_DRAW); // a texture buffer needs some storage before it's attached
+    RenderState::BindTexture(0, GL_TEXTURE_BUFFER, texture);
+    glTexBuffer(GL_TEXTURE_BUFFER, format, buffer);
+}
+
+// orphans and refills a texture buffer
+static void uploadTextureBuffer(unsigned int buffer, const void* data, size_t size) {
+    RenderState::BindBuffer(GL_TEXTURE_BUFFER, buffer);
+    glBufferData(GL_TEXTURE_BUFFER, std::max(size, (size_t)16), nullptr, GL_DYNAMIC_DRAW);
+    if (size > 0) {
+        glBufferSubData(GL_TEXTURE_BUFFER, 0, size, data);
+    }
+}
+
+ClusteredLights::ClusteredLights(JobSystem& jobs) : jobs(jobs), stats({ 0, 0, 0, 0.0 }) {
+    createTextureBuffer(lightBuffer, lightTexture, GL_RGBA32F);
+    createTextureBuffer(gridBuffer, gridTexture, GL_RG32UI);
+    createTextureBuffer(indexBuffer, indexTexture, GL_R32UI);
+    clusterLists.resize(TILES_X * TILES_Y * SLICES);
+    grid.resize(TILES_X * TILES_Y * SLICES);
+}
+
+ClusteredLights::~ClusteredLights() {
+    unsigned int textures[] = { lightTexture, gridTexture, indexTexture };
+    unsigned int buffers[] = { lightBuffer, gridBuffer, indexBuffer };
+    for (unsigned int i = 0; i < 3; i++) {
+        RenderState::ForgetTexture(textures[i]);
+        RenderState::ForgetBuffer(buffers[i]);
+    }
+    glDeleteTextures(3, textures);
+    glDeleteBuffers(3, buffers);
+}
+
+void ClusteredLights::binSlices(unsigned int firstSlice, unsigned int endSlice, float tanHalfFovY, float aspect, float nearPlane, float farPlane) {
+    float tanHalfFovX = tanHalfFovY * aspect;
+    float depthRatio = farPlane / nearPlane;
+    for (unsigned int slice = firstSlice; slice < endSlice; slice++) {
+        // slices are spaced exponentially so clusters stay roughly cube shaped with distance
+        float sliceNear = nearPlane * std::pow(depthRatio, (float)slice / SLICES);
+        float sliceFar = nearPlane * std::pow(depthRatio, (float)(slice + 1) / SLICES);
+        for (unsigned int tile = 0; tile < TILES_X * TILES_Y; tile++) {
+            clusterLists[slice * TILES_X * TILES_Y + tile].clear();
+        }
+
+        for (unsigned int light = 0; light < spheres.size(); light++) {
+            const ViewSphere& sphere = spheres[light];
+            float depth = -sphere.centre.z;
+            float nearDepth = std::max(depth - sphere.radius, sliceNear);
+            float farDepth = std::min(depth + sphere.radius, sliceFar);
+            if (nearDepth > farDepth) {
+                continue;
+            }
+            // the sphere's view space box projected at the nearest and farthest depth it has inside this slice,
+            // projection is monotonic in depth for a fixed x or y so the extremes are among these four
+            float minX = 1.0f, maxX = -1.0f, minY = 1.0f, maxY = -1.0f;
+            float depths[2] = { nearDepth, farDepth };
+            for (float d : depths) {
+                float lowX = (sphere.centre.x - sphere.radius) / (d * tanHalfFovX);
+                float highX = (sphere.centre.x + sphere.radius) / (d * tanHalfFovX);
+                float lowY = (sphere.centre.y - sphere.radius) / (d * tanHalfFovY);
+                float highY = (sphere.centre.y + sphere.radius) / (d * tanHalfFovY);
+                minX = std::min(minX, lowX);
+                maxX = std::max(maxX, highX);
+                minY = std::min(minY, lowY);
+                maxY = std::max(maxY, highY);
+            }
+            if (minX > 1.0f || maxX < -1.0f || minY > 1.0f || maxY < -1.0f) {
+                continue; // off screen
+            }
+            int firstX = std::max(0, (int)std::floor((minX * 0.5f + 0.5f) * TILES_X));
+            int lastX = std::min((int)TILES_X - 1, (int)std::floor((maxX * 0.5f + 0.5f) * TILES_X));
+            int firstY = std::max(0, (int)std::floor((minY * 0.5f + 0.5f) * TILES_Y));
+            int lastY = std::min((int)TILES_Y - 1, (int)std::floor((maxY * 0.5f + 0.5f) * TILES_Y));
+            for (int y = firstY; y <= lastY; y++) {
+                for (int x = firstX; x <= lastX; x++) {
+                    clusterLists[(slice * TILES_Y + y) * TILES_X + x].push_back(light);
+                }
+            }
+        }
+    }
+}
+
+void ClusteredLights::Update(const std::vector<ClusterLight>& lights, const glm::mat4& view, float fovY, float aspect, float nearPlane, float farPlane) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    spheres.resize(lights.size());
+    for (size_t i = 0; i < lights.size(); i++) {
+        spheres[i].centre = glm::vec3(view * glm::vec4(lights[i].position, 1.0f));
+        spheres[i].radius = lights[i].range;
+    }
+
+    // each job owns one depth slice, so no two jobs ever write the same cluster list
+    float tanHalfFovY = std::tan(fovY * 0.5f);
+    if (lights.size() < 64) {
+        binSlices(0, SLICES, tanHalfFovY, aspect, nearPlane, farPlane); // not worth splitting for a handful of lights
+    }
+    else {
+        jobs.ParallelFor(SLICES, 1, [&](unsigned int begin, unsigned int end, unsigned int) {
+            binSlices(begin, end, tanHalfFovY, aspect, nearPlane, farPlane);
+        });
+    }
+
+    // flatten the lists into one index buffer with an (offset, count) per cluster
+    indices.clear();
+    stats.maxPerCluster = 0;
+    touched.assign(lights.size(), false);
+    for (size_t cluster = 0; cluster < clusterLists.size(); cluster++) {
+        const std::vector<unsigned int>& list = clusterLists[cluster];
+        grid[cluster] = glm::uvec2((unsigned int)indices.size(), (unsigned int)list.size());
+        indices.insert(indices.end(), list.begin(), list.end());
+        stats.maxPerCluster = std::max(stats.maxPerCluster, (unsigned int)list.size());
+        for (unsigned int light : list) {
+            touched[light] = true;
+        }
+    }
+    stats.lights = (unsigned int)std::count(touched.begin(), touched.end(), true);
+    stats.assignments = (unsigned int)indices.size();
+
+    uploadTextureBuffer(lightBuffer, lights.data(), lights.size() * sizeof(ClusterLight));
+    uploadTextureBuffer(gridBuffer, grid.data(), grid.size() * sizeof(glm::uvec2));
+    uploadTextureBuffer(indexBuffer, indices.data(), indices.size() * sizeof(unsigned int));
+    stats.binMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void ClusteredLights::FillFrameBlock(FrameBlock& frame, unsigned int width, unsigned int height, float nearPlane, float farPlane) const {
+    // slice = log(depth) * scale + bias, the inverse of the spacing in binSlices
+    float scale = SLICES / std::log(farPlane / nearPlane);
+    frame.clusterDimensions = glm::uvec4(TILES_X, TILES_Y, SLICES, 0);
+    frame.clusterParams = glm::vec4((float)width / TILES_X, (float)height / TILES_Y, scale, -std::log(nearPlane) * scale);
+}
+
+void ClusteredLights::Bind(unsigned int lightUnit, unsigned int gridUnit, unsigned int indexUnit) const {
+    RenderState::BindTexture(lightUnit, GL_TEXTURE_BUFFER, lightTexture);
+    RenderState::BindTexture(gridUnit, GL_TEXTURE_BUFFER, gridTexture);
+    RenderState::BindTexture(indexUnit, GL_TEXTURE_BUFFER, indexTexture);
+}
+
+ClusterStats ClusteredLights::Stats() const {
+    return stats;
+}
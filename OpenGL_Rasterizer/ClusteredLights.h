@@ -0,0 +1,86 @@
+#ifndef CLUSTERED_LIGHTS_H
+#define CLUSTERED_LIGHTS_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+#include "JobSystem.h"
+#include "UniformBlocks.h"
+
+// a point light, or a spot light when spot is 1, laid out as the six texels per light the fragment shader reads
+// lights need a finite range to be binned, ClusterLightRange gives the distance where the attenuation stops mattering
+struct ClusterLight {
+    glm::vec3 position;
+    float range;
+    glm::vec3 ambient;
+    float constant;
+    glm::vec3 diffuse;
+    float linear;
+    glm::vec3 specular;
+    float quadratic;
+    glm::vec3 direction; // spot lights only
+    float cutoff; // spot lights only, cos of the inner cone angle
+    float outerCutoff; // spot lights only, cos of the outer cone angle
+    float spot; // 1 for spot lights, 0 for point lights
+    float padding[2];
+};
+
+static_assert(sizeof(ClusterLight) == 6 * sizeof(glm::vec4), "ClusterLight is read as six vec4 texels");
+
+// distance at which 1/(Kc + Kl*d + Kq*d*d) times the brightest channel drops below 5/256
+float ClusterLightRange(const ClusterLight& light);
+
+// per frame numbers for the profiler output
+struct ClusterStats {
+    unsigned int lights; // lights that touched at least one cluster
+    unsigned int assignments; // light indices written, summed over every cluster
+    unsigned int maxPerCluster;
+    double binMs; // CPU time of the binning and upload
+};
+
+// clustered forward+ light culling
+// the view frustum is cut into TILES_X * TILES_Y screen tiles and SLICES exponential depth slices,
+// every frame each light's bounding sphere is binned into the clusters it overlaps on the CPU (depth slices split across threads),
+// and the fragment shader only loops over the lights in its own cluster
+// GL 3.3 has no storage buffers, so the lights, the per cluster (offset, count) grid and the index list are texture buffers
+class ClusteredLights {
+private:
+    struct ViewSphere {
+        glm::vec3 centre; // view space, looking down -z
+        float radius;
+    };
+
+    unsigned int lightBuffer, lightTexture; // RGBA32F, six texels per light
+    unsigned int gridBuffer, gridTexture; // RG32UI, (offset, count) per cluster
+    unsigned int indexBuffer, indexTexture; // R32UI light indices
+    JobSystem& jobs;
+    std::vector<ViewSphere> spheres;
+    std::vector<std::vector<unsigned int>> clusterLists; // lights per cluster, capacity kept between frames
+    std::vector<glm::uvec2> grid;
+    std::vector<unsigned int> indices;
+    std::vector<bool> touched; // per light, for stats.lights, capacity kept between frames
+    ClusterStats stats;
+
+    void binSlices(unsigned int firstSlice, unsigned int endSlice, float tanHalfFovY, float aspect, float nearPlane, float farPlane);
+public:
+    static const unsigned int TILES_X = 16;
+    static const unsigned int TILES_Y = 9;
+    static const unsigned int SLICES = 24;
+
+    ClusteredLights(JobSystem& jobs); // constructor, needs a current GL context
+    ~ClusteredLights(); // destructor
+    ClusteredLights(const ClusteredLights&) = delete;
+    ClusteredLights& operator=(const ClusteredLights&) = delete;
+
+    // methods
+    // bins the lights for this camera and uploads the light, grid and index buffers, lights past the range are never evaluated
+    void Update(const std::vector<ClusterLight>& lights, const glm::mat4& view, float fovY, float aspect, float nearPlane, float farPlane);
+    // fills the cluster fields of the frame block the shader uses to find its cluster
+    void FillFrameBlock(FrameBlock& frame, unsigned int width, unsigned int height, float nearPlane, float farPlane) const;
+    void Bind(unsigned int lightUnit, unsigned int gridUnit, unsigned int indexUnit) const; // binds the three texture buffers
+    ClusterStats Stats() const;
+};
+
+#endif
@@ -0,0 +1,156 @@
+#include "Culling.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define CULLING_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CULLING_SSE
+#endif
+
+BoundingBox ComputeBounds(const std::vector<float>& positions) {
+    glm::vec3 lo(std::numeric_limits<float>::max());
+    glm::vec3 hi(-std::numeric_limits<float>::max());
+    for (size_t i = 0; i + 2 < positions.size(); i += 3) {
+        glm::vec3 position(positions[i], positions[i + 1], positions[i + 2]);
+        lo = glm::min(lo, position);
+        hi = glm::max(hi, position);
+    }
+    return { (lo + hi) * 0.5f, (hi - lo) * 0.5f };
+}
+
+BoundingBox TransformBounds(const BoundingBox& local, const glm::mat4& model) {
+    // each world axis gets the absolute contribution of every local axis (Arvo)
+    BoundingBox world;
+    world.center = glm::vec3(model * glm::vec4(local.center, 1.0f));
+    for (int axis = 0; axis < 3; axis++) {
+        world.extents[axis] = std::fabs(model[0][axis]) * local.extents.x + std::fabs(model[1][axis]) * local.extents.y + std::fabs(model[2][axis]) * local.extents.z;
+    }
+    return world;
+}
+
+CullingSet::CullingSet() : count(0), stats() {
+}
+
+unsigned int CullingSet::Add(const BoundingBox& box) {
+    if (count % LANES == 0) {
+        size_t padded = count + LANES;
+        centerX.resize(padded, 0.0f);
+        centerY.resize(padded, 0.0f);
+        centerZ.resize(padded, 0.0f);
+        extentX.resize(padded, 0.0f);
+        extentY.resize(padded, 0.0f);
+        extentZ.resize(padded, 0.0f);
+    }
+    Set(count, box);
+    return count++;
+}
+
+void CullingSet::Set(unsigned int index, const BoundingBox& box) {
+    centerX[index] = box.center.x;
+    centerY[index] = box.center.y;
+    centerZ[index] = box.center.z;
+    extentX[index] = box.extents.x;
+    extentY[index] = box.extents.y;
+    extentZ[index] = box.extents.z;
+}
+
+void CullingSet::Cull(const Frustum& frustum) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    visible.clear();
+    cullRange(frustum, 0, count, visible);
+    stats.tested = count;
+    stats.boxTests = count;
+    stats.visible = (unsigned int)visible.size();
+    stats.cullMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void CullingSet::Cull(const Frustum& frustum, JobSystem& jobs) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    // every chunk collects its own indices, joined in chunk order afterwards so Visible() stays ascending
+    unsigned int chunks = (count + PARALLEL_CHUNK - 1) / PARALLEL_CHUNK;
+    chunkVisible.resize(chunks);
+    jobs.ParallelFor(chunks, 1, [&](unsigned int begin, unsigned int end, unsigned int) {
+        for (unsigned int chunk = begin; chunk < end; chunk++) {
+            chunkVisible[chunk].clear();
+            cullRange(frustum, chunk * PARALLEL_CHUNK, std::min((chunk + 1) * PARALLEL_CHUNK, count), chunkVisible[chunk]);
+        }
+    });
+    visible.clear();
+    for (unsigned int chunk = 0; chunk < chunks; chunk++) {
+        visible.insert(visible.end(), chunkVisible[chunk].begin(), chunkVisible[chunk].end());
+    }
+    stats.tested = count;
+    stats.boxTests = count;
+    stats.visible = (unsigned int)visible.size();
+    stats.cullMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void CullingSet::cullRange(const Frustum& frustum, unsigned int first, unsigned int end, std::vector<unsigned int>& passed) const {
+    // a box is behind a plane when its centre distance plus its projected radius |n| . extents is negative
+    for (; first < end; first += LANES) {
+        unsigned int mask = 0;
+#if defined(CULLING_AVX)
+        __m256 cx = _mm256_loadu_ps(&centerX[first]), cy = _mm256_loadu_ps(&centerY[first]), cz = _mm256_loadu_ps(&centerZ[first]);
+        __m256 ex = _mm256_loadu_ps(&extentX[first]), ey = _mm256_loadu_ps(&extentY[first]), ez = _mm256_loadu_ps(&extentZ[first]);
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (const glm::vec4& plane : frustum.planes) {
+            __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(cx, _mm256_set1_ps(plane.x)), _mm256_mul_ps(cy, _mm256_set1_ps(plane.y))),
+                _mm256_add_ps(_mm256_mul_ps(cz, _mm256_set1_ps(plane.z)), _mm256_set1_ps(plane.w)));
+            __m256 radius = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ex, _mm256_set1_ps(std::fabs(plane.x))), _mm256_mul_ps(ey, _mm256_set1_ps(std::fabs(plane.y)))),
+                _mm256_mul_ps(ez, _mm256_set1_ps(std::fabs(plane.z))));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(distance, radius), _mm256_setzero_ps(), _CMP_GE_OQ));
+        }
+        mask = (unsigned int)_mm256_movemask_ps(inside);
+#elif defined(CULLING_SSE)
+        for (unsigned int half = 0; half < LANES; half += 4) {
+            unsigned int i = first + half;
+            __m128 cx = _mm_loadu_ps(&centerX[i]), cy = _mm_loadu_ps(&centerY[i]), cz = _mm_loadu_ps(&centerZ[i]);
+            __m128 ex = _mm_loadu_ps(&extentX[i]), ey = _mm_loadu_ps(&extentY[i]), ez = _mm_loadu_ps(&extentZ[i]);
+            __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+            for (const glm::vec4& plane : frustum.planes) {
+                __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(cx, _mm_set1_ps(plane.x)), _mm_mul_ps(cy, _mm_set1_ps(plane.y))),
+                    _mm_add_ps(_mm_mul_ps(cz, _mm_set1_ps(plane.z)), _mm_set1_ps(plane.w)));
+                __m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ex, _mm_set1_ps(std::fabs(plane.x))), _mm_mul_ps(ey, _mm_set1_ps(std::fabs(plane.y)))),
+                    _mm_mul_ps(ez, _mm_set1_ps(std::fabs(plane.z))));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+            }
+            mask |= (unsigned int)_mm_movemask_ps(inside) << half;
+        }
+#else
+        for (unsigned int lane = 0; lane < LANES; lane++) {
+            unsigned int i = first + lane;
+            bool inside = true;
+            for (const glm::vec4& plane : frustum.planes) {
+                float distance = centerX[i] * plane.x + centerY[i] * plane.y + centerZ[i] * plane.z + plane.w;
+                float radius = extentX[i] * std::fabs(plane.x) + extentY[i] * std::fabs(plane.y) + extentZ[i] * std::fabs(plane.z);
+                inside = inside && distance + radius >= 0.0f;
+            }
+            mask |= (inside ? 1u : 0u) << lane;
+        }
+#endif
+        // the padding boxes past count are zero sized at the origin and can pass, so they're cut off here (and the next chunk's boxes)
+        for (unsigned int lane = 0; lane < LANES && first + lane < end; lane++) {
+            if (mask & (1u << lane)) {
+                passed.push_back(first + lane);
+            }
+        }
+    }
+}
+
+const std::vector<unsigned int>& CullingSet::Visible() const {
+    return visible;
+}
+
+unsigned int CullingSet::Count() const {
+    return count;
+}
+
+CullStats CullingSet::Stats() const {
+    return stats;
+}
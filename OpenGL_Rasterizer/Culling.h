@@ -0,0 +1,56 @@
+#ifndef CULLING_H
+#define CULLING_H
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+#include "Frustum.h"
+#include "JobSystem.h"
+
+// axis aligned box as centre and half size
+struct BoundingBox {
+    glm::vec3 center;
+    glm::vec3 extents;
+};
+
+BoundingBox ComputeBounds(const std::vector<float>& positions); // box around xyz triples, e.g. MeshData::Positions()
+BoundingBox TransformBounds(const BoundingBox& local, const glm::mat4& model); // world box around the transformed local box
+
+// per frame numbers for the profiler output and the benchmark
+struct CullStats {
+    unsigned int tested; // objects
+    unsigned int visible;
+    unsigned int boxTests; // boxes actually tested, objects for a flat loop, nodes for a hierarchy
+    double cullMs;
+};
+
+// world space object boxes kept structure of arrays, so one plane is tested against 8 boxes at once with AVX (4 with SSE)
+// a box is visible unless it lies entirely behind one of the planes, so boxes near a corner of the frustum can pass when they are outside
+class CullingSet {
+private:
+    static const unsigned int LANES = 8; // arrays are padded to a multiple of this, the padding is never reported visible
+    static const unsigned int PARALLEL_CHUNK = 4096; // boxes per job in a parallel cull, a multiple of LANES
+
+    std::vector<float> centerX, centerY, centerZ;
+    std::vector<float> extentX, extentY, extentZ;
+    unsigned int count;
+    std::vector<unsigned int> visible;
+    std::vector<std::vector<unsigned int>> chunkVisible; // per chunk of a parallel cull, capacity kept between frames
+    CullStats stats;
+
+    void cullRange(const Frustum& frustum, unsigned int first, unsigned int end, std::vector<unsigned int>& passed) const; // first a multiple of LANES
+public:
+    CullingSet(); // constructor
+
+    // methods
+    unsigned int Add(const BoundingBox& box); // returns the object's index
+    void Set(unsigned int index, const BoundingBox& box); // for objects that moved
+    void Cull(const Frustum& frustum); // refills Visible()
+    void Cull(const Frustum& frustum, JobSystem& jobs); // same, chunks of boxes tested in parallel
+    const std::vector<unsigned int>& Visible() const; // indices of the boxes that passed, ascending
+    unsigned int Count() const;
+    CullStats Stats() const;
+};
+
+#endif
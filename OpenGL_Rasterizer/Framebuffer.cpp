@@ -0,0 +1,63 @@
+#include "Framebuffer.h"
+
+#include <fstream>
+#include <vector>
+
+Framebuffer::Framebuffer(unsigned int width, unsigned int height) : width(width), height(height) {
+    glGenFramebuffers(1, &renderer_id);
+    glBindFramebuffer(GL_FRAMEBUFFER, renderer_id);
+
+    glGenRenderbuffers(1, &color_id);
+    glBindRenderbuffer(GL_RENDERBUFFER, color_id);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color_id);
+
+    glGenRenderbuffers(1, &depth_id);
+    glBindRenderbuffer(GL_RENDERBUFFER, depth_id);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depth_id);
+
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+}
+
+Framebuffer::~Framebuffer() {
+    glDeleteRenderbuffers(1, &depth_id);
+    glDeleteRenderbuffers(1, &color_id);
+    glDeleteFramebuffers(1, &renderer_id);
+}
+
+void Framebuffer::Bind() const {
+    glBindFramebuffer(GL_FRAMEBUFFER, renderer_id);
+}
+
+void Framebuffer::Unbind() const {
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+bool Framebuffer::IsComplete() const {
+    glBindFramebuffer(GL_FRAMEBUFFER, renderer_id);
+    return glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+}
+
+unsigned int Framebuffer::GetID() const {
+    return renderer_id;
+}
+
+bool Framebuffer::WritePPM(const std::string& path) const {
+    std::vector<unsigned char> pixels(width * height * 3);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, renderer_id);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1); // rows are tightly packed RGB, not padded to 4 bytes
+    glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    file << "P6\n" << width << " " << height << "\n255\n";
+    // GL's origin is bottom left while ppm starts at the top row, so write rows in reverse
+    for (unsigned int row = 0; row < height; row++) {
+        const unsigned char* line = pixels.data() + (height - 1 - row) * width * 3;
+        file.write(reinterpret_cast<const char*>(line), width * 3);
+    }
+    return file.good();
+}
@@ -0,0 +1,27 @@
+#ifndef FRAMEBUFFER_H
+#define FRAMEBUFFER_H
+
+#include <glad/glad.h>
+#include <string>
+
+// offscreen render target with a color and depth renderbuffer, used when there is no window to draw into
+class Framebuffer {
+private:
+    unsigned int renderer_id;
+    unsigned int color_id;
+    unsigned int depth_id;
+    unsigned int width;
+    unsigned int height;
+public:
+    Framebuffer(unsigned int width, unsigned int height); // constructor
+    ~Framebuffer(); // destructor
+
+    // methods
+    void Bind() const; // binds fbo for drawing and reading
+    void Unbind() const; // goes back to the default framebuffer
+    bool IsComplete() const;
+    unsigned int GetID() const; // for blits and rebinding after passes that render elsewhere
+    bool WritePPM(const std::string& path) const; // reads back the color attachment and saves it
+};
+
+#endif
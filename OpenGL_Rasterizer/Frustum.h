@@ -0,0 +1,14 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <glm/glm.hpp>
+
+// six planes as (normal, distance) with the normals pointing inwards, a point p is inside a plane when dot(normal, p) + distance >= 0
+struct Frustum {
+    glm::vec4 planes[6]; // left, right, bottom, top, near, far
+};
+
+// Gribb/Hartmann plane extraction, the planes are in the space the matrix maps from (world space for projection * view)
+Frustum ExtractFrustum(const glm::mat4& viewProjection);
+
+#endif
@@ -0,0 +1,62 @@
+#include "GBuffer.h"
+#include "RenderState.h"
+
+unsigned int GBuffer::createTarget(GLenum internalFormat, GLenum format, GLenum type, unsigned int width, unsigned int height) {
+    unsigned int texture;
+    glGenTextures(1, &texture);
+    RenderState::BindTexture2D(0, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, nullptr);
+    // read with texelFetch, but a complete texture still needs non mipmap filtering
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    return texture;
+}
+
+GBuffer::GBuffer(unsigned int width, unsigned int height) : width(width), height(height) {
+    glGenFramebuffers(1, &renderer_id);
+    glBindFramebuffer(GL_FRAMEBUFFER, renderer_id);
+
+    albedo_id = createTarget(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, width, height);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, albedo_id, 0);
+    specular_id = createTarget(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, width, height);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, specular_id, 0);
+    normal_id = createTarget(GL_RGBA16F, GL_RGBA, GL_FLOAT, width, height);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, normal_id, 0);
+    depth_id = createTarget(GL_DEPTH24_STENCIL8, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, width, height);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, depth_id, 0);
+
+    GLenum attachments[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2 };
+    glDrawBuffers(3, attachments);
+}
+
+GBuffer::~GBuffer() {
+    unsigned int textures[] = { albedo_id, specular_id, normal_id, depth_id };
+    for (unsigned int texture : textures) {
+        RenderState::ForgetTexture(texture);
+    }
+    glDeleteTextures(4, textures);
+    glDeleteFramebuffers(1, &renderer_id);
+}
+
+void GBuffer::Bind() const {
+    glBindFramebuffer(GL_FRAMEBUFFER, renderer_id);
+}
+
+bool GBuffer::IsComplete() const {
+    glBindFramebuffer(GL_FRAMEBUFFER, renderer_id);
+    return glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+}
+
+void GBuffer::BindTextures(unsigned int firstUnit) const {
+    RenderState::BindTexture2D(firstUnit, albedo_id);
+    RenderState::BindTexture2D(firstUnit + 1, specular_id);
+    RenderState::BindTexture2D(firstUnit + 2, normal_id);
+    RenderState::BindTexture2D(firstUnit + 3, depth_id);
+}
+
+void GBuffer::BlitDepth(unsigned int targetFramebuffer) const {
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, renderer_id);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, targetFramebuffer);
+    glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, targetFramebuffer);
+}
@@ -0,0 +1,32 @@
+#ifndef GBUFFER_H
+#define GBUFFER_H
+
+#include <glad/glad.h>
+
+// render targets of the deferred path's geometry pass
+// albedo and specular are RGBA8, normals RGBA16F, depth a DEPTH24_STENCIL8 texture the lighting pass rebuilds positions from
+class GBuffer {
+private:
+    unsigned int renderer_id;
+    unsigned int albedo_id;
+    unsigned int specular_id;
+    unsigned int normal_id;
+    unsigned int depth_id;
+    unsigned int width;
+    unsigned int height;
+
+    static unsigned int createTarget(GLenum internalFormat, GLenum format, GLenum type, unsigned int width, unsigned int height);
+public:
+    GBuffer(unsigned int width, unsigned int height); // constructor
+    ~GBuffer(); // destructor
+    GBuffer(const GBuffer&) = delete;
+    GBuffer& operator=(const GBuffer&) = delete;
+
+    // methods
+    void Bind() const; // binds the fbo for the geometry pass
+    bool IsComplete() const;
+    void BindTextures(unsigned int firstUnit) const; // albedo, specular, normal and depth on four consecutive units
+    void BlitDepth(unsigned int targetFramebuffer) const; // copies depth into the target so forward passes can test against it
+};
+
+#endif
@@ -0,0 +1,154 @@
+#include "GpuProfiler.h"
+
+GpuProfiler::GpuProfiler(bool enabled, bool keepHistory) : current(0), frameIndex(-1), enabled(enabled), keepHistory(keepHistory), reportFrames(0), droppedFrames(0) {
+    for (unsigned int i = 0; i < BUFFERED_FRAMES; i++) {
+        frames[i].used = 0;
+        frames[i].frame = -1;
+    }
+}
+
+GpuProfiler::~GpuProfiler() {
+    for (unsigned int i = 0; i < BUFFERED_FRAMES; i++) {
+        if (!frames[i].pool.empty()) {
+            glDeleteQueries((GLsizei)frames[i].pool.size(), frames[i].pool.data());
+        }
+    }
+}
+
+unsigned int GpuProfiler::acquireQuery() {
+    FrameQueries& set = frames[current];
+    if (set.used == set.pool.size()) {
+        unsigned int query;
+        glGenQueries(1, &query);
+        set.pool.push_back(query);
+    }
+    return set.pool[set.used++];
+}
+
+void GpuProfiler::resolve(FrameQueries& set) {
+    if (set.frame < 0 || set.passes.empty()) {
+        return;
+    }
+
+    // if any result isn't ready yet the frame is skipped instead of stalling on it
+    for (const PendingPass& pass : set.passes) {
+        GLint available = 0;
+        glGetQueryObjectiv(pass.endQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) {
+            droppedFrames++;
+            set.frame = -1;
+            return;
+        }
+    }
+
+    lastResults.clear();
+    for (const PendingPass& pass : set.passes) {
+        GLuint64 start = 0, end = 0;
+        glGetQueryObjectui64v(pass.startQuery, GL_QUERY_RESULT, &start);
+        glGetQueryObjectui64v(pass.endQuery, GL_QUERY_RESULT, &end);
+        double ms = (end - start) / 1.0e6;
+        lastResults.push_back({ pass.name, ms });
+
+        if (history.find(pass.name) == history.end()) {
+            passOrder.push_back(pass.name);
+        }
+        std::vector<double>& values = history[pass.name];
+        if (keepHistory) {
+            values.push_back(ms);
+        }
+        reportSums[pass.name] += ms;
+    }
+    reportFrames++;
+    set.frame = -1;
+}
+
+void GpuProfiler::BeginFrame() {
+    if (!enabled) {
+        return;
+    }
+    frameIndex++;
+    current = frameIndex % BUFFERED_FRAMES;
+
+    FrameQueries& set = frames[current];
+    resolve(set);
+    set.used = 0;
+    set.passes.clear();
+    set.frame = frameIndex;
+    openPasses.clear();
+}
+
+void GpuProfiler::EndFrame() {
+    if (!enabled) {
+        return;
+    }
+    // any pass left open would never get its end timestamp
+    while (!openPasses.empty()) {
+        EndPass();
+    }
+}
+
+void GpuProfiler::Finish() {
+    if (!enabled) {
+        return;
+    }
+    glFinish(); // after this every outstanding query is available, so resolving doesn't drop anything
+    for (unsigned int i = 1; i <= BUFFERED_FRAMES; i++) {
+        resolve(frames[(current + i) % BUFFERED_FRAMES]);
+    }
+}
+
+void GpuProfiler::BeginPass(const std::string& name) {
+    if (!enabled) {
+        return;
+    }
+    FrameQueries& set = frames[current];
+    unsigned int startQuery = acquireQuery();
+    unsigned int endQuery = acquireQuery();
+    glQueryCounter(startQuery, GL_TIMESTAMP);
+    set.passes.push_back({ name, startQuery, endQuery });
+    openPasses.push_back((unsigned int)set.passes.size() - 1);
+}
+
+void GpuProfiler::EndPass() {
+    if (!enabled || openPasses.empty()) {
+        return;
+    }
+    FrameQueries& set = frames[current];
+    glQueryCounter(set.passes[openPasses.back()].endQuery, GL_TIMESTAMP);
+    openPasses.pop_back();
+}
+
+bool GpuProfiler::Enabled() const {
+    return enabled;
+}
+
+const std::vector<GpuPassTiming>& GpuProfiler::LastResults() const {
+    return lastResults;
+}
+
+const std::vector<std::string>& GpuProfiler::PassNames() const {
+    return passOrder;
+}
+
+const std::vector<double>& GpuProfiler::History(const std::string& name) const {
+    static const std::vector<double> empty;
+    std::map<std::string, std::vector<double>>::const_iterator it = history.find(name);
+    return it == history.end() ? empty : it->second;
+}
+
+unsigned int GpuProfiler::DroppedFrames() const {
+    return droppedFrames;
+}
+
+void GpuProfiler::Report(std::ostream& stream) {
+    if (reportFrames == 0) {
+        return;
+    }
+    stream << "GPU";
+    for (const std::string& name : passOrder) {
+        stream << "  " << name << ": " << reportSums[name] / reportFrames << " ms";
+        reportSums[name] = 0.0;
+    }
+    stream << std::endl;
+    reportFrames = 0;
+}
@@ -0,0 +1,84 @@
+#ifndef GPU_PROFILER_H
+#define GPU_PROFILER_H
+
+#include <glad/glad.h>
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// GPU time of one named pass in a frame, in milliseconds
+struct GpuPassTiming {
+    std::string name;
+    double ms;
+};
+
+// measures how long each draw pass takes on the GPU using GL_TIMESTAMP queries
+// timestamps (instead of GL_TIME_ELAPSED) let passes nest and run inside the benchmark's frame queries
+// query sets are double buffered: a frame's results are read two frames later and dropped rather than waited on if not ready
+class GpuProfiler {
+private:
+    static const unsigned int BUFFERED_FRAMES = 2;
+    struct PendingPass {
+        std::string name;
+        unsigned int startQuery;
+        unsigned int endQuery;
+    };
+    struct FrameQueries {
+        std::vector<unsigned int> pool; // query objects owned by this frame set, reused every time it comes around
+        unsigned int used;
+        std::vector<PendingPass> passes;
+        int frame; // frame index the set was recorded in, -1 if empty
+    };
+    FrameQueries frames[BUFFERED_FRAMES];
+    unsigned int current;
+    int frameIndex;
+    bool enabled;
+    bool keepHistory;
+    std::vector<unsigned int> openPasses; // stack of passes begun but not ended, indexes into the current set
+
+    std::vector<GpuPassTiming> lastResults;
+    std::vector<std::string> passOrder; // pass names in the order they were first seen
+    std::map<std::string, std::vector<double>> history; // every resolved ms value per pass when keepHistory, otherwise left empty
+    std::map<std::string, double> reportSums; // totals since the last Report call
+    unsigned int reportFrames;
+    unsigned int droppedFrames;
+
+    unsigned int acquireQuery();
+    void resolve(FrameQueries& set); // reads back a finished set without blocking
+public:
+    // constructor, needs a current GL context when enabled
+    // keepHistory records every frame for History, only for runs with an end like the benchmark since it grows each frame
+    GpuProfiler(bool enabled, bool keepHistory);
+    ~GpuProfiler(); // destructor
+
+    // methods
+    void BeginFrame(); // switches to the next query set, resolving what it held from two frames ago
+    void EndFrame();
+    void Finish(); // waits for and resolves the frames still in flight, call after the last frame
+    void BeginPass(const std::string& name);
+    void EndPass();
+    bool Enabled() const;
+
+    const std::vector<GpuPassTiming>& LastResults() const; // passes of the newest resolved frame
+    const std::vector<std::string>& PassNames() const;
+    const std::vector<double>& History(const std::string& name) const; // empty unless constructed with keepHistory
+    unsigned int DroppedFrames() const;
+    void Report(std::ostream& stream); // prints the average per pass since the last report
+};
+
+// times the enclosing block as one pass, e.g. { GpuProfileScope scope(profiler, "plane"); glDrawArrays(...); }
+class GpuProfileScope {
+private:
+    GpuProfiler& profiler;
+public:
+    GpuProfileScope(GpuProfiler& profiler, const std::string& name) : profiler(profiler) {
+        profiler.BeginPass(name);
+    }
+    ~GpuProfileScope() {
+        profiler.EndPass();
+    }
+};
+
+#endif
@@ -0,0 +1,146 @@
+#include "HeadlessContext.h"
+
+#include <iostream>
+
+#ifdef _WIN32
+
+HeadlessContext::HeadlessContext() : window(nullptr) {
+}
+
+HeadlessContext::~HeadlessContext() {
+    Destroy();
+}
+
+bool HeadlessContext::Create(unsigned int width, unsigned int height) {
+    if (!glfwInit()) {
+        return false;
+    }
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE); // window only exists to own the context
+    window = glfwCreateWindow(width, height, "Headless", NULL, NULL);
+    if (window == NULL) {
+        glfwTerminate();
+        return false;
+    }
+    glfwMakeContextCurrent(window);
+    return true;
+}
+
+void HeadlessContext::Destroy() {
+    if (window != nullptr) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        window = nullptr;
+    }
+}
+
+void* HeadlessContext::GetProcAddress(const char* name) {
+    return (void*)glfwGetProcAddress(name);
+}
+
+#else
+
+HeadlessContext::HeadlessContext() : display(EGL_NO_DISPLAY), context(EGL_NO_CONTEXT), surface(EGL_NO_SURFACE) {
+}
+
+HeadlessContext::~HeadlessContext() {
+    Destroy();
+}
+
+bool HeadlessContext::Create(unsigned int width, unsigned int height) {
+    // prefer Mesa's surfaceless platform, it needs neither an X server nor a DRM device
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (getPlatformDisplay != nullptr) {
+        display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    }
+    if (display == EGL_NO_DISPLAY) {
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+    EGLint major, minor;
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)) {
+        std::cout << "Failed to initialize EGL display" << std::endl;
+        display = EGL_NO_DISPLAY;
+        return false;
+    }
+
+    // ask for a pbuffer capable config first, the surfaceless platform may only offer configs without one
+    EGLint configAttribs[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_BLUE_SIZE, 8,
+        EGL_DEPTH_SIZE, 24,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint numConfigs = 0;
+    bool hasPbuffer = eglChooseConfig(display, configAttribs, &config, 1, &numConfigs) && numConfigs > 0;
+    if (!hasPbuffer) {
+        configAttribs[1] = 0;
+        if (!eglChooseConfig(display, configAttribs, &config, 1, &numConfigs) || numConfigs == 0) {
+            std::cout << "Failed to find an EGL config with desktop OpenGL support" << std::endl;
+            Destroy();
+            return false;
+        }
+    }
+
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        std::cout << "Failed to bind the desktop OpenGL API through EGL" << std::endl;
+        Destroy();
+        return false;
+    }
+    const EGLint contextAttribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+    if (context == EGL_NO_CONTEXT) {
+        std::cout << "Failed to create EGL context" << std::endl;
+        Destroy();
+        return false;
+    }
+
+    // a pbuffer is only a fallback default framebuffer, all rendering goes into an FBO anyway
+    if (hasPbuffer) {
+        const EGLint pbufferAttribs[] = {
+            EGL_WIDTH, (EGLint)width,
+            EGL_HEIGHT, (EGLint)height,
+            EGL_NONE
+        };
+        surface = eglCreatePbufferSurface(display, config, pbufferAttribs);
+    }
+    if (!eglMakeCurrent(display, surface, surface, context)) {
+        std::cout << "Failed to make EGL context current" << std::endl;
+        Destroy();
+        return false;
+    }
+    return true;
+}
+
+void HeadlessContext::Destroy() {
+    if (display == EGL_NO_DISPLAY) {
+        return;
+    }
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (surface != EGL_NO_SURFACE) {
+        eglDestroySurface(display, surface);
+        surface = EGL_NO_SURFACE;
+    }
+    if (context != EGL_NO_CONTEXT) {
+        eglDestroyContext(display, context);
+        context = EGL_NO_CONTEXT;
+    }
+    eglTerminate(display);
+    display = EGL_NO_DISPLAY;
+}
+
+void* HeadlessContext::GetProcAddress(const char* name) {
+    return (void*)eglGetProcAddress(name);
+}
+
+#endif
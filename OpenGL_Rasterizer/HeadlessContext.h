@@ -0,0 +1,33 @@
+#ifndef HEADLESS_CONTEXT_H
+#define HEADLESS_CONTEXT_H
+
+#ifdef _WIN32
+#include <GLFW/glfw3.h>
+#else
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+// OpenGL 3.3 core context that does not need a display, for render nodes and CI
+// uses an EGL surfaceless (or pbuffer) context, which Mesa's llvmpipe supports without a GPU
+// on Windows there is no EGL, so it falls back to a hidden GLFW window
+class HeadlessContext {
+private:
+#ifdef _WIN32
+    GLFWwindow* window;
+#else
+    EGLDisplay display;
+    EGLContext context;
+    EGLSurface surface;
+#endif
+public:
+    HeadlessContext(); // constructor
+    ~HeadlessContext(); // destructor, releases the context if it was created
+
+    // methods
+    bool Create(unsigned int width, unsigned int height); // creates the context and makes it current
+    void Destroy();
+    static void* GetProcAddress(const char* name); // loader passed to gladLoadGLLoader
+};
+
+#endif
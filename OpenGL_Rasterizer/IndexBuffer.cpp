@@ -1,19 +1,37 @@
-#include "IndexBuffer.h"
-
-IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int numbOfElements) {
-    glGenBuffers(1, &renderer_id);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, renderer_id);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, numbOfElements * sizeof(unsigned int), data, GL_STATIC_DRAW);
-}
-
-IndexBuffer::~IndexBuffer() {
-    glDeleteBuffers(1, &renderer_id);
-}
-
-void IndexBuffer::Bind() const {
-    glBindBuffer(GL_ARRAY_BUFFER, renderer_id);
-}
-
-void IndexBuffer::Unbind() const {
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+#include "IndexBuffer.h"
+#include "RenderState.h"
+
+#include <vector>
+
+IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int numbOfElements, GLenum type) : count(numbOfElements), type(type) {
+    glGenBuffers(1, &renderer_id);
+    RenderState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, renderer_id);
+    if (type == GL_UNSIGNED_SHORT) {
+        std::vector<unsigned short> shortIndices(data, data + numbOfElements);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, numbOfElements * sizeof(unsigned short), shortIndices.data(), GL_STATIC_DRAW);
+    }
+    else {
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, numbOfElements * sizeof(unsigned int), data, GL_STATIC_DRAW);
+    }
+}
+
+IndexBuffer::~IndexBuffer() {
+    RenderState::ForgetBuffer(renderer_id);
+    glDeleteBuffers(1, &renderer_id);
+}
+
+void IndexBuffer::Bind() const {
+    RenderState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, renderer_id);
+}
+
+void IndexBuffer::Unbind() const {
+    RenderState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+unsigned int IndexBuffer::GetCount() const {
+    return count;
+}
+
+GLenum IndexBuffer::GetType() const {
+    return type;
 }
\ No newline at end of file
@@ -1,13 +1,17 @@
-#include <glad/glad.h>
-
-class IndexBuffer {
-private:
-    unsigned int renderer_id; // for implementation of a renderer with ability to utilize different graphics APIs
-public:
-    IndexBuffer(const unsigned int* data, unsigned int numbOfElements); // constructor
-    ~IndexBuffer(); // destructor
-
-    // methods
-    void Bind() const; // binds vbo
-    void Unbind() const; // unbinds vbo
+#include <glad/glad.h>
+
+class IndexBuffer {
+private:
+    unsigned int renderer_id; // for implementation of a renderer with ability to utilize different graphics APIs
+    unsigned int count; // number of indices
+    GLenum type; // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT, what glDrawElements is told the indices are
+public:
+    IndexBuffer(const unsigned int* data, unsigned int numbOfElements, GLenum type = GL_UNSIGNED_INT); // constructor, GL_UNSIGNED_SHORT halves the buffer
+    ~IndexBuffer(); // destructor
+
+    // methods
+    void Bind() const; // binds ebo, the binding is stored in whichever vao is bound
+    void Unbind() const; // unbinds ebo
+    unsigned int GetCount() const;
+    GLenum GetType() const;
 };
\ No newline at end of file
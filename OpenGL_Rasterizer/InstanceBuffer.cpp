@@ -0,0 +1,103 @@
+#include "InstanceBuffer.h"
+#include "RenderState.h"
+
+#include <cstddef>
+
+// fills the staging copy with each model matrix next to its normal matrix
+static void packInstances(InstanceData* staging, const glm::mat4* transforms, unsigned int begin, unsigned int end) {
+    for (unsigned int i = begin; i < end; i++) {
+        staging[i].model = transforms[i];
+        staging[i].normalMatrix = ComputeNormalMatrix(transforms[i]);
+    }
+}
+
+static void packInstances(std::vector<InstanceData>& staging, const glm::mat4* transforms, unsigned int count) {
+    staging.resize(count);
+    packInstances(staging.data(), transforms, 0, count);
+}
+
+std::vector<InstanceData> InstanceBuffer::Pack(const glm::mat4* transforms, unsigned int count) {
+    std::vector<InstanceData> instances;
+    packInstances(instances, transforms, count);
+    return instances;
+}
+
+std::vector<InstanceData> InstanceBuffer::Pack(const glm::mat4* transforms, unsigned int count, JobSystem& jobs) {
+    std::vector<InstanceData> instances(count);
+    jobs.ParallelFor(count, 1024, [&](unsigned int begin, unsigned int end, unsigned int) {
+        packInstances(instances.data(), transforms, begin, end);
+    });
+    return instances;
+}
+
+InstanceBuffer::InstanceBuffer(const glm::mat4* transforms, unsigned int count) : capacity(count), count(count) {
+    packInstances(staging, transforms, count);
+    glGenBuffers(1, &renderer_id);
+    RenderState::BindBuffer(GL_ARRAY_BUFFER, renderer_id);
+    glBufferData(GL_ARRAY_BUFFER, count * sizeof(InstanceData), staging.data(), GL_DYNAMIC_DRAW);
+}
+
+InstanceBuffer::~InstanceBuffer() {
+    RenderState::ForgetBuffer(renderer_id);
+    glDeleteBuffers(1, &renderer_id);
+}
+
+void InstanceBuffer::SetTransforms(const glm::mat4* transforms, unsigned int newCount) {
+    packInstances(staging, transforms, newCount);
+    upload(staging.data(), newCount);
+}
+
+void InstanceBuffer::SetInstances(const InstanceData* instances, unsigned int newCount) {
+    upload(instances, newCount);
+}
+
+void InstanceBuffer::upload(const InstanceData* instances, unsigned int newCount) {
+    RenderState::BindBuffer(GL_ARRAY_BUFFER, renderer_id);
+    if (newCount > capacity) {
+        capacity = newCount;
+        glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(InstanceData), instances, GL_DYNAMIC_DRAW);
+    }
+    else {
+        // orphan the old storage so the driver doesn't wait for draws still reading it
+        glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(InstanceData), nullptr, GL_DYNAMIC_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, newCount * sizeof(InstanceData), instances);
+    }
+    count = newCount;
+}
+
+void InstanceBuffer::AttachToVertexArray() const {
+    RenderState::BindBuffer(GL_ARRAY_BUFFER, renderer_id);
+    for (unsigned int column = 0; column < 4; column++) {
+        unsigned int location = MODEL_LOCATION + column;
+        glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)(offsetof(InstanceData, model) + column * sizeof(glm::vec4)));
+        glEnableVertexAttribArray(location);
+        glVertexAttribDivisor(location, 1); // advance once per instance
+    }
+    // only xyz of each padded normal matrix column is read
+    for (unsigned int column = 0; column < 3; column++) {
+        unsigned int location = NORMAL_MATRIX_LOCATION + column;
+        glVertexAttribPointer(location, 3, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)(offsetof(InstanceData, normalMatrix) + column * sizeof(glm::vec4)));
+        glEnableVertexAttribArray(location);
+        glVertexAttribDivisor(location, 1);
+    }
+}
+
+unsigned int InstanceBuffer::Count() const {
+    return count;
+}
+
+void InstanceBuffer::Bind() const {
+    RenderState::BindBuffer(GL_ARRAY_BUFFER, renderer_id);
+}
+
+void InstanceBuffer::Unbind() const {
+    RenderState::BindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void InstanceBuffer::DrawArrays(GLenum mode, int first, int vertexCount) const {
+    glDrawArraysInstanced(mode, first, vertexCount, count);
+}
+
+void InstanceBuffer::DrawElements(GLenum mode, int indexCount, GLenum indexType, const void* indexOffset) const {
+    glDrawElementsInstanced(mode, indexCount, indexType, indexOffset, count);
+}
@@ -0,0 +1,53 @@
+#ifndef INSTANCE_BUFFER_H
+#define INSTANCE_BUFFER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+#include "JobSystem.h"
+#include "Transform.h"
+
+// what the vertex shader reads for each instance
+// "layout (location = 3) in mat4 instanceModel" takes locations 3 to 6, "layout (location = 7) in mat3 instanceNormalMatrix" takes 7 to 9
+struct InstanceData {
+    glm::mat4 model;
+    NormalMatrix normalMatrix; // computed on the CPU once per instance instead of once per vertex
+};
+
+// per instance model and normal matrices, each attribute advances once per instance instead of once per vertex
+class InstanceBuffer {
+private:
+    unsigned int renderer_id;
+    unsigned int capacity; // instances the buffer currently has room for
+    unsigned int count; // instances actually in use
+    std::vector<InstanceData> staging; // reused between uploads so SetTransforms doesn't allocate
+
+    void upload(const InstanceData* instances, unsigned int newCount);
+public:
+    static const unsigned int MODEL_LOCATION = 3;
+    static const unsigned int NORMAL_MATRIX_LOCATION = 7;
+
+    static std::vector<InstanceData> Pack(const glm::mat4* transforms, unsigned int count); // model matrices with their normal matrices, for callers that keep instances around
+    static std::vector<InstanceData> Pack(const glm::mat4* transforms, unsigned int count, JobSystem& jobs); // same, the normal matrices worked out in parallel
+
+    InstanceBuffer(const glm::mat4* transforms, unsigned int count); // constructor
+    ~InstanceBuffer(); // destructor
+    InstanceBuffer(const InstanceBuffer&) = delete;
+    InstanceBuffer& operator=(const InstanceBuffer&) = delete;
+
+    // methods
+    void SetTransforms(const glm::mat4* transforms, unsigned int count); // replaces the matrices (and their normal matrices), growing the buffer if needed
+    void SetInstances(const InstanceData* instances, unsigned int count); // same with already packed instances, nothing is recomputed
+    void AttachToVertexArray() const; // sets up the instance attributes on the currently bound vao
+    unsigned int Count() const;
+    void Bind() const; // binds the buffer to GL_ARRAY_BUFFER
+    void Unbind() const;
+
+    // draws every instance with one call, the vao the buffer is attached to must be bound
+    void DrawArrays(GLenum mode, int first, int vertexCount) const;
+    void DrawElements(GLenum mode, int indexCount, GLenum indexType, const void* indexOffset) const;
+};
+
+#endif
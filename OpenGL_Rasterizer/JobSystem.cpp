@@ -0,0 +1,309 @@
+#include "JobSystem.h"
+
+#include <algorithm>
+
+// which system and worker the running thread belongs to, worker threads set it on start
+static thread_local const JobSystem* currentSystem = nullptr;
+static thread_local unsigned int currentIndex = 0;
+static thread_local bool runningBackground = false; // set while the thread runs a background job
+
+static const unsigned int IDLE_SPINS = 64; // failed takes before a worker goes to sleep, a loop's next jobs usually arrive within them
+
+JobCounter::JobCounter() : count(0) {
+}
+
+bool JobCounter::Done() const {
+    return count.load(std::memory_order_acquire) == 0;
+}
+
+JobSystem::Deque::Deque() : top(0), bottom(0), ring(new std::atomic<Job*>[CAPACITY]) {
+}
+
+bool JobSystem::Deque::Push(Job* job) {
+    int64_t b = bottom.load(std::memory_order_relaxed);
+    int64_t t = top.load(std::memory_order_acquire);
+    if (b - t >= CAPACITY) {
+        return false;
+    }
+    ring[b & (CAPACITY - 1)].store(job, std::memory_order_relaxed);
+    bottom.store(b + 1, std::memory_order_release); // the job is written before a thief can see the new bottom
+    return true;
+}
+
+Job* JobSystem::Deque::Pop() {
+    int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+    bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst); // a thief either sees the lowered bottom or its top is seen here
+    int64_t t = top.load(std::memory_order_relaxed);
+    if (t > b) {
+        bottom.store(b + 1, std::memory_order_relaxed); // was empty
+        return nullptr;
+    }
+    Job* job = ring[b & (CAPACITY - 1)].load(std::memory_order_relaxed);
+    if (t == b) {
+        // the last job, thieves may be going for it too and whoever moves top first has it
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            job = nullptr;
+        }
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+    return job;
+}
+
+Job* JobSystem::Deque::Steal() {
+    int64_t t = top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = bottom.load(std::memory_order_acquire);
+    if (t >= b) {
+        return nullptr;
+    }
+    // the slot can't be reused while top is still t, so if the exchange works the job read here is the right one
+    Job* job = ring[t & (CAPACITY - 1)].load(std::memory_order_relaxed);
+    if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        return nullptr;
+    }
+    return job;
+}
+
+JobSystem::JobSystem(unsigned int threadCount) : queued(0), sleeping(0), steals(0), stopping(false) {
+    threadCount = std::max(threadCount, 1u);
+    for (unsigned int i = 0; i < threadCount; i++) {
+        deques.emplace_back(new Deque());
+    }
+    for (unsigned int i = 1; i < threadCount; i++) {
+        threads.emplace_back(&JobSystem::workerLoop, this, i);
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    for (std::unique_ptr<Deque>& deque : deques) {
+        while (Job* job = deque->Pop()) {
+            delete job;
+        }
+    }
+    for (Job* job : background) {
+        delete job;
+    }
+}
+
+void JobSystem::workerLoop(unsigned int worker) {
+    currentSystem = this;
+    currentIndex = worker;
+    unsigned int idle = 0;
+    while (true) {
+        Job* job = take(worker);
+        if (job == nullptr) {
+            job = takeBackground();
+        }
+        if (job != nullptr) {
+            execute(worker, job);
+            idle = 0;
+            continue;
+        }
+        if (++idle < IDLE_SPINS) {
+            std::this_thread::yield();
+            continue;
+        }
+        idle = 0;
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        if (stopping) {
+            return;
+        }
+        // push checks sleeping after raising queued, so either it sees this worker asleep and notifies or the wait sees the job
+        sleeping.fetch_add(1, std::memory_order_seq_cst);
+        wake.wait(lock, [this] { return stopping || queued.load(std::memory_order_seq_cst) > 0; });
+        sleeping.fetch_sub(1, std::memory_order_relaxed);
+        if (stopping) {
+            return;
+        }
+    }
+}
+
+unsigned int JobSystem::currentWorker() const {
+    return currentSystem == this ? currentIndex : 0;
+}
+
+void JobSystem::push(unsigned int worker, Job* job) {
+    queued.fetch_add(1, std::memory_order_seq_cst);
+    if (job->background) {
+        // at the front, so a background job's own chunks run before the next queued one is started
+        std::lock_guard<std::mutex> lock(backgroundMutex);
+        background.push_front(job);
+    }
+    else if (!deques[worker]->Push(job)) {
+        queued.fetch_sub(1, std::memory_order_relaxed);
+        execute(worker, job);
+        return;
+    }
+    wakeWorker();
+}
+
+void JobSystem::wakeWorker() {
+    if (sleeping.load(std::memory_order_seq_cst) > 0) {
+        {
+            // a worker between raising sleeping and waiting holds the lock, so the notify can't slip in before its wait
+            std::lock_guard<std::mutex> lock(wakeMutex);
+        }
+        wake.notify_one();
+    }
+}
+
+Job* JobSystem::take(unsigned int worker) {
+    Job* job = deques[worker]->Pop();
+    // start with the next worker along so thieves don't all pile onto worker 0
+    for (unsigned int i = 1; i < deques.size() && job == nullptr; i++) {
+        job = deques[(worker + i) % deques.size()]->Steal();
+        if (job != nullptr) {
+            steals.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    if (job != nullptr) {
+        queued.fetch_sub(1, std::memory_order_relaxed);
+    }
+    return job;
+}
+
+Job* JobSystem::takeBackground() {
+    std::lock_guard<std::mutex> lock(backgroundMutex);
+    if (background.empty()) {
+        return nullptr;
+    }
+    Job* job = background.front();
+    background.pop_front();
+    queued.fetch_sub(1, std::memory_order_relaxed);
+    return job;
+}
+
+bool JobSystem::inBackground() const {
+    return runningBackground && currentSystem == this;
+}
+
+void JobSystem::execute(unsigned int worker, Job* job) {
+    bool outer = runningBackground;
+    runningBackground = job->background;
+    job->function(worker);
+    runningBackground = outer;
+    JobCounter* counter = job->counter;
+    delete job;
+    finish(worker, counter);
+}
+
+void JobSystem::finish(unsigned int worker, JobCounter* counter) {
+    if (counter == nullptr) {
+        return;
+    }
+    std::vector<Job*> ready;
+    {
+        std::lock_guard<std::mutex> lock(counter->mutex);
+        if (counter->count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            ready.swap(counter->continuations);
+        }
+    }
+    // the counter may be gone once its lock is dropped, its continuations were taken out before
+    for (Job* job : ready) {
+        push(worker, job);
+    }
+}
+
+Job* JobSystem::newJob(const JobFunction& function, JobCounter* counter) const {
+    return new Job{ function, counter, inBackground() };
+}
+
+void JobSystem::Run(const JobFunction& job, JobCounter* counter) {
+    if (counter != nullptr) {
+        counter->count.fetch_add(1, std::memory_order_relaxed);
+    }
+    push(currentWorker(), newJob(job, counter));
+}
+
+void JobSystem::RunAfter(JobCounter& dependency, const JobFunction& job, JobCounter* counter) {
+    if (counter != nullptr) {
+        counter->count.fetch_add(1, std::memory_order_relaxed);
+    }
+    Job* continuation = newJob(job, counter);
+    {
+        std::lock_guard<std::mutex> lock(dependency.mutex);
+        if (dependency.count.load(std::memory_order_acquire) != 0) {
+            dependency.continuations.push_back(continuation); // the job that finishes the dependency queues it
+            return;
+        }
+    }
+    push(currentWorker(), continuation);
+}
+
+void JobSystem::RunBackground(const JobFunction& job, JobCounter* counter) {
+    if (counter != nullptr) {
+        counter->count.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (threads.empty()) {
+        execute(currentWorker(), new Job{ job, counter, false });
+        return;
+    }
+    queued.fetch_add(1, std::memory_order_seq_cst);
+    {
+        std::lock_guard<std::mutex> lock(backgroundMutex);
+        background.push_back(new Job{ job, counter, true });
+    }
+    wakeWorker();
+}
+
+void JobSystem::Wait(JobCounter& counter) {
+    unsigned int worker = currentWorker();
+    while (counter.count.load(std::memory_order_acquire) != 0) {
+        Job* job = take(worker);
+        if (job == nullptr && inBackground()) {
+            job = takeBackground(); // a worker thread waiting on a background job's chunks may have to run them itself
+        }
+        if (job != nullptr) {
+            execute(worker, job);
+        }
+        else {
+            std::this_thread::yield();
+        }
+    }
+    // the job that brought the count to zero may still be holding the lock, the counter can't go away under it
+    std::lock_guard<std::mutex> lock(counter.mutex);
+}
+
+// queues the upper half and keeps the lower until one chunk is left, chunk edges stay on multiples of grain
+void JobSystem::splitRange(unsigned int begin, unsigned int end, unsigned int grain, const RangeFunction* body, JobCounter* counter, unsigned int worker) {
+    while (end - begin > grain) {
+        unsigned int chunks = (end - begin + grain - 1) / grain;
+        unsigned int middle = begin + chunks / 2 * grain;
+        counter->count.fetch_add(1, std::memory_order_relaxed);
+        push(worker, newJob([this, middle, end, grain, body, counter](unsigned int thief) { splitRange(middle, end, grain, body, counter, thief); }, counter));
+        end = middle;
+    }
+    (*body)(begin, end, worker);
+}
+
+void JobSystem::ParallelFor(unsigned int count, unsigned int grain, const RangeFunction& body) {
+    if (count == 0) {
+        return;
+    }
+    grain = std::max(grain, 1u);
+    unsigned int worker = currentWorker();
+    if (deques.size() == 1 || count <= grain) {
+        body(0, count, worker);
+        return;
+    }
+    JobCounter counter;
+    splitRange(0, count, grain, &body, &counter, worker);
+    Wait(counter);
+}
+
+unsigned int JobSystem::WorkerCount() const {
+    return (unsigned int)deques.size();
+}
+
+unsigned int JobSystem::Steals() const {
+    return steals.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,113 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class JobCounter;
+
+// a queued piece of work, owned by the job system from Run until it has run
+struct Job {
+    std::function<void(unsigned int worker)> function;
+    JobCounter* counter; // may be nullptr
+    bool background; // queued by or under RunBackground, goes on the background queue
+};
+
+// counts the jobs of a group that haven't finished, jobs run with a counter add one when queued and take it off when done
+// Wait blocks until it is back at zero, and RunAfter holds a job back until then
+// must outlive every job queued against it
+class JobCounter {
+private:
+    friend class JobSystem;
+
+    std::atomic<unsigned int> count;
+    std::mutex mutex; // guards continuations, and is held while the count drops so Wait can't return under a finishing job
+    std::vector<Job*> continuations; // jobs waiting for the count to reach zero
+public:
+    JobCounter(); // constructor
+    JobCounter(const JobCounter&) = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+
+    // methods
+    bool Done() const; // nothing queued against it is still pending
+};
+
+// a fixed pool of worker threads with a work stealing deque each, the thread that built the system works too as worker 0
+// a worker pushes and pops jobs at the bottom of its own deque (lock free Chase-Lev), so what it queued last runs first while
+// it is still in cache, and idle workers steal the oldest jobs from the top of another's, which are the biggest pieces of a split loop
+// waiting never blocks a worker: Wait runs other jobs until its counter is done, and RunAfter queues a continuation instead
+// Run, RunAfter, Wait and ParallelFor must be called from the thread that built the system or from inside a job
+// RunBackground is for long work the building thread must never end up doing while it helps in Wait, such as streaming
+class JobSystem {
+public:
+    typedef std::function<void(unsigned int worker)> JobFunction; // worker is 0 to WorkerCount() - 1, for per thread scratch data
+    // begin and end of the chunk, and which worker runs it
+    typedef std::function<void(unsigned int begin, unsigned int end, unsigned int worker)> RangeFunction;
+private:
+    // Chase-Lev deque with a fixed ring, a push onto a full ring runs the job there and then instead
+    struct Deque {
+        static const int64_t CAPACITY = 4096; // power of two
+
+        alignas(64) std::atomic<int64_t> top; // thieves take from here
+        alignas(64) std::atomic<int64_t> bottom; // only the owner moves this
+        std::unique_ptr<std::atomic<Job*>[]> ring;
+
+        Deque();
+        bool Push(Job* job); // owner only, false when full
+        Job* Pop(); // owner only, newest first
+        Job* Steal(); // any thread, oldest first, nullptr when empty or another thief won the race
+    };
+
+    std::vector<std::thread> threads;
+    std::vector<std::unique_ptr<Deque>> deques; // one per worker, the building thread's included
+    std::deque<Job*> background; // only worker threads take from here, oldest first
+    std::mutex backgroundMutex;
+    std::atomic<int> queued; // jobs sitting in a deque or the background queue, sleeping workers wake when this goes up
+    std::atomic<unsigned int> sleeping;
+    std::atomic<unsigned int> steals;
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    bool stopping;
+
+    void workerLoop(unsigned int worker);
+    unsigned int currentWorker() const;
+    void push(unsigned int worker, Job* job); // onto the worker's deque, or the front of the background queue for background jobs
+    void wakeWorker(); // after queued went up
+    Job* take(unsigned int worker); // from the worker's own deque or stolen from another, nullptr if every deque looked empty
+    Job* takeBackground(); // worker threads only, once take found nothing
+    bool inBackground() const; // the calling thread is running a background job
+    void execute(unsigned int worker, Job* job); // runs it, deletes it and counts it off
+    Job* newJob(const JobFunction& function, JobCounter* counter) const; // a background job when queued from one
+    void finish(unsigned int worker, JobCounter* counter); // releases the continuations when the count reaches zero
+    void splitRange(unsigned int begin, unsigned int end, unsigned int grain, const RangeFunction* body, JobCounter* counter, unsigned int worker);
+public:
+    JobSystem(unsigned int threadCount); // constructor, threadCount includes the calling thread
+    ~JobSystem(); // destructor, joins the workers, everything queued must have been waited for
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // methods
+    void Run(const JobFunction& job, JobCounter* counter); // queues the job on the calling worker, counter may be nullptr
+    void RunAfter(JobCounter& dependency, const JobFunction& job, JobCounter* counter); // queues the job once dependency is done
+    // queues the job for the worker threads alone, Wait on the building thread never picks it up, so it runs only when a worker
+    // is free of other jobs; with no worker threads it runs here and now instead
+    // whatever the job queues itself (Run, RunAfter, ParallelFor chunks) is background work too and stays off the building thread
+    void RunBackground(const JobFunction& job, JobCounter* counter);
+    void Wait(JobCounter& counter); // runs queued jobs (any, not only the counter's) until the counter is done
+    // calls body over [0, count) in chunks of at most grain indices and returns once every chunk has run
+    // the range is split in halves, one queued and one kept, so thieves take big pieces and the owner works through neighbouring chunks
+    // nests, a body may run its own loops; a body that waits can have other chunks run on its worker meanwhile, so per worker
+    // scratch data is only safe in bodies that don't wait
+    void ParallelFor(unsigned int count, unsigned int grain, const RangeFunction& body);
+    unsigned int WorkerCount() const;
+    unsigned int Steals() const; // jobs taken from another worker's deque since construction
+};
+
+#endif
@@ -0,0 +1,84 @@
+#include "MeshBuilder.h"
+
+#include <cstring>
+
+unsigned int MeshData::VertexCount() const {
+    return floatsPerVertex == 0 ? 0 : (unsigned int)(vertices.size() / floatsPerVertex);
+}
+
+GLenum MeshData::IndexType() const {
+    return VertexCount() <= 65536 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+}
+
+std::vector<float> MeshData::Positions() const {
+    std::vector<float> positions;
+    positions.reserve(VertexCount() * 3);
+    for (unsigned int v = 0; v < VertexCount(); v++) {
+        const float* vertex = &vertices[(size_t)v * floatsPerVertex];
+        positions.insert(positions.end(), vertex, vertex + 3);
+    }
+    return positions;
+}
+
+size_t MeshBuilder::VertexHash::operator()(unsigned int index) const {
+    // FNV-1a over the bits of each float
+    const float* vertex = &builder->vertices[(size_t)index * builder->floatsPerVertex];
+    size_t hash = 14695981039346656037ull;
+    for (unsigned int i = 0; i < builder->floatsPerVertex; i++) {
+        float value = vertex[i] == 0.0f ? 0.0f : vertex[i]; // -0.0 compares equal to 0.0, so it has to hash the same
+        unsigned int bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        for (unsigned int byte = 0; byte < 4; byte++) {
+            hash ^= (bits >> (byte * 8)) & 0xFF;
+            hash *= 1099511628211ull;
+        }
+    }
+    return hash;
+}
+
+bool MeshBuilder::VertexEqual::operator()(unsigned int a, unsigned int b) const {
+    const float* vertexA = &builder->vertices[(size_t)a * builder->floatsPerVertex];
+    const float* vertexB = &builder->vertices[(size_t)b * builder->floatsPerVertex];
+    for (unsigned int i = 0; i < builder->floatsPerVertex; i++) {
+        if (vertexA[i] != vertexB[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+MeshBuilder::MeshBuilder(unsigned int floatsPerVertex)
+    : floatsPerVertex(floatsPerVertex), lookup(64, VertexHash{ this }, VertexEqual{ this }) {
+}
+
+unsigned int MeshBuilder::AddVertex(const float* vertex) {
+    // append the candidate so the set can hash it by index, then drop it again if it's a duplicate
+    unsigned int candidate = (unsigned int)(vertices.size() / floatsPerVertex);
+    vertices.insert(vertices.end(), vertex, vertex + floatsPerVertex);
+    std::pair<std::unordered_set<unsigned int, VertexHash, VertexEqual>::iterator, bool> result = lookup.insert(candidate);
+    if (!result.second) {
+        vertices.resize(vertices.size() - floatsPerVertex);
+    }
+    indices.push_back(*result.first);
+    return *result.first;
+}
+
+void MeshBuilder::AddTriangles(const float* data, unsigned int vertexCount) {
+    for (unsigned int i = 0; i < vertexCount; i++) {
+        AddVertex(data + (size_t)i * floatsPerVertex);
+    }
+}
+
+MeshData MeshBuilder::Build() const {
+    MeshData mesh;
+    mesh.floatsPerVertex = floatsPerVertex;
+    mesh.vertices = vertices;
+    mesh.indices = indices;
+    return mesh;
+}
+
+MeshData MeshBuilder::FromTriangles(const float* data, unsigned int vertexCount, unsigned int floatsPerVertex) {
+    MeshBuilder builder(floatsPerVertex);
+    builder.AddTriangles(data, vertexCount);
+    return builder.Build();
+}
@@ -0,0 +1,53 @@
+#ifndef MESH_BUILDER_H
+#define MESH_BUILDER_H
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <vector>
+#include <unordered_set>
+
+// an indexed mesh, vertices are interleaved floats in whatever layout the vao expects
+struct MeshData {
+    unsigned int floatsPerVertex = 0;
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices; // kept 32 bit here, IndexBuffer narrows them to IndexType() on upload
+
+    unsigned int VertexCount() const;
+    GLenum IndexType() const; // GL_UNSIGNED_SHORT while every index fits in 16 bits, otherwise GL_UNSIGNED_INT
+    std::vector<float> Positions() const; // just the first three floats of every vertex, for position only passes
+};
+
+// welds identical vertices (every float equal) into one, so a vertex shared by several triangles
+// is stored and transformed once and the post transform cache can reuse it
+class MeshBuilder {
+private:
+    // the set stores vertex indices, these hash and compare the floats those indices point at
+    struct VertexHash {
+        const MeshBuilder* builder;
+        size_t operator()(unsigned int index) const;
+    };
+    struct VertexEqual {
+        const MeshBuilder* builder;
+        bool operator()(unsigned int a, unsigned int b) const;
+    };
+
+    unsigned int floatsPerVertex;
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+    std::unordered_set<unsigned int, VertexHash, VertexEqual> lookup;
+public:
+    MeshBuilder(unsigned int floatsPerVertex); // constructor
+    MeshBuilder(const MeshBuilder&) = delete; // the lookup points back at this builder
+    MeshBuilder& operator=(const MeshBuilder&) = delete;
+
+    // methods
+    unsigned int AddVertex(const float* vertex); // returns the index of the matching vertex, adding it if it's new
+    void AddTriangles(const float* data, unsigned int vertexCount); // an unindexed triangle list, three vertices per triangle
+    MeshData Build() const;
+
+    // welds an unindexed triangle list like the ones glDrawArrays takes
+    static MeshData FromTriangles(const float* data, unsigned int vertexCount, unsigned int floatsPerVertex);
+};
+
+#endif
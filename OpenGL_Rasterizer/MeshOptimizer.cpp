@@ -0,0 +1,195 @@
+#include "MeshOptimizer.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+
+VertexCacheStats AnalyzeVertexCache(const std::vector<unsigned int>& indices, unsigned int vertexCount, unsigned int cacheSize) {
+    // a vertex is still cached while fewer than cacheSize misses happened since it went in
+    std::vector<unsigned int> insertedAt(vertexCount, 0);
+    std::vector<bool> seen(vertexCount, false);
+    unsigned int misses = 0;
+    for (unsigned int index : indices) {
+        if (!seen[index] || misses - insertedAt[index] >= cacheSize) {
+            insertedAt[index] = misses;
+            seen[index] = true;
+            misses++;
+        }
+    }
+    VertexCacheStats stats;
+    stats.acmr = indices.empty() ? 0.0 : (double)misses / (indices.size() / 3);
+    stats.atvr = vertexCount == 0 ? 0.0 : (double)misses / vertexCount;
+    return stats;
+}
+
+void OptimizeVertexCache(std::vector<unsigned int>& indices, unsigned int vertexCount, unsigned int cacheSize) {
+    unsigned int triangleCount = (unsigned int)(indices.size() / 3);
+    if (triangleCount == 0) {
+        return;
+    }
+
+    // vertex to triangle adjacency, flattened with offsets
+    std::vector<unsigned int> liveTriangles(vertexCount, 0);
+    for (unsigned int index : indices) {
+        liveTriangles[index]++;
+    }
+    std::vector<unsigned int> offsets(vertexCount + 1, 0);
+    for (unsigned int v = 0; v < vertexCount; v++) {
+        offsets[v + 1] = offsets[v] + liveTriangles[v];
+    }
+    std::vector<unsigned int> adjacency(indices.size());
+    std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+    for (unsigned int t = 0; t < triangleCount; t++) {
+        for (unsigned int corner = 0; corner < 3; corner++) {
+            adjacency[fill[indices[t * 3 + corner]]++] = t;
+        }
+    }
+
+    std::vector<unsigned int> cacheTime(vertexCount, 0);
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<unsigned int> deadEnds; // recently used vertices to fall back to when the fan runs out
+    std::vector<unsigned int> candidates;
+    std::vector<unsigned int> result;
+    result.reserve(indices.size());
+    unsigned int time = cacheSize + 1;
+    unsigned int cursor = 0; // next vertex to try when the dead end stack is empty too
+
+    // picks a vertex with live triangles, from the dead end stack first and then in input order, -1 once everything is emitted
+    auto skipDeadEnd = [&]() -> int {
+        while (!deadEnds.empty()) {
+            unsigned int vertex = deadEnds.back();
+            deadEnds.pop_back();
+            if (liveTriangles[vertex] > 0) {
+                return (int)vertex;
+            }
+        }
+        while (cursor < vertexCount) {
+            if (liveTriangles[cursor] > 0) {
+                return (int)cursor;
+            }
+            cursor++;
+        }
+        return -1;
+    };
+
+    int fanning = skipDeadEnd();
+    while (fanning >= 0) {
+        // emit every remaining triangle around the fanning vertex
+        candidates.clear();
+        for (unsigned int a = offsets[fanning]; a < offsets[fanning + 1]; a++) {
+            unsigned int t = adjacency[a];
+            if (emitted[t]) {
+                continue;
+            }
+            for (unsigned int corner = 0; corner < 3; corner++) {
+                unsigned int vertex = indices[t * 3 + corner];
+                result.push_back(vertex);
+                deadEnds.push_back(vertex);
+                candidates.push_back(vertex);
+                liveTriangles[vertex]--;
+                if (time - cacheTime[vertex] > cacheSize) {
+                    cacheTime[vertex] = time++;
+                }
+            }
+            emitted[t] = true;
+        }
+
+        // next fan around the candidate that will still be in the cache after its own triangles go out, oldest first
+        int next = -1;
+        int bestPriority = -1;
+        for (unsigned int vertex : candidates) {
+            if (liveTriangles[vertex] == 0) {
+                continue;
+            }
+            int priority = 0;
+            if (time - cacheTime[vertex] + 2 * liveTriangles[vertex] <= cacheSize) {
+                priority = (int)(time - cacheTime[vertex]);
+            }
+            if (priority > bestPriority) {
+                bestPriority = priority;
+                next = (int)vertex;
+            }
+        }
+        fanning = next >= 0 ? next : skipDeadEnd();
+    }
+    indices.swap(result);
+}
+
+void OptimizeOverdraw(std::vector<unsigned int>& indices, const MeshData& mesh, unsigned int clusterSize) {
+    unsigned int triangleCount = (unsigned int)(indices.size() / 3);
+    if (triangleCount <= clusterSize || mesh.floatsPerVertex < 3) {
+        return; // a single cluster has nothing to sort against
+    }
+    auto position = [&mesh](unsigned int index) {
+        const float* vertex = &mesh.vertices[(size_t)index * mesh.floatsPerVertex];
+        return glm::vec3(vertex[0], vertex[1], vertex[2]);
+    };
+
+    glm::vec3 meshCentre(0.0f);
+    for (unsigned int index : indices) {
+        meshCentre += position(index);
+    }
+    meshCentre /= (float)indices.size();
+
+    struct Cluster {
+        unsigned int firstTriangle;
+        unsigned int triangleCount;
+        float sortKey;
+    };
+    std::vector<Cluster> clusters;
+    for (unsigned int first = 0; first < triangleCount; first += clusterSize) {
+        Cluster cluster = { first, std::min(clusterSize, triangleCount - first), 0.0f };
+        glm::vec3 centre(0.0f);
+        glm::vec3 normal(0.0f); // area weighted, the cross product's length is twice the area
+        for (unsigned int t = first; t < first + cluster.triangleCount; t++) {
+            glm::vec3 a = position(indices[t * 3]);
+            glm::vec3 b = position(indices[t * 3 + 1]);
+            glm::vec3 c = position(indices[t * 3 + 2]);
+            centre += a + b + c;
+            normal += glm::cross(b - a, c - a);
+        }
+        centre /= (float)(cluster.triangleCount * 3);
+        cluster.sortKey = glm::dot(centre - meshCentre, normal);
+        clusters.push_back(cluster);
+    }
+    std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& a, const Cluster& b) { return a.sortKey > b.sortKey; });
+
+    std::vector<unsigned int> result;
+    result.reserve(indices.size());
+    for (const Cluster& cluster : clusters) {
+        result.insert(result.end(), indices.begin() + cluster.firstTriangle * 3, indices.begin() + (cluster.firstTriangle + cluster.triangleCount) * 3);
+    }
+    indices.swap(result);
+}
+
+void OptimizeVertexFetch(MeshData& mesh) {
+    const unsigned int unassigned = 0xFFFFFFFF;
+    std::vector<unsigned int> remap(mesh.VertexCount(), unassigned);
+    std::vector<float> vertices;
+    vertices.reserve(mesh.vertices.size());
+    unsigned int nextVertex = 0;
+    for (unsigned int& index : mesh.indices) {
+        if (remap[index] == unassigned) {
+            remap[index] = nextVertex++;
+            const float* vertex = &mesh.vertices[(size_t)index * mesh.floatsPerVertex];
+            vertices.insert(vertices.end(), vertex, vertex + mesh.floatsPerVertex);
+        }
+        index = remap[index];
+    }
+    mesh.vertices.swap(vertices); // vertices no triangle uses are dropped
+}
+
+MeshOptimizeReport OptimizeMesh(const std::string& name, MeshData& mesh, bool sortForOverdraw) {
+    MeshOptimizeReport report;
+    report.name = name;
+    report.triangleCount = (unsigned int)(mesh.indices.size() / 3);
+    report.before = AnalyzeVertexCache(mesh.indices, mesh.VertexCount());
+    OptimizeVertexCache(mesh.indices, mesh.VertexCount());
+    if (sortForOverdraw) {
+        OptimizeOverdraw(mesh.indices, mesh);
+    }
+    OptimizeVertexFetch(mesh);
+    report.vertexCount = mesh.VertexCount();
+    report.after = AnalyzeVertexCache(mesh.indices, mesh.VertexCount());
+    return report;
+}
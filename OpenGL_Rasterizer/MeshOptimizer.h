@@ -0,0 +1,42 @@
+#ifndef MESH_OPTIMIZER_H
+#define MESH_OPTIMIZER_H
+
+#include <string>
+
+#include "MeshBuilder.h"
+
+// how well an index buffer uses a FIFO post transform cache
+struct VertexCacheStats {
+    double acmr; // average cache miss ratio, vertex shader runs per triangle (0.5 is the best a large grid can do, 3 is no reuse)
+    double atvr; // average transform to vertex ratio, vertex shader runs per unique vertex (1 is perfect)
+};
+
+// cache stats of a mesh before and after OptimizeMesh, reported by the benchmark
+struct MeshOptimizeReport {
+    std::string name;
+    unsigned int vertexCount;
+    unsigned int triangleCount;
+    VertexCacheStats before;
+    VertexCacheStats after;
+};
+
+const unsigned int VERTEX_CACHE_SIZE = 16; // entries assumed for both the optimizer and the simulation
+
+// simulates a FIFO cache of cacheSize entries over the triangle list
+VertexCacheStats AnalyzeVertexCache(const std::vector<unsigned int>& indices, unsigned int vertexCount, unsigned int cacheSize = VERTEX_CACHE_SIZE);
+
+// reorders triangles for post transform cache hits (Tipsify, Sander et al. 2007)
+void OptimizeVertexCache(std::vector<unsigned int>& indices, unsigned int vertexCount, unsigned int cacheSize = VERTEX_CACHE_SIZE);
+
+// sorts runs of clusterSize triangles so clusters facing away from the mesh centre draw first and occlude the rest
+// a view independent approximation of front to back, it only costs cache misses at the cluster boundaries
+// positions are the first three floats of each vertex
+void OptimizeOverdraw(std::vector<unsigned int>& indices, const MeshData& mesh, unsigned int clusterSize = 64);
+
+// renumbers vertices in the order the indices first use them, so vertex fetches walk the buffer forwards
+void OptimizeVertexFetch(MeshData& mesh);
+
+// runs the passes above in order (overdraw only if asked) and returns the cache stats either side
+MeshOptimizeReport OptimizeMesh(const std::string& name, MeshData& mesh, bool sortForOverdraw);
+
+#endif
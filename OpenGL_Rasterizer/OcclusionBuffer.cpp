@@ -0,0 +1,250 @@
+#include "OcclusionBuffer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define OCCLUSION_SSE
+#endif
+
+static const float NEAR_EPSILON = 1e-5f;
+
+OcclusionBuffer::OcclusionBuffer(unsigned int width, unsigned int height) : width((width + 3) & ~3u), height(height), viewProjection(1.0f), stats() {
+    unsigned int levelWidth = this->width;
+    unsigned int levelHeight = this->height;
+    while (true) {
+        levels.push_back(std::vector<float>((size_t)levelWidth * levelHeight, 1.0f));
+        levelWidths.push_back(levelWidth);
+        levelHeights.push_back(levelHeight);
+        if (levelWidth == 1 && levelHeight == 1) {
+            break;
+        }
+        levelWidth = std::max(1u, (levelWidth + 1) / 2);
+        levelHeight = std::max(1u, (levelHeight + 1) / 2);
+    }
+}
+
+void OcclusionBuffer::Begin(const glm::mat4& viewProjection) {
+    this->viewProjection = viewProjection;
+    stats = OcclusionStats();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::fill(levels[0].begin(), levels[0].end(), 1.0f);
+    stats.rasterMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void OcclusionBuffer::RasterizeOccluder(const std::vector<float>& positions, const std::vector<unsigned int>& indices, const glm::mat4& model) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    glm::mat4 modelViewProjection = viewProjection * model;
+    size_t vertexCount = positions.size() / 3;
+    clipVertices.resize(vertexCount);
+    for (size_t v = 0; v < vertexCount; v++) {
+        clipVertices[v] = modelViewProjection * glm::vec4(positions[v * 3], positions[v * 3 + 1], positions[v * 3 + 2], 1.0f);
+    }
+
+    auto toScreen = [&](const glm::vec4& clip) {
+        float inverseW = 1.0f / clip.w;
+        return glm::vec3((clip.x * inverseW * 0.5f + 0.5f) * width, (clip.y * inverseW * 0.5f + 0.5f) * height, clip.z * inverseW * 0.5f + 0.5f);
+    };
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        glm::vec4 triangle[3] = { clipVertices[indices[i]], clipVertices[indices[i + 1]], clipVertices[indices[i + 2]] };
+        // distance to the near plane z = -w, only that plane needs clipping since x and y are clamped to the buffer when rasterizing
+        float distances[3];
+        unsigned int inside = 0;
+        for (int v = 0; v < 3; v++) {
+            distances[v] = triangle[v].z + triangle[v].w;
+            inside += distances[v] >= 0.0f && triangle[v].w > NEAR_EPSILON ? 1 : 0;
+        }
+        if (inside == 0) {
+            continue;
+        }
+        if (inside == 3) {
+            rasterizeTriangle(toScreen(triangle[0]), toScreen(triangle[1]), toScreen(triangle[2]));
+            continue;
+        }
+        // Sutherland-Hodgman against the one plane, leaves a triangle or a quad
+        glm::vec4 polygon[4];
+        unsigned int corners = 0;
+        for (int v = 0; v < 3; v++) {
+            int next = (v + 1) % 3;
+            if (distances[v] >= 0.0f) {
+                polygon[corners++] = triangle[v];
+            }
+            if ((distances[v] >= 0.0f) != (distances[next] >= 0.0f)) {
+                float t = distances[v] / (distances[v] - distances[next]);
+                polygon[corners++] = triangle[v] + (triangle[next] - triangle[v]) * t;
+            }
+        }
+        for (unsigned int c = 1; c + 1 < corners; c++) {
+            if (polygon[0].w > NEAR_EPSILON && polygon[c].w > NEAR_EPSILON && polygon[c + 1].w > NEAR_EPSILON) {
+                rasterizeTriangle(toScreen(polygon[0]), toScreen(polygon[c]), toScreen(polygon[c + 1]));
+            }
+        }
+    }
+    stats.occluders++;
+    stats.rasterMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// edge functions over the triangle's bounding rectangle, keeping the nearest depth per pixel centre
+// depth is z / w, which is linear across the screen, so it's interpolated with the same weights as the edges
+void OcclusionBuffer::rasterizeTriangle(const glm::vec3& v0, const glm::vec3& v1In, const glm::vec3& v2In) {
+    glm::vec3 v1 = v1In;
+    glm::vec3 v2 = v2In;
+    float area = (v1.x - v0.x) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.x - v0.x);
+    if (area == 0.0f || std::isnan(area)) {
+        return;
+    }
+    // both windings are rasterized, occluders like the floor are seen from either side
+    if (area < 0.0f) {
+        std::swap(v1, v2);
+        area = -area;
+    }
+    int minX = std::max(0, (int)std::floor(std::min(v0.x, std::min(v1.x, v2.x))));
+    int maxX = std::min((int)width - 1, (int)std::ceil(std::max(v0.x, std::max(v1.x, v2.x))));
+    int minY = std::max(0, (int)std::floor(std::min(v0.y, std::min(v1.y, v2.y))));
+    int maxY = std::min((int)height - 1, (int)std::ceil(std::max(v0.y, std::max(v1.y, v2.y))));
+    if (minX > maxX || minY > maxY) {
+        return;
+    }
+    stats.triangles++;
+
+    // edge i is opposite vertex i, e(x, y) = a * x + b * y + c and is >= 0 inside
+    float a0 = v1.y - v2.y, b0 = v2.x - v1.x, c0 = v1.x * v2.y - v1.y * v2.x;
+    float a1 = v2.y - v0.y, b1 = v0.x - v2.x, c1 = v2.x * v0.y - v2.y * v0.x;
+    float a2 = v0.y - v1.y, b2 = v1.x - v0.x, c2 = v0.x * v1.y - v0.y * v1.x;
+    // depth as a plane over the screen, z = dzdx * x + dzdy * y + z0
+    float inverseArea = 1.0f / area;
+    float dzdx = (a0 * v0.z + a1 * v1.z + a2 * v2.z) * inverseArea;
+    float dzdy = (b0 * v0.z + b1 * v1.z + b2 * v2.z) * inverseArea;
+    float z0 = (c0 * v0.z + c1 * v1.z + c2 * v2.z) * inverseArea;
+
+    std::vector<float>& depth = levels[0];
+    int startX = minX & ~3;
+    for (int y = minY; y <= maxY; y++) {
+        float centerY = y + 0.5f;
+        float* row = &depth[(size_t)y * width];
+#if defined(OCCLUSION_SSE)
+        __m128 stepX = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+        __m128 zero = _mm_setzero_ps();
+        for (int x = startX; x <= maxX; x += 4) {
+            __m128 centerX = _mm_add_ps(_mm_set1_ps((float)x), stepX);
+            __m128 e0 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a0), centerX), _mm_set1_ps(b0 * centerY + c0));
+            __m128 e1 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a1), centerX), _mm_set1_ps(b1 * centerY + c1));
+            __m128 e2 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a2), centerX), _mm_set1_ps(b2 * centerY + c2));
+            __m128 inside = _mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_and_ps(_mm_cmpge_ps(e1, zero), _mm_cmpge_ps(e2, zero)));
+            if (_mm_movemask_ps(inside) == 0) {
+                continue;
+            }
+            __m128 z = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(dzdx), centerX), _mm_set1_ps(dzdy * centerY + z0));
+            __m128 current = _mm_loadu_ps(row + x);
+            __m128 closer = _mm_and_ps(inside, _mm_cmplt_ps(z, current));
+            _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(closer, z), _mm_andnot_ps(closer, current)));
+        }
+#else
+        for (int x = startX; x <= maxX; x++) {
+            float centerX = x + 0.5f;
+            if (a0 * centerX + b0 * centerY + c0 < 0.0f || a1 * centerX + b1 * centerY + c1 < 0.0f || a2 * centerX + b2 * centerY + c2 < 0.0f) {
+                continue;
+            }
+            float z = dzdx * centerX + dzdy * centerY + z0;
+            row[x] = std::min(row[x], z);
+        }
+#endif
+    }
+}
+
+void OcclusionBuffer::BuildHierarchy() {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (size_t level = 1; level < levels.size(); level++) {
+        const std::vector<float>& source = levels[level - 1];
+        unsigned int sourceWidth = levelWidths[level - 1];
+        unsigned int sourceHeight = levelHeights[level - 1];
+        std::vector<float>& target = levels[level];
+        for (unsigned int y = 0; y < levelHeights[level]; y++) {
+            unsigned int y0 = std::min(y * 2, sourceHeight - 1), y1 = std::min(y * 2 + 1, sourceHeight - 1);
+            for (unsigned int x = 0; x < levelWidths[level]; x++) {
+                unsigned int x0 = std::min(x * 2, sourceWidth - 1), x1 = std::min(x * 2 + 1, sourceWidth - 1);
+                target[(size_t)y * levelWidths[level] + x] = std::max(std::max(source[(size_t)y0 * sourceWidth + x0], source[(size_t)y0 * sourceWidth + x1]),
+                    std::max(source[(size_t)y1 * sourceWidth + x0], source[(size_t)y1 * sourceWidth + x1]));
+            }
+        }
+    }
+    stats.rasterMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool OcclusionBuffer::IsVisible(const BoundingBox& box) const {
+    float minX = (float)width, minY = (float)height, maxX = 0.0f, maxY = 0.0f;
+    float nearestDepth = 1.0f;
+    for (int corner = 0; corner < 8; corner++) {
+        glm::vec3 offset((corner & 1) ? 1.0f : -1.0f, (corner & 2) ? 1.0f : -1.0f, (corner & 4) ? 1.0f : -1.0f);
+        glm::vec4 clip = viewProjection * glm::vec4(box.center + box.extents * offset, 1.0f);
+        // a box reaching through the near plane can't be projected, and is right in front of the camera anyway
+        if (clip.w <= NEAR_EPSILON || clip.z < -clip.w) {
+            return true;
+        }
+        float inverseW = 1.0f / clip.w;
+        float x = (clip.x * inverseW * 0.5f + 0.5f) * width;
+        float y = (clip.y * inverseW * 0.5f + 0.5f) * height;
+        minX = std::min(minX, x);
+        maxX = std::max(maxX, x);
+        minY = std::min(minY, y);
+        maxY = std::max(maxY, y);
+        nearestDepth = std::min(nearestDepth, clip.z * inverseW * 0.5f + 0.5f);
+    }
+    // grown by a pixel, see the class comment
+    int x0 = std::max(0, (int)std::floor(minX) - 1);
+    int x1 = std::min((int)width - 1, (int)std::floor(maxX) + 1);
+    int y0 = std::max(0, (int)std::floor(minY) - 1);
+    int y1 = std::min((int)height - 1, (int)std::floor(maxY) + 1);
+    if (x0 > x1 || y0 > y1) {
+        return true; // off the buffer, that's for frustum culling to decide
+    }
+    // the coarsest level where the rectangle still spans at most 4 texels a side
+    size_t level = 0;
+    while (level + 1 < levels.size() && (x1 - x0 >= 4 || y1 - y0 >= 4)) {
+        x0 /= 2;
+        x1 /= 2;
+        y0 /= 2;
+        y1 /= 2;
+        level++;
+    }
+    const std::vector<float>& depth = levels[level];
+    for (int y = y0; y <= y1; y++) {
+        for (int x = x0; x <= x1; x++) {
+            if (nearestDepth <= depth[(size_t)y * levelWidths[level] + x]) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void OcclusionBuffer::FilterVisible(const std::vector<unsigned int>& objects, const std::vector<BoundingBox>& boxes, std::vector<unsigned int>& visible) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    visible.clear();
+    for (unsigned int object : objects) {
+        if (IsVisible(boxes[object])) {
+            visible.push_back(object);
+        }
+    }
+    stats.tested += (unsigned int)objects.size();
+    stats.occluded += (unsigned int)(objects.size() - visible.size());
+    stats.testMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+float OcclusionBuffer::DepthAt(unsigned int x, unsigned int y) const {
+    return levels[0][(size_t)y * width + x];
+}
+
+unsigned int OcclusionBuffer::Width() const {
+    return width;
+}
+
+unsigned int OcclusionBuffer::Height() const {
+    return height;
+}
+
+OcclusionStats OcclusionBuffer::Stats() const {
+    return stats;
+}
@@ -0,0 +1,54 @@
+#ifndef OCCLUSION_BUFFER_H
+#define OCCLUSION_BUFFER_H
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+#include "Culling.h"
+
+// per frame numbers for the profiler output and the benchmark
+struct OcclusionStats {
+    unsigned int occluders;
+    unsigned int triangles; // occluder triangles rasterized, after near plane clipping
+    unsigned int tested;
+    unsigned int occluded;
+    double rasterMs; // clearing, rasterizing and building the hierarchy
+    double testMs;
+};
+
+// small CPU depth buffer for occlusion culling, nothing here touches GL
+// a few big occluders are rasterized with the frame's projection * view (4 pixels at a time with SSE),
+// then a max depth pyramid is built over it and an object is hidden when its nearest box corner is behind every texel its screen rectangle covers
+// occluders are sampled at pixel centres, so the test rectangle is grown by a pixel to not reject objects peeking through a partly covered pixel
+class OcclusionBuffer {
+private:
+    unsigned int width, height; // width is kept a multiple of 4
+    glm::mat4 viewProjection;
+    std::vector<std::vector<float>> levels; // level 0 is the depth buffer, each next level holds the max of 2x2 texels
+    std::vector<unsigned int> levelWidths, levelHeights;
+    std::vector<glm::vec4> clipVertices; // reused between meshes
+    OcclusionStats stats;
+
+    void rasterizeTriangle(const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2); // screen x, y in pixels and depth in [0, 1]
+public:
+    static const unsigned int DEFAULT_WIDTH = 256;
+    static const unsigned int DEFAULT_HEIGHT = 128;
+
+    OcclusionBuffer(unsigned int width = DEFAULT_WIDTH, unsigned int height = DEFAULT_HEIGHT); // constructor
+
+    // methods
+    void Begin(const glm::mat4& viewProjection); // clears to the far plane and starts the frame's stats
+    // rasterizes an indexed triangle mesh (xyz positions) into the depth buffer, triangles are clipped at the near plane
+    void RasterizeOccluder(const std::vector<float>& positions, const std::vector<unsigned int>& indices, const glm::mat4& model);
+    void BuildHierarchy(); // call once every occluder is in, before testing
+    bool IsVisible(const BoundingBox& box) const; // world space box, true when it may be visible
+    // keeps the objects (indices into boxes) that may be visible, counted and timed in the stats
+    void FilterVisible(const std::vector<unsigned int>& objects, const std::vector<BoundingBox>& boxes, std::vector<unsigned int>& visible);
+    float DepthAt(unsigned int x, unsigned int y) const; // level 0, for inspecting the buffer
+    unsigned int Width() const;
+    unsigned int Height() const;
+    OcclusionStats Stats() const;
+};
+
+#endif
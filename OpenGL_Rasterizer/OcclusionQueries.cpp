@@ -0,0 +1,117 @@
+#include "OcclusionQueries.h"
+#include "RenderState.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cmath>
+
+// glad here is generated for 3.3 core, which doesn't have the 4.3 enum
+#ifndef GL_ANY_SAMPLES_PASSED_CONSERVATIVE
+#define GL_ANY_SAMPLES_PASSED_CONSERVATIVE 0x8D6A
+#endif
+
+OcclusionQueries::OcclusionQueries(unsigned int objectCount, const Shader& boxShader, unsigned int boxVertexArray, unsigned int boxIndexCount, GLenum boxIndexType,
+    const BoundingBox& boxMeshBounds, unsigned int visibleInterval)
+    : objects(objectCount, ObjectState{ 0, false, true, -2 }), frame(0), visibleInterval(visibleInterval), boxShader(boxShader),
+    boxVertexArray(boxVertexArray), boxIndexCount(boxIndexCount), boxIndexType(boxIndexType), boxMeshBounds(boxMeshBounds), stats() {
+    int major = 0, minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    target = major > 4 || (major == 4 && minor >= 3) ? GL_ANY_SAMPLES_PASSED_CONSERVATIVE : GL_ANY_SAMPLES_PASSED;
+}
+
+OcclusionQueries::~OcclusionQueries() {
+    for (ObjectState& object : objects) {
+        if (object.query != 0) {
+            glDeleteQueries(1, &object.query);
+        }
+    }
+}
+
+void OcclusionQueries::Filter(const std::vector<unsigned int>& candidates, const std::vector<BoundingBox>& boxes, const glm::vec3& cameraPosition, float nearPlane,
+    std::vector<unsigned int>& visible) {
+    frame++;
+    stats = OcclusionQueryStats();
+    visible.clear();
+    toQuery.clear();
+    for (unsigned int index : candidates) {
+        ObjectState& object = objects[index];
+        if (object.pending) {
+            GLuint available = 0;
+            glGetQueryObjectuiv(object.query, GL_QUERY_RESULT_AVAILABLE, &available);
+            if (available) {
+                GLuint samples = 0;
+                glGetQueryObjectuiv(object.query, GL_QUERY_RESULT, &samples);
+                object.visible = samples != 0;
+                object.pending = false;
+                stats.resultsRead++;
+            }
+            else {
+                stats.waiting++;
+            }
+        }
+        // a result from before the object left the frustum says nothing about now
+        if (object.lastSeen != frame - 1) {
+            object.visible = true;
+        }
+        object.lastSeen = frame;
+
+        // the near plane would cut into a box around the camera and the query could miss, the object is right here anyway
+        const BoundingBox& box = boxes[index];
+        glm::vec3 offset = glm::abs(cameraPosition - box.center);
+        bool cameraInside = offset.x <= box.extents.x + nearPlane && offset.y <= box.extents.y + nearPlane && offset.z <= box.extents.z + nearPlane;
+        if (cameraInside) {
+            object.visible = true;
+        }
+        else if (!object.pending) {
+            // visible objects are spread over the interval so their queries don't all land on the same frame
+            bool dueAgain = (unsigned int)(frame + index) % visibleInterval == 0;
+            if (!object.visible || dueAgain) {
+                toQuery.push_back(index);
+            }
+        }
+
+        if (object.visible) {
+            visible.push_back(index);
+        }
+    }
+    stats.tested = (unsigned int)candidates.size();
+    stats.occluded = (unsigned int)(candidates.size() - visible.size());
+}
+
+void OcclusionQueries::IssueQueries(const std::vector<BoundingBox>& boxes) {
+    if (!toQuery.empty()) {
+        boxShader.Bind();
+        RenderState::BindVertexArray(boxVertexArray);
+        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+        glDepthMask(GL_FALSE);
+        for (unsigned int index : toQuery) {
+            ObjectState& object = objects[index];
+            if (object.query == 0) {
+                glGenQueries(1, &object.query);
+            }
+            // grown a little so a box face lying exactly on one of the object's own faces doesn't lose the depth test to it
+            const BoundingBox& box = boxes[index];
+            glm::vec3 extents = box.extents * 1.02f + glm::vec3(0.01f);
+            glm::mat4 model = glm::translate(glm::mat4(1.0f), box.center);
+            model = glm::scale(model, extents / boxMeshBounds.extents);
+            model = glm::translate(model, -boxMeshBounds.center);
+            boxShader.SetMat4("model"_uniform, model);
+            glBeginQuery(target, object.query);
+            glDrawElements(GL_TRIANGLES, boxIndexCount, boxIndexType, 0);
+            glEndQuery(target);
+            object.pending = true;
+        }
+        glDepthMask(GL_TRUE);
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    }
+    stats.issued = (unsigned int)toQuery.size();
+}
+
+bool OcclusionQueries::Conservative() const {
+    return target == GL_ANY_SAMPLES_PASSED_CONSERVATIVE;
+}
+
+OcclusionQueryStats OcclusionQueries::Stats() const {
+    return stats;
+}
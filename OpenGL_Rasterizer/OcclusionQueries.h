@@ -0,0 +1,65 @@
+#ifndef OCCLUSION_QUERIES_H
+#define OCCLUSION_QUERIES_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+#include "Culling.h"
+#include "Shader.h"
+
+// per frame numbers for the profiler output
+struct OcclusionQueryStats {
+    unsigned int tested; // objects that reached the filter
+    unsigned int occluded; // skipped because their last query found no samples
+    unsigned int issued; // box queries drawn this frame
+    unsigned int resultsRead;
+    unsigned int waiting; // objects whose last query hadn't come back yet, they keep their older result
+};
+
+// GPU occlusion culling with one query per object, in the spirit of CHC++
+// an object's box is drawn with color and depth writes off inside a query once the frame's geometry is in the depth buffer,
+// and whatever result has arrived by the next frame decides whether the object is drawn, results are never waited on
+// hidden objects are queried every frame so they come back one frame after they show up, visible ones only every few frames,
+// and an object that just entered the frustum or has the camera inside its box is simply drawn
+// GL_ANY_SAMPLES_PASSED_CONSERVATIVE needs GL 4.3, a 3.3 context falls back to GL_ANY_SAMPLES_PASSED
+class OcclusionQueries {
+private:
+    struct ObjectState {
+        unsigned int query; // 0 until the object is first queried
+        bool pending; // a result is on its way
+        bool visible; // last known result
+        int lastSeen; // last frame the object was in the frustum
+    };
+
+    std::vector<ObjectState> objects;
+    std::vector<unsigned int> toQuery;
+    GLenum target;
+    int frame;
+    unsigned int visibleInterval;
+    const Shader& boxShader;
+    unsigned int boxVertexArray;
+    unsigned int boxIndexCount;
+    GLenum boxIndexType;
+    BoundingBox boxMeshBounds;
+    OcclusionQueryStats stats;
+public:
+    // the box mesh is any closed mesh with positions at location 0, its bounds get stretched over each object's box
+    OcclusionQueries(unsigned int objectCount, const Shader& boxShader, unsigned int boxVertexArray, unsigned int boxIndexCount, GLenum boxIndexType,
+        const BoundingBox& boxMeshBounds, unsigned int visibleInterval = 8); // constructor, needs a current GL context
+    ~OcclusionQueries(); // destructor
+    OcclusionQueries(const OcclusionQueries&) = delete;
+    OcclusionQueries& operator=(const OcclusionQueries&) = delete;
+
+    // methods
+    // starts the frame: picks up finished queries, keeps the candidates (indices into boxes) that should be drawn
+    // and remembers which ones to query once the frame's depth is in
+    void Filter(const std::vector<unsigned int>& candidates, const std::vector<BoundingBox>& boxes, const glm::vec3& cameraPosition, float nearPlane,
+        std::vector<unsigned int>& visible);
+    void IssueQueries(const std::vector<BoundingBox>& boxes); // draws the query boxes, depth test on and every write off
+    bool Conservative() const; // whether the conservative query target is in use
+    OcclusionQueryStats Stats() const;
+};
+
+#endif
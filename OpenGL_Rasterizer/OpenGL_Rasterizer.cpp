@@ -1,559 +1,1116 @@
-// OpenGL_Rasterizer.cpp : This file contains the 'main' function. Program execution begins and ends there.
-//
-
-#include <iostream>
-#include <fstream>
-#include <string>
-#include <sstream>
-#include <glad/glad.h> // obtains GPU openGL api function pointers for machine being used 
-#include <GLFW/glfw3.h> // defines openGL context, handles IO and basic window operations
-
-#include <glm/glm.hpp>
-#include <glm/gtc/matrix_transform.hpp>
-#include <glm/gtc/type_ptr.hpp>
-#include <glm/gtx/string_cast.hpp>
-
-#include "stb_image.h"
-
-#include "Camera.h"
-
-#include "VertexBuffer.h"
-
-// shader struct for convenient returning for ParseShader below
-struct ShaderProgramSource {
-    std::string VertexSource;
-    std::string FragmentSource;
-};
-
-// Screen settings/instance fields
-const unsigned int SCR_WIDTH = 800;
-const unsigned int SCR_HEIGHT = 600;
-
-Camera camera(glm::vec3(0.0f, 0.0f, 3.0f));
-float lastX = SCR_WIDTH / 2.0f;
-float lastY = SCR_HEIGHT / 2.0f;
-bool firstMouse = true;
-float deltaTime = 0.0f;
-float lastFrame = 0.0f;
-
-// method/function headers
-void framebuffer_size_callback(GLFWwindow* window, int width, int height); // handles resizing
-void mouse_callback(GLFWwindow* window, double xpos, double ypos);
-void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
-void processInput(GLFWwindow* window);
-static ShaderProgramSource ParseShader(const std::string& filepath);
-static unsigned int CreateShader(const std::string& vertexShader, const std::string& fragmentShader);
-static unsigned int CompileShader(unsigned int type, const std::string& source);
-
-// method definitions
-void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
-    glViewport(0, 0, width, height);
-}
-
-void processInput(GLFWwindow* window) {
-    // if the escape key is pressed while the window is open, instruct it to close
-    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
-        glfwSetWindowShouldClose(window, true);
-    }
-    if (glfwGetKey(window, GLFW_KEY_W)) {
-        camera.ProcessKeyboard(FORWARD, deltaTime);
-    }
-    if (glfwGetKey(window, GLFW_KEY_S)) {
-        camera.ProcessKeyboard(BACKWARD, deltaTime);
-    }
-    if (glfwGetKey(window, GLFW_KEY_A)) {
-        camera.ProcessKeyboard(LEFT, deltaTime);
-    }
-    if (glfwGetKey(window, GLFW_KEY_D)) {
-        camera.ProcessKeyboard(RIGHT, deltaTime);
-    }
-}
-
-void mouse_callback(GLFWwindow* window, double xpos, double ypos) {
-    // casting input to float from double
-    float xPos = static_cast<float>(xpos);
-    float yPos = static_cast<float>(ypos);
-
-    // ensure no sudden jump of camera when mouse cursor enters window boundaries
-    if (firstMouse) {
-        lastX = xPos;
-        lastY = yPos;
-        firstMouse = false;
-    }
-
-    // calculating the offsets
-    float xoffset = xPos - lastX;
-    float yoffset = lastY - yPos; // y is reversed, so calculation is too
-    
-    // update lastX and lastY
-    lastX = xPos;
-    lastY = yPos;
-
-    // actually perform the camera calculations using inputs
-    camera.ProcessMouseMovement(xoffset, yoffset);
-}
-
-void scroll_callback(GLFWwindow* window, double xoffset, double yoffset) {
-    camera.ProcessMouseScroll(static_cast<float>(yoffset));
-}
-
-// Shader loading in from file methods below (following 3 methods) implemented from openGL lecture series
-static ShaderProgramSource ParseShader(const std::string& filepath) {
-    std::ifstream stream(filepath); // opens the file
-
-    enum class ShaderType {
-        NONE = -1, VERTEX = 0, FRAGMENT = 1
-    };
-
-    std::string line;
-    std::stringstream ss[2]; // one array for vertex, another for fragment
-    ShaderType type = ShaderType::NONE; // sets the default shadertype to NONE
-
-    while (getline(stream, line)) {
-        // if #shader HAS been found, then set mode, else set the shader elements
-        if (line.find("#shader") != std::string::npos) {
-            // if vertex is found, set to vertex mode, else if fragment found, fragment mode
-            if (line.find("vertex") != std::string::npos) {
-                type = ShaderType::VERTEX;
-            }
-            else if (line.find("fragment") != std::string::npos) {
-                type = ShaderType::FRAGMENT;
-            }
-        }
-        else {
-            // adds the line into the string stream for correct position and adds a new line to cap it off
-            ss[(int)type] << line << '\n'; // cast the shader type to an int in order to index into string stream array for correct shader - clever
-        }
-    }
-
-    return { ss[0].str(), ss[1].str() };
-}
-
-static unsigned int CreateShader(const std::string& vertexShader, const std::string& fragmentShader) {
-    unsigned int program = glCreateProgram();
-    unsigned int vShader = CompileShader(GL_VERTEX_SHADER, vertexShader);
-    unsigned int fShader = CompileShader(GL_FRAGMENT_SHADER, fragmentShader);
-    
-    glAttachShader(program, vShader);
-    glAttachShader(program, fShader);
-    glLinkProgram(program);
-    glValidateProgram(program);
-
-    glDeleteShader(vShader);
-    glDeleteShader(fShader);
-
-    return program;
-}
-
-static unsigned int CompileShader(unsigned int type, const std::string& source) {
-    unsigned int id = glCreateShader(type);
-    const char* src = source.c_str();
-    glShaderSource(id, 1, &src, nullptr);
-    glCompileShader(id);
-
-    // error checking 
-    int result;
-    glGetShaderiv(id, GL_COMPILE_STATUS, &result);
-    if (result == GL_FALSE) {
-        int length;
-        glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length);
-        char* message = (char*)alloca(length * sizeof(char)); // allows us to set up a char array of length size
-        glGetShaderInfoLog(id, length, &length, message);
-        std::cout << "Failed to compile " << (type == GL_VERTEX_SHADER ? "vertex" : "fragment") << " shader" << std::endl;
-        std::cout << message << std::endl;
-        glDeleteShader(id);
-        return 0;
-    }
-
-    return id;
-}
-
-void handleVAO() {
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
-}
-
-void handleLightVAO() {
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-}
-
-void handleTextures(unsigned int& texture1, const std::string& location) {
-    // generate texture IDs
-    glGenTextures(1, &texture1);
-    const char* loc = location.c_str();
-
-    // handling first texture (rug)
-    glBindTexture(GL_TEXTURE_2D, texture1); // binding current texture
-    // setting texture wrapping parameters
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    // setting texture filtering parameters
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    // load the image
-    int imWidth, imHeight, nrChannels;
-    unsigned char* data = stbi_load(loc, &imWidth, &imHeight, &nrChannels, 0);
-    if (data) {
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, imWidth, imHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-    }
-    else {
-        std::cout << "Failed to load texture" << std::endl;
-    }
-    stbi_image_free(data);
-}
-
-int main()
-{
-    glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-
-    // Initialize window through GLFW
-    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Learning OpenGL Project", NULL, NULL);
-    if (window == NULL) {
-        std::cout << "Failed to create GLFW window. " << std::endl; // System.out.println(); equivalent
-        glfwTerminate();
-        return -1;
-    }
-    glfwMakeContextCurrent(window);
-    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
-    glfwSetCursorPosCallback(window, mouse_callback);
-    glfwSetScrollCallback(window, scroll_callback);
-
-    // ensures the mouse cursor doesn't display and applies to window
-    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
-    
-    // Ensure GLAD is initialized
-    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
-        std::cout << "Failed to initialize GLAD" << std::endl;
-        return -1;
-    }
-
-    // enable depth testing
-    glEnable(GL_DEPTH_TEST); 
-
-    // read in shader from file
-    ShaderProgramSource source = ParseShader("res/shaders/BasicShaders.shader");
-    ShaderProgramSource sourceLight = ParseShader("res/shaders/BasicShadersLight.shader");
-    unsigned int shader = CreateShader(source.VertexSource, source.FragmentSource);
-    unsigned int lightShader = CreateShader(sourceLight.VertexSource, sourceLight.FragmentSource);
-
-    float vertices[] = {
-    0.5f, 0.5f, -2.0f,      0.0f, 1.0f, 0.0f,   1.0f, 1.0f,
-    0.5f, -0.5f, -2.0f,     0.0f, 1.0f, 0.0f,   1.0f, 0.0f,
-    -0.5f, 0.5f, -2.0f,     0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
-    0.5f, -0.5f, -2.0f,     0.0f, 1.0f, 0.0f,   1.0f, 0.0f,
-    -0.5f, -0.5f, -2.0f,    0.0f, 1.0f, 0.0f,   0.0f, 0.0f,
-    -0.5f, 0.5f, -2.0f,     0.0f, 1.0f, 0.0f,   0.0f, 1.0f
-    };
-
-    float cubeVertices[] = {
-        -0.5f, -0.5f, -0.5f,    0.0f, 0.0f, -1.0f,    0.0f, 0.0f,
-         0.5f, -0.5f, -0.5f,    0.0f, 0.0f, -1.0f,    1.0f, 0.0f,
-         0.5f,  0.5f, -0.5f,    0.0f, 0.0f, -1.0f,    1.0f, 1.0f,
-         0.5f,  0.5f, -0.5f,    0.0f, 0.0f, -1.0f,    1.0f, 1.0f,
-        -0.5f,  0.5f, -0.5f,    0.0f, 0.0f, -1.0f,    0.0f, 1.0f,
-        -0.5f, -0.5f, -0.5f,    0.0f, 0.0f, -1.0f,    0.0f, 0.0f,
-
-        -0.5f, -0.5f,  0.5f,    0.0f, 0.0f, 1.0f,     0.0f, 0.0f,
-         0.5f, -0.5f,  0.5f,    0.0f, 0.0f, 1.0f,     1.0f, 0.0f,
-         0.5f,  0.5f,  0.5f,    0.0f, 0.0f, 1.0f,     1.0f, 1.0f,
-         0.5f,  0.5f,  0.5f,    0.0f, 0.0f, 1.0f,     1.0f, 1.0f,
-        -0.5f,  0.5f,  0.5f,    0.0f, 0.0f, 1.0f,     0.0f, 1.0f,
-        -0.5f, -0.5f,  0.5f,    0.0f, 0.0f, 1.0f,     0.0f, 0.0f,
-
-        -0.5f,  0.5f,  0.5f,    -1.0f, 0.0f, 0.0f,    1.0f, 0.0f,
-        -0.5f,  0.5f, -0.5f,    -1.0f, 0.0f, 0.0f,    1.0f, 1.0f,
-        -0.5f, -0.5f, -0.5f,    -1.0f, 0.0f, 0.0f,    0.0f, 1.0f,
-        -0.5f, -0.5f, -0.5f,    -1.0f, 0.0f, 0.0f,    0.0f, 1.0f,
-        -0.5f, -0.5f,  0.5f,    -1.0f, 0.0f, 0.0f,    0.0f, 0.0f,
-        -0.5f,  0.5f,  0.5f,    -1.0f, 0.0f, 0.0f,    1.0f, 0.0f,
-
-         0.5f,  0.5f,  0.5f,    1.0f, 0.0f, 0.0f,     1.0f, 0.0f,
-         0.5f,  0.5f, -0.5f,    1.0f, 0.0f, 0.0f,     1.0f, 1.0f,
-         0.5f, -0.5f, -0.5f,    1.0f, 0.0f, 0.0f,     0.0f, 1.0f,
-         0.5f, -0.5f, -0.5f,    1.0f, 0.0f, 0.0f,     0.0f, 1.0f,
-         0.5f, -0.5f,  0.5f,    1.0f, 0.0f, 0.0f,     0.0f, 0.0f,
-         0.5f,  0.5f,  0.5f,    1.0f, 0.0f, 0.0f,     1.0f, 0.0f,
-
-        -0.5f, -0.5f, -0.5f,    0.0f, -1.0f, 0.0f,    0.0f, 1.0f,
-         0.5f, -0.5f, -0.5f,    0.0f, -1.0f, 0.0f,    1.0f, 1.0f,
-         0.5f, -0.5f,  0.5f,    0.0f, -1.0f, 0.0f,    1.0f, 0.0f,
-         0.5f, -0.5f,  0.5f,    0.0f, -1.0f, 0.0f,    1.0f, 0.0f,
-        -0.5f, -0.5f,  0.5f,    0.0f, -1.0f, 0.0f,    0.0f, 0.0f,
-        -0.5f, -0.5f, -0.5f,    0.0f, -1.0f, 0.0f,    0.0f, 1.0f,
-
-        -0.5f,  0.5f, -0.5f,    0.0f, 1.0f, 0.0f,     0.0f, 1.0f,
-         0.5f,  0.5f, -0.5f,    0.0f, 1.0f, 0.0f,     1.0f, 1.0f,
-         0.5f,  0.5f,  0.5f,    0.0f, 1.0f, 0.0f,     1.0f, 0.0f,
-         0.5f,  0.5f,  0.5f,    0.0f, 1.0f, 0.0f,     1.0f, 0.0f,
-        -0.5f,  0.5f,  0.5f,    0.0f, 1.0f, 0.0f,     0.0f, 0.0f,
-        -0.5f,  0.5f, -0.5f,    0.0f, 1.0f, 0.0f,     0.0f, 1.0f
-    };
-
-    float cubeLightVertices[] = {
-        -0.5f, -0.5f, -0.5f,
-         0.5f, -0.5f, -0.5f,
-         0.5f,  0.5f, -0.5f,
-         0.5f,  0.5f, -0.5f,
-        -0.5f,  0.5f, -0.5f,
-        -0.5f, -0.5f, -0.5f,
-
-        -0.5f, -0.5f,  0.5f,
-         0.5f, -0.5f,  0.5f,
-         0.5f,  0.5f,  0.5f,
-         0.5f,  0.5f,  0.5f,
-        -0.5f,  0.5f,  0.5f,
-        -0.5f, -0.5f,  0.5f,
-
-        -0.5f,  0.5f,  0.5f,
-        -0.5f,  0.5f, -0.5f,
-        -0.5f, -0.5f, -0.5f,
-        -0.5f, -0.5f, -0.5f,
-        -0.5f, -0.5f,  0.5f,
-        -0.5f,  0.5f,  0.5f,
-
-         0.5f,  0.5f,  0.5f,
-         0.5f,  0.5f, -0.5f,
-         0.5f, -0.5f, -0.5f,
-         0.5f, -0.5f, -0.5f,
-         0.5f, -0.5f,  0.5f,
-         0.5f,  0.5f,  0.5f,
-
-        -0.5f, -0.5f, -0.5f,
-         0.5f, -0.5f, -0.5f,
-         0.5f, -0.5f,  0.5f,
-         0.5f, -0.5f,  0.5f,
-        -0.5f, -0.5f,  0.5f,
-        -0.5f, -0.5f, -0.5f,
-
-        -0.5f,  0.5f, -0.5f,
-         0.5f,  0.5f, -0.5f,
-         0.5f,  0.5f,  0.5f,
-         0.5f,  0.5f,  0.5f,
-        -0.5f,  0.5f,  0.5f,
-        -0.5f,  0.5f, -0.5f
-    };
-
-    unsigned int VAO0, VAO1, VAO2;
-    glGenVertexArrays(1, &VAO0);
-    glBindVertexArray(VAO0);
-    VertexBuffer vbo0(vertices, sizeof(vertices));
-    handleVAO();
-    glGenVertexArrays(1, &VAO1);
-    glBindVertexArray(VAO1);
-    VertexBuffer vbo1(cubeVertices, sizeof(cubeVertices));
-    handleVAO();
-    glGenVertexArrays(1, &VAO2);
-    glBindVertexArray(VAO2);
-    VertexBuffer vbo2(cubeLightVertices, sizeof(cubeLightVertices));
-    handleLightVAO();
-
-    glBindVertexArray(VAO0);
-
-    // handling textures
-    unsigned int texture1, texture1Specular, texture2, texture2Specular;
-    const std::string texture1Location = "res/textures/carpet_texture.png";
-    const std::string texture1SpecularLocation = "res/textures/carpet_texture_specular.png";
-    const std::string texture2Location = "res/textures/blanket_texture.png";
-    const std::string texture2SpecularLocation = "res/textures/blanket_texture_specular.png";
-    handleTextures(texture1, texture1Location);
-    handleTextures(texture1Specular, texture1SpecularLocation);
-    handleTextures(texture2, texture2Location);
-    handleTextures(texture2Specular, texture2SpecularLocation);
-
-    // creating the model matrix (transform to global world space), the view matrix (transform to camera view), and the projection matrix (transform to screen)
-    glm::mat4 model = glm::mat4(1.0f);
-    //glm::mat4 view = glm::mat4(1.0f);
-    glm::mat4 view = camera.GetViewMatrix();
-    glm::mat4 projection = glm::mat4(1.0f);
-    // rotating to make a floor
-    model = glm::rotate(model, glm::radians(-60.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-    model = glm::translate(model, glm::vec3(0.0, 3.0f, -1.7f));
-    model = glm::scale(model, glm::vec3(18.0f, 18.0f, 1.0f));
-    projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
-
-    // getting matrix uniform locations
-    // vertex shader uniform locations
-    unsigned int modelLoc = glGetUniformLocation(shader, "model");
-    unsigned int viewLoc = glGetUniformLocation(shader, "view");
-    unsigned int projectionLoc = glGetUniformLocation(shader, "projection");
-    unsigned int lightColorLoc = glGetUniformLocation(shader, "lightColor");
-    // fragment shader uniform locations - directional light
-    unsigned int dirLightDirectionLoc = glGetUniformLocation(shader, "directionalLight.direction");
-    unsigned int dirLightAmbientLoc = glGetUniformLocation(shader, "directionalLight.ambient");
-    unsigned int dirLightDiffuseLoc = glGetUniformLocation(shader, "directionalLight.diffuse");
-    unsigned int dirLightSpecularLoc = glGetUniformLocation(shader, "directionalLight.specular");
-    // fragment shader uniform locations - point light
-    unsigned int pointLightPositionLoc0 = glGetUniformLocation(shader, "pointLight[0].position");
-    unsigned int pointLightAmbientLoc0 = glGetUniformLocation(shader, "pointLight[0].ambient");
-    unsigned int pointLightDiffuseLoc0 = glGetUniformLocation(shader, "pointLight[0].diffuse");
-    unsigned int pointLightSpecularLoc0 = glGetUniformLocation(shader, "pointLight[0].specular");
-    unsigned int pointLightConstantLoc0 = glGetUniformLocation(shader, "pointLight[0].constant");
-    unsigned int pointLightLinearLoc0 = glGetUniformLocation(shader, "pointLight[0].linear");
-    unsigned int pointLightQuadraticLoc0 = glGetUniformLocation(shader, "pointLight[0].quadratic");
-    unsigned int pointLightPositionLoc1 = glGetUniformLocation(shader, "pointLight[1].position");
-    unsigned int pointLightAmbientLoc1 = glGetUniformLocation(shader, "pointLight[1].ambient");
-    unsigned int pointLightDiffuseLoc1 = glGetUniformLocation(shader, "pointLight[1].diffuse");
-    unsigned int pointLightSpecularLoc1 = glGetUniformLocation(shader, "pointLight[1].specular");
-    unsigned int pointLightConstantLoc1 = glGetUniformLocation(shader, "pointLight[1].constant");
-    unsigned int pointLightLinearLoc1 = glGetUniformLocation(shader, "pointLight[1].linear");
-    unsigned int pointLightQuadraticLoc1 = glGetUniformLocation(shader, "pointLight[1].quadratic");
-    // fragment shader uniform locations - spot light
-    unsigned int spotLightPositionLoc = glGetUniformLocation(shader, "spotLight.position");
-    unsigned int spotLightDirectionLoc = glGetUniformLocation(shader, "spotLight.direction");
-    unsigned int spotLightCutoffLoc = glGetUniformLocation(shader, "spotLight.cutoff");
-    unsigned int spotLightOuterCutoffLoc = glGetUniformLocation(shader, "spotLight.outerCutoff");
-    unsigned int spotLightAmbientLoc = glGetUniformLocation(shader, "spotLight.ambient");
-    unsigned int spotLightDiffuseLoc = glGetUniformLocation(shader, "spotLight.diffuse");
-    unsigned int spotLightSpecularLoc = glGetUniformLocation(shader, "spotLight.specular");
-
-    unsigned int viewPositionLoc = glGetUniformLocation(shader, "viewPosition");
-
-    unsigned int modelLocLight = glGetUniformLocation(lightShader, "model");
-    unsigned int viewLocLight = glGetUniformLocation(lightShader, "view");
-    unsigned int projectionLocLight = glGetUniformLocation(lightShader, "projection");
-
-    glm::vec3 cubePointLightPos[] = {
-        glm::vec3(-2.0f, 3.3f, -2.3f), 
-        glm::vec3(1.7f, 2.7f, 2.5f)
-    };
-
-    // keep the window open in the render loop until instructed to close
-    // glfwWindowShouldClose checks whether the window should close each loop iteration
-    while (!glfwWindowShouldClose(window)) {
-        // time calculations
-        float timeOfCurrentFrame = static_cast<float>(glfwGetTime());
-        deltaTime = timeOfCurrentFrame - lastFrame;
-        lastFrame = timeOfCurrentFrame;
-
-        processInput(window); // handles input - currently checking for closing via escape key
-
-        // rendering commands should appear below here, above glfwSwapBuffers(window)
-        glClearColor(0.2f, 0.3f, 0.3f, 1.0f); // test that rendering commands are working - clears color buffer with color specified in this function
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); // the actual clear instruction, specified to the color buffer bit
-
-        // drawing the triangle
-        glUseProgram(shader);
-
-        // passing uniforms to the shaders
-        glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-        glUniformMatrix4fv(viewLoc, 1, GL_FALSE, &view[0][0]);
-        glUniformMatrix4fv(projectionLoc, 1, GL_FALSE, glm::value_ptr(projection));
-        glUniform3f(lightColorLoc, 1.0f, 1.0f, 1.0f);
-        glUniform3f(viewPositionLoc, camera.Position[0], camera.Position[1], camera.Position[2]);
-        // setting directional light uniforms
-        glUniform3f(dirLightDirectionLoc, -0.1f, -1.0f, 0.4f);
-        glUniform3f(dirLightAmbientLoc, 0.05f, 0.05f, 0.05f);
-        glUniform3f(dirLightDiffuseLoc, 0.125f, 0.125f, 0.125f);
-        glUniform3f(dirLightSpecularLoc, 0.25f, 0.25f, 0.25f);
-        // setting point light uniforms
-        glUniform3f(pointLightPositionLoc0, cubePointLightPos[0][0], cubePointLightPos[0][1], cubePointLightPos[0][2]);
-        glUniform3f(pointLightAmbientLoc0, 0.2f, 0.2f, 0.2f);
-        glUniform3f(pointLightDiffuseLoc0, 0.5f, 0.5f, 0.5f);
-        glUniform3f(pointLightSpecularLoc0, 1.0f, 1.0f, 1.0f);
-        glUniform1f(pointLightConstantLoc0, 1.0f);
-        glUniform1f(pointLightLinearLoc0, 0.045f);
-        glUniform1f(pointLightQuadraticLoc0, 0.0075f);
-        glUniform3f(pointLightPositionLoc1, cubePointLightPos[1][0], cubePointLightPos[1][1], cubePointLightPos[1][2]);
-        glUniform3f(pointLightAmbientLoc1, 0.4f, 0.4f, 0.7f);
-        glUniform3f(pointLightDiffuseLoc1, 0.4f, 0.4f, 0.7f);
-        glUniform3f(pointLightSpecularLoc1, 0.4f, 0.4f, 0.7f);
-        glUniform1f(pointLightConstantLoc1, 1.0f);
-        glUniform1f(pointLightLinearLoc1, 0.045f);
-        glUniform1f(pointLightQuadraticLoc1, 0.0075f);
-        // setting spot light uniforms
-        glUniform3f(spotLightPositionLoc, 0.4f, 3.0f, -6.4f);
-        glUniform3f(spotLightDirectionLoc, -0.1f, -1.0f, 0.4f);
-        glUniform1f(spotLightCutoffLoc, glm::cos(glm::radians(13.5f)));
-        glUniform1f(spotLightOuterCutoffLoc, glm::cos(glm::radians(18.7f)));
-        glUniform3f(spotLightAmbientLoc, 0.2f, 0.2f, 0.2f);
-        glUniform3f(spotLightDiffuseLoc, 0.5f, 0.5f, 0.5f);
-        glUniform3f(spotLightSpecularLoc, 1.0f, 1.0f, 1.0f);
-        
-        glUniform1i(glGetUniformLocation(shader, "material.diffuse"), 0);
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, texture1);
-        glUniform1i(glGetUniformLocation(shader, "material.specular"), 1);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, texture1Specular);
-
-        projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
-        view = camera.GetViewMatrix();
-
-        glDrawArrays(GL_TRIANGLES, 0, 6); // for plane
-
-        // glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0); // what we're drawing, how many verts, data type, specified offset
-        glBindVertexArray(VAO1);
-        glUniform1i(glGetUniformLocation(shader, "material.diffuse"), 0);
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, texture2);
-        glUniform1i(glGetUniformLocation(shader, "material.specular"), 1);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, texture2Specular);
-        model = glm::mat4(1.0f);
-        model = glm::rotate(model, glm::radians(-55.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-        glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-        glDrawArrays(GL_TRIANGLES, 0, 36);
-
-        glUseProgram(lightShader);
-        glBindVertexArray(VAO2);
-        // cube point light 1
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, cubePointLightPos[0]);
-        model = glm::scale(model, glm::vec3(0.2f, 0.2f, 0.2f));
-        model = glm::rotate(model, glm::radians(-60.0f), glm::vec3(1.0f, -0.3f, 0.0f));
-        glUniformMatrix4fv(modelLocLight, 1, GL_FALSE, glm::value_ptr(model));
-        glUniformMatrix4fv(viewLocLight, 1, GL_FALSE, &view[0][0]);
-        glUniformMatrix4fv(projectionLocLight, 1, GL_FALSE, glm::value_ptr(projection));
-        glDrawArrays(GL_TRIANGLES, 0, 36);
-        // cube point light 2
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, cubePointLightPos[1]);
-        model = glm::scale(model, glm::vec3(0.2f, 0.2f, 0.2f));
-        model = glm::rotate(model, glm::radians(-60.0f), glm::vec3(1.0f, -0.3f, 0.0f));
-        glUniformMatrix4fv(modelLocLight, 1, GL_FALSE, glm::value_ptr(model));
-        glUniformMatrix4fv(viewLocLight, 1, GL_FALSE, &view[0][0]);
-        glUniformMatrix4fv(projectionLocLight, 1, GL_FALSE, glm::value_ptr(projection));
-        glDrawArrays(GL_TRIANGLES, 0, 36);
-        // cube spot light
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(0.4f, 3.0f, -6.4f));
-        model = glm::scale(model, glm::vec3(0.2f, 0.2f, 0.2f));
-        model = glm::rotate(model, glm::radians(-60.0f), glm::vec3(1.0f, -0.3f, 0.0f));
-        glUniformMatrix4fv(modelLocLight, 1, GL_FALSE, glm::value_ptr(model));
-        glUniformMatrix4fv(viewLocLight, 1, GL_FALSE, &view[0][0]);
-        glUniformMatrix4fv(projectionLocLight, 1, GL_FALSE, glm::value_ptr(projection));
-        glDrawArrays(GL_TRIANGLES, 0, 36);
-
-        glBindVertexArray(VAO0);
-        model = glm::mat4(1.0f);
-        model = glm::rotate(model, glm::radians(-60.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-        model = glm::translate(model, glm::vec3(0.0, 1.0f, -0.7f));
-        model = glm::scale(model, glm::vec3(18.0f, 18.0f, 1.0f));
-
-        // a single buffer image draws the image pixel by pixel, which can cause flickering. double buffered images handle this with back and front buffers
-        // the back buffer goes pixel by pixel, while the front buffer is what is shown on screen in the window. the back is swapped to front when ready
-        glfwSwapBuffers(window); // handles the buffer containing the window's pixel color values and swaps it ouch each frame for the new one
-        glfwPollEvents(); // checks for keyboard/mouse inputs
-    }
-
-    // cleanly de allocating no longer needed buffers and vertex arrays
-    glDeleteVertexArrays(1, &VAO0);
-    //glDeleteBuffers(1, &VBO0);
-    glDeleteVertexArrays(1, &VAO1);
-    //glDeleteBuffers(1, &VBO1);
-    glDeleteVertexArrays(1, &VAO2);
-    //glDeleteBuffers(1, &VBO2);
-    // glDeleteBuffers(1, &EBO);
-
-    glfwTerminate();// properly de-allocate allocated resources in GLFW, called when render loop is over
-    return 0;
-}
+// OpenGL_Rasterizer.cpp : This file contains the 'main' function. Program execution begins and ends there.
+//
+
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <thread>
+#include <glad/glad.h> // obtains GPU openGL api function pointers for machine being used 
+#include <GLFW/glfw3.h> // defines openGL context, handles IO and basic window operations
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <glm/gtx/string_cast.hpp>
+
+#include "Camera.h"
+#include "CameraPath.h"
+#include "Benchmark.h"
+#include "GpuProfiler.h"
+
+#include "RenderState.h"
+#include "Shader.h"
+#include "UniformBlocks.h"
+#include "UniformBuffer.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "MeshBuilder.h"
+#include "MeshOptimizer.h"
+#include "InstanceBuffer.h"
+#include "RenderQueue.h"
+#include "ClusteredLights.h"
+#include "Culling.h"
+#include "Bvh.h"
+#include "OcclusionBuffer.h"
+#include "OcclusionQueries.h"
+#include "SoftwareRenderer.h"
+#include "JobSystem.h"
+#include "Framebuffer.h"
+#include "GBuffer.h"
+#include "HeadlessContext.h"
+#include "TextureStreamer.h"
+#include "RenderSettings.h"
+
+// Screen settings/instance fields
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+const float NEAR_PLANE = 0.1f;
+const float FAR_PLANE = 100.0f;
+// texture units of the clustered light buffers, 0 and 1 are the material
+const unsigned int CLUSTER_LIGHT_UNIT = 2;
+const unsigned int CLUSTER_GRID_UNIT = 3;
+const unsigned int CLUSTER_INDEX_UNIT = 4;
+// first of the four G-buffer texture units the deferred lighting pass reads
+const unsigned int GBUFFER_FIRST_UNIT = 5;
+// render queue passes, executed in this order
+const unsigned int DEPTH_PREPASS = 0;
+const unsigned int SCENE_PASS = 1; // forward shading or the G-buffer pass
+const unsigned int LIGHT_CUBE_PASS = 2;
+// occluders rasterized per frame for --occlusion-cull, the biggest on screen win
+const unsigned int MAX_OCCLUDERS = 32;
+
+// CPU copy of a mesh the occlusion buffer can rasterize
+struct OccluderMesh {
+    const std::vector<float>* positions;
+    const std::vector<unsigned int>* indices;
+};
+
+// one drawn instance: the render queue batches it goes into and its packed matrices
+struct SceneObject {
+    const char* name; // for picking
+    const std::vector<unsigned int>* batches;
+    const InstanceData* instance;
+    const OccluderMesh* occluder; // nullptr for objects too small to hide anything
+};
+
+// one mesh and every instance of it, what the software renderer draws each frame
+struct SoftwareDraw {
+    const MeshData* mesh;
+    SoftwareMaterial material;
+    std::vector<InstanceData> instances;
+};
+
+Camera camera(glm::vec3(0.0f, 0.0f, 3.0f));
+float lastX = SCR_WIDTH / 2.0f;
+float lastY = SCR_HEIGHT / 2.0f;
+bool firstMouse = true;
+float deltaTime = 0.0f;
+float lastFrame = 0.0f;
+
+// method/function headers
+void framebuffer_size_callback(GLFWwindow* window, int width, int height); // handles resizing
+void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+void processInput(GLFWwindow* window);
+static float currentTime();
+
+// method definitions
+// seconds since the first call, used instead of glfwGetTime so headless runs don't need GLFW initialized
+static float currentTime() {
+    static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    return std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+}
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
+    glViewport(0, 0, width, height);
+}
+
+void processInput(GLFWwindow* window) {
+    // if the escape key is pressed while the window is open, instruct it to close
+    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
+        glfwSetWindowShouldClose(window, true);
+    }
+    if (glfwGetKey(window, GLFW_KEY_W)) {
+        camera.ProcessKeyboard(FORWARD, deltaTime);
+    }
+    if (glfwGetKey(window, GLFW_KEY_S)) {
+        camera.ProcessKeyboard(BACKWARD, deltaTime);
+    }
+    if (glfwGetKey(window, GLFW_KEY_A)) {
+        camera.ProcessKeyboard(LEFT, deltaTime);
+    }
+    if (glfwGetKey(window, GLFW_KEY_D)) {
+        camera.ProcessKeyboard(RIGHT, deltaTime);
+    }
+}
+
+void mouse_callback(GLFWwindow* window, double xpos, double ypos) {
+    // casting input to float from double
+    float xPos = static_cast<float>(xpos);
+    float yPos = static_cast<float>(ypos);
+
+    // ensure no sudden jump of camera when mouse cursor enters window boundaries
+    if (firstMouse) {
+        lastX = xPos;
+        lastY = yPos;
+        firstMouse = false;
+    }
+
+    // calculating the offsets
+    float xoffset = xPos - lastX;
+    float yoffset = lastY - yPos; // y is reversed, so calculation is too
+    
+    // update lastX and lastY
+    lastX = xPos;
+    lastY = yPos;
+
+    // actually perform the camera calculations using inputs
+    camera.ProcessMouseMovement(xoffset, yoffset);
+}
+
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset) {
+    camera.ProcessMouseScroll(static_cast<float>(yoffset));
+}
+
+void handleVAO() {
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+}
+
+void handleLightVAO() {
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+}
+
+// lays extra copies of the textured cube out in a grid behind the scene, used to stress instanced drawing
+std::vector<glm::mat4> buildCubeGrid(unsigned int count) {
+    std::vector<glm::mat4> transforms;
+    unsigned int side = (unsigned int)std::ceil(std::sqrt((float)count));
+    for (unsigned int i = 0; i < count; i++) {
+        float x = ((float)(i % side) - side / 2.0f) * 2.0f;
+        float z = -4.0f - (float)(i / side) * 2.0f;
+        glm::mat4 model = glm::mat4(1.0f);
+        model = glm::translate(model, glm::vec3(x, 1.5f, z));
+        model = glm::rotate(model, glm::radians(37.0f * i), glm::vec3(0.3f, 1.0f, 0.2f)); // varied so the copies don't all look the same
+        transforms.push_back(model);
+    }
+    return transforms;
+}
+
+// scatters coloured point lights over the cube grid area, seeded so every run gets the same lights
+std::vector<ClusterLight> buildLightField(unsigned int count) {
+    std::vector<ClusterLight> field;
+    std::mt19937 random(592);
+    std::uniform_real_distribution<float> x(-20.0f, 20.0f), y(1.0f, 4.0f), z(-40.0f, 2.0f), channel(0.2f, 1.0f);
+    for (unsigned int i = 0; i < count; i++) {
+        ClusterLight light = ClusterLight();
+        light.position = glm::vec3(x(random), y(random), z(random));
+        light.diffuse = glm::vec3(channel(random), channel(random), channel(random));
+        light.specular = light.diffuse;
+        light.constant = 1.0f; // about a 5 unit radius
+        light.linear = 0.7f;
+        light.quadratic = 1.8f;
+        field.push_back(light);
+    }
+    return field;
+}
+
+// one frame of the scene through the software renderer from the current camera
+void renderSoftwareFrame(SoftwareRenderer& renderer, const RenderSettings& settings, const std::vector<SoftwareDraw>& draws) {
+    glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)settings.width / (float)settings.height, NEAR_PLANE, FAR_PLANE);
+    renderer.BeginFrame(camera.GetViewMatrix(), projection, camera.Position);
+    renderer.Target().Clear(glm::vec3(0.2f, 0.3f, 0.3f)); // same clear color as the GL path
+    for (const SoftwareDraw& draw : draws) {
+        renderer.Draw(*draw.mesh, draw.material, draw.instances.data(), (unsigned int)draw.instances.size());
+    }
+    renderer.EndFrame();
+}
+
+// --software with --benchmark: the camera path is replayed once per thread count, doubling from 1 up to --threads (64 by default),
+// and the speedup of each run over the single threaded one goes into the report
+int benchmarkSoftware(const RenderSettings& settings, const std::vector<SoftwareDraw>& draws, const LightBlock& lights, const std::vector<ClusterLight>& pointLights, RasterIsa isa) {
+    CameraPath cameraPath;
+    if (!cameraPath.Load(settings.benchmarkPath)) {
+        std::cout << "Failed to load camera path " << settings.benchmarkPath << std::endl;
+        return -1;
+    }
+    unsigned int maxThreads = settings.threads != 0 ? std::min(settings.threads, SoftwareRenderer::MAX_THREADS) : SoftwareRenderer::MAX_THREADS;
+    std::vector<ThreadScalingRun> runs;
+    std::vector<unsigned char> reference; // last frame of the single threaded run
+    Camera startCamera = camera; // the path moves the camera relative to where it is, so every run starts from the same pose
+    for (unsigned int threads = 1; ; threads = std::min(threads * 2, maxThreads)) {
+        JobSystem jobs(threads);
+        SoftwareRenderer renderer(settings.width, settings.height, jobs, isa);
+        renderer.SetLights(lights, pointLights);
+        ThreadScalingRun run = { threads, 0.0, {}, {}, {}, 0, true };
+        camera = startCamera;
+        std::chrono::steady_clock::time_point runStart = std::chrono::steady_clock::now();
+        for (unsigned int frame = 0; frame < settings.frames; frame++) {
+            std::chrono::steady_clock::time_point frameStart = std::chrono::steady_clock::now();
+            float pathTime = settings.frames > 1 ? cameraPath.Duration() * frame / (settings.frames - 1) : 0.0f;
+            cameraPath.Apply(camera, pathTime);
+            renderSoftwareFrame(renderer, settings, draws);
+            SoftwareRenderStats stats = renderer.Stats();
+            run.frameMs.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count());
+            run.geometryMs.push_back(stats.geometryMs);
+            run.tilesMs.push_back(stats.tilesMs);
+            run.steals += stats.steals;
+        }
+        run.totalSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - runStart).count();
+
+        std::vector<unsigned char> image;
+        for (unsigned int y = 0; y < settings.height; y++) {
+            const unsigned char* row = renderer.Target().ColorRow(y);
+            image.insert(image.end(), row, row + settings.width * 3);
+        }
+        if (threads == 1) {
+            reference = image;
+        }
+        run.matchesSingleThread = image == reference;
+        runs.push_back(run);
+        std::cout << "Software threads: " << threads << "  " << settings.frames / run.totalSeconds << " fps  speedup: " << runs.front().totalSeconds / run.totalSeconds
+            << "  steals: " << run.steals << (run.matchesSingleThread ? "" : "  (image differs from the single threaded run)") << std::endl;
+        if (threads == maxThreads) {
+            if (!settings.outputPath.empty() && !renderer.Target().WritePPM(settings.outputPath)) {
+                std::cout << "Failed to write " << settings.outputPath << std::endl;
+                return -1;
+            }
+            break;
+        }
+    }
+    std::vector<std::pair<std::string, std::string>> reportSettings;
+    reportSettings.push_back(std::make_pair("render_path", "software"));
+    reportSettings.push_back(std::make_pair("raster_isa", RasterIsaName(isa)));
+    reportSettings.push_back(std::make_pair("cubes", std::to_string(settings.cubes)));
+    reportSettings.push_back(std::make_pair("lights", std::to_string(settings.lights)));
+    if (!WriteThreadScalingReport(settings.reportPath, settings.benchmarkPath, settings.width, settings.height, reportSettings, runs)) {
+        std::cout << "Failed to write " << settings.reportPath << std::endl;
+        return -1;
+    }
+    std::cout << "Benchmark results written to " << settings.reportPath << std::endl;
+    return 0;
+}
+
+// renders the frames on the CPU for --software, there is no GL context and no window
+int renderSoftware(const RenderSettings& settings, JobSystem& jobs, const std::vector<SoftwareDraw>& draws, const LightBlock& lights, const std::vector<ClusterLight>& pointLights) {
+    RasterIsa isa = BestRasterIsa();
+    if (!settings.rasterIsa.empty() && (!ParseRasterIsa(settings.rasterIsa, isa) || !RasterIsaSupported(isa))) {
+        std::cout << "Failed to select raster kernels " << settings.rasterIsa << ", this CPU supports up to " << RasterIsaName(BestRasterIsa()) << std::endl;
+        return -1;
+    }
+    if (!settings.benchmarkPath.empty()) {
+        return benchmarkSoftware(settings, draws, lights, pointLights, isa);
+    }
+    SoftwareRenderer renderer(settings.width, settings.height, jobs, isa);
+    renderer.SetLights(lights, pointLights);
+    float renderStart = currentTime();
+    float lastProfileReport = 0.0f;
+    for (unsigned int frame = 0; frame < settings.frames; frame++) {
+        renderSoftwareFrame(renderer, settings, draws);
+
+        float now = currentTime();
+        if (settings.profileGpu && now - lastProfileReport >= 1.0f) {
+            SoftwareRenderStats stats = renderer.Stats();
+            std::cout << "Software raster (" << RasterIsaName(stats.isa) << ", " << stats.threads << " threads)  triangles: " << stats.triangles << "  clipped: " << stats.clipped << "  set up: " << stats.setup
+                << "  dropped: " << stats.dropped << "  binned: " << stats.binned << "  pixels shaded: " << stats.pixelsShaded << "  geometry: " << stats.geometryMs
+                << " ms  tiles: " << stats.tilesMs << " ms (raster: " << stats.rasterMs << " ms  shade: " << stats.shadeMs << " ms over all threads)  steals: " << stats.steals << std::endl;
+            lastProfileReport = now;
+        }
+    }
+    float renderSeconds = currentTime() - renderStart;
+    std::cout << "Rendered " << settings.frames << " frames at " << settings.width << "x" << settings.height
+        << " in " << renderSeconds << " s (" << settings.frames / renderSeconds << " fps) on the CPU" << std::endl;
+    if (!settings.outputPath.empty() && !renderer.Target().WritePPM(settings.outputPath)) {
+        std::cout << "Failed to write " << settings.outputPath << std::endl;
+        return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    RenderSettings settings;
+    settings.width = SCR_WIDTH;
+    settings.height = SCR_HEIGHT;
+    if (!ParseRenderSettings(argc, argv, settings)) {
+        PrintUsage(argv[0]);
+        return -1;
+    }
+    // one pool of workers for the whole run, the software renderer keeps per worker bins so it is capped at its limit
+    unsigned int threads = settings.threads != 0 ? settings.threads : std::thread::hardware_concurrency();
+    JobSystem jobs(std::min(std::max(threads, 1u), SoftwareRenderer::MAX_THREADS));
+
+    // the scene itself is plain CPU data, built before any context so the software renderer can draw it without one
+    float vertices[] = {
+    0.5f, 0.5f, -2.0f,      0.0f, 1.0f, 0.0f,   1.0f, 1.0f,
+    0.5f, -0.5f, -2.0f,     0.0f, 1.0f, 0.0f,   1.0f, 0.0f,
+    -0.5f, 0.5f, -2.0f,     0.0f, 1.0f, 0.0f,   0.0f, 1.0f,
+    0.5f, -0.5f, -2.0f,     0.0f, 1.0f, 0.0f,   1.0f, 0.0f,
+    -0.5f, -0.5f, -2.0f,    0.0f, 1.0f, 0.0f,   0.0f, 0.0f,
+    -0.5f, 0.5f, -2.0f,     0.0f, 1.0f, 0.0f,   0.0f, 1.0f
+    };
+
+    float cubeVertices[] = {
+        -0.5f, -0.5f, -0.5f,    0.0f, 0.0f, -1.0f,    0.0f, 0.0f,
+         0.5f, -0.5f, -0.5f,    0.0f, 0.0f, -1.0f,    1.0f, 0.0f,
+         0.5f,  0.5f, -0.5f,    0.0f, 0.0f, -1.0f,    1.0f, 1.0f,
+         0.5f,  0.5f, -0.5f,    0.0f, 0.0f, -1.0f,    1.0f, 1.0f,
+        -0.5f,  0.5f, -0.5f,    0.0f, 0.0f, -1.0f,    0.0f, 1.0f,
+        -0.5f, -0.5f, -0.5f,    0.0f, 0.0f, -1.0f,    0.0f, 0.0f,
+
+        -0.5f, -0.5f,  0.5f,    0.0f, 0.0f, 1.0f,     0.0f, 0.0f,
+         0.5f, -0.5f,  0.5f,    0.0f, 0.0f, 1.0f,     1.0f, 0.0f,
+         0.5f,  0.5f,  0.5f,    0.0f, 0.0f, 1.0f,     1.0f, 1.0f,
+         0.5f,  0.5f,  0.5f,    0.0f, 0.0f, 1.0f,     1.0f, 1.0f,
+        -0.5f,  0.5f,  0.5f,    0.0f, 0.0f, 1.0f,     0.0f, 1.0f,
+        -0.5f, -0.5f,  0.5f,    0.0f, 0.0f, 1.0f,     0.0f, 0.0f,
+
+        -0.5f,  0.5f,  0.5f,    -1.0f, 0.0f, 0.0f,    1.0f, 0.0f,
+        -0.5f,  0.5f, -0.5f,    -1.0f, 0.0f, 0.0f,    1.0f, 1.0f,
+        -0.5f, -0.5f, -0.5f,    -1.0f, 0.0f, 0.0f,    0.0f, 1.0f,
+        -0.5f, -0.5f, -0.5f,    -1.0f, 0.0f, 0.0f,    0.0f, 1.0f,
+        -0.5f, -0.5f,  0.5f,    -1.0f, 0.0f, 0.0f,    0.0f, 0.0f,
+        -0.5f,  0.5f,  0.5f,    -1.0f, 0.0f, 0.0f,    1.0f, 0.0f,
+
+         0.5f,  0.5f,  0.5f,    1.0f, 0.0f, 0.0f,     1.0f, 0.0f,
+         0.5f,  0.5f, -0.5f,    1.0f, 0.0f, 0.0f,     1.0f, 1.0f,
+         0.5f, -0.5f, -0.5f,    1.0f, 0.0f, 0.0f,     0.0f, 1.0f,
+         0.5f, -0.5f, -0.5f,    1.0f, 0.0f, 0.0f,     0.0f, 1.0f,
+         0.5f, -0.5f,  0.5f,    1.0f, 0.0f, 0.0f,     0.0f, 0.0f,
+         0.5f,  0.5f,  0.5f,    1.0f, 0.0f, 0.0f,     1.0f, 0.0f,
+
+        -0.5f, -0.5f, -0.5f,    0.0f, -1.0f, 0.0f,    0.0f, 1.0f,
+         0.5f, -0.5f, -0.5f,    0.0f, -1.0f, 0.0f,    1.0f, 1.0f,
+         0.5f, -0.5f,  0.5f,    0.0f, -1.0f, 0.0f,    1.0f, 0.0f,
+         0.5f, -0.5f,  0.5f,    0.0f, -1.0f, 0.0f,    1.0f, 0.0f,
+        -0.5f, -0.5f,  0.5f,    0.0f, -1.0f, 0.0f,    0.0f, 0.0f,
+        -0.5f, -0.5f, -0.5f,    0.0f, -1.0f, 0.0f,    0.0f, 1.0f,
+
+        -0.5f,  0.5f, -0.5f,    0.0f, 1.0f, 0.0f,     0.0f, 1.0f,
+         0.5f,  0.5f, -0.5f,    0.0f, 1.0f, 0.0f,     1.0f, 1.0f,
+         0.5f,  0.5f,  0.5f,    0.0f, 1.0f, 0.0f,     1.0f, 0.0f,
+         0.5f,  0.5f,  0.5f,    0.0f, 1.0f, 0.0f,     1.0f, 0.0f,
+        -0.5f,  0.5f,  0.5f,    0.0f, 1.0f, 0.0f,     0.0f, 0.0f,
+        -0.5f,  0.5f, -0.5f,    0.0f, 1.0f, 0.0f,     0.0f, 1.0f
+    };
+
+    float cubeLightVertices[] = {
+        -0.5f, -0.5f, -0.5f,
+         0.5f, -0.5f, -0.5f,
+         0.5f,  0.5f, -0.5f,
+         0.5f,  0.5f, -0.5f,
+        -0.5f,  0.5f, -0.5f,
+        -0.5f, -0.5f, -0.5f,
+
+        -0.5f, -0.5f,  0.5f,
+         0.5f, -0.5f,  0.5f,
+         0.5f,  0.5f,  0.5f,
+         0.5f,  0.5f,  0.5f,
+        -0.5f,  0.5f,  0.5f,
+        -0.5f, -0.5f,  0.5f,
+
+        -0.5f,  0.5f,  0.5f,
+        -0.5f,  0.5f, -0.5f,
+        -0.5f, -0.5f, -0.5f,
+        -0.5f, -0.5f, -0.5f,
+        -0.5f, -0.5f,  0.5f,
+        -0.5f,  0.5f,  0.5f,
+
+         0.5f,  0.5f,  0.5f,
+         0.5f,  0.5f, -0.5f,
+         0.5f, -0.5f, -0.5f,
+         0.5f, -0.5f, -0.5f,
+         0.5f, -0.5f,  0.5f,
+         0.5f,  0.5f,  0.5f,
+
+        -0.5f, -0.5f, -0.5f,
+         0.5f, -0.5f, -0.5f,
+         0.5f, -0.5f,  0.5f,
+         0.5f, -0.5f,  0.5f,
+        -0.5f, -0.5f,  0.5f,
+        -0.5f, -0.5f, -0.5f,
+
+        -0.5f,  0.5f, -0.5f,
+         0.5f,  0.5f, -0.5f,
+         0.5f,  0.5f,  0.5f,
+         0.5f,  0.5f,  0.5f,
+        -0.5f,  0.5f,  0.5f,
+        -0.5f,  0.5f, -0.5f
+    };
+
+    // the arrays above are unindexed triangle lists, welding the repeated corners shrinks each cube from 36 vertices to 24 (8 for the light cube)
+    MeshData planeMesh = MeshBuilder::FromTriangles(vertices, 6, 8);
+    MeshData cubeMesh = MeshBuilder::FromTriangles(cubeVertices, 36, 8);
+    MeshData lightCubeMesh = MeshBuilder::FromTriangles(cubeLightVertices, 36, 3);
+    // reorder triangles and vertices for the post transform cache and vertex fetch, costs nothing per frame
+    std::vector<MeshOptimizeReport> meshReports;
+    meshReports.push_back(OptimizeMesh("plane", planeMesh, settings.overdrawSort));
+    meshReports.push_back(OptimizeMesh("cube", cubeMesh, settings.overdrawSort));
+    meshReports.push_back(OptimizeMesh("light cube", lightCubeMesh, settings.overdrawSort));
+
+    const std::string texture1Location = "res/textures/carpet_texture.png";
+    const std::string texture1SpecularLocation = "res/textures/carpet_texture_specular.png";
+    const std::string texture2Location = "res/textures/blanket_texture.png";
+    const std::string texture2SpecularLocation = "res/textures/blanket_texture_specular.png";
+
+    glm::vec3 cubePointLightPos[] = {
+        glm::vec3(-2.0f, 3.3f, -2.3f), 
+        glm::vec3(1.7f, 2.7f, 2.5f)
+    };
+
+    // setting up the lights once, lightsDirty marks when the block has to be uploaded again
+    FrameBlock frameData = {};
+    LightBlock lights = {};
+    // directional light
+    lights.directionalLight.direction = glm::vec3(-0.1f, -1.0f, 0.4f);
+    lights.directionalLight.ambient = glm::vec3(0.05f, 0.05f, 0.05f);
+    lights.directionalLight.diffuse = glm::vec3(0.125f, 0.125f, 0.125f);
+    lights.directionalLight.specular = glm::vec3(0.25f, 0.25f, 0.25f);
+    // spot light
+    lights.spotLight.position = glm::vec3(0.4f, 3.0f, -6.4f);
+    lights.spotLight.direction = glm::vec3(-0.1f, -1.0f, 0.4f);
+    lights.spotLight.cutoff = glm::cos(glm::radians(13.5f));
+    lights.spotLight.outerCutoff = glm::cos(glm::radians(18.7f));
+    lights.spotLight.ambient = glm::vec3(0.2f, 0.2f, 0.2f);
+    lights.spotLight.diffuse = glm::vec3(0.5f, 0.5f, 0.5f);
+    lights.spotLight.specular = glm::vec3(1.0f, 1.0f, 1.0f);
+    bool lightsDirty = true;
+    // point lights, binned into clusters every frame so there can be any number of them
+    std::vector<ClusterLight> pointLights(2, ClusterLight());
+    pointLights[0].position = cubePointLightPos[0];
+    pointLights[0].ambient = glm::vec3(0.2f, 0.2f, 0.2f);
+    pointLights[0].diffuse = glm::vec3(0.5f, 0.5f, 0.5f);
+    pointLights[0].specular = glm::vec3(1.0f, 1.0f, 1.0f);
+    pointLights[0].constant = 1.0f;
+    pointLights[0].linear = 0.045f;
+    pointLights[0].quadratic = 0.0075f;
+    pointLights[1].position = cubePointLightPos[1];
+    pointLights[1].ambient = glm::vec3(0.4f, 0.4f, 0.7f);
+    pointLights[1].diffuse = glm::vec3(0.4f, 0.4f, 0.7f);
+    pointLights[1].specular = glm::vec3(0.4f, 0.4f, 0.7f);
+    pointLights[1].constant = 1.0f;
+    pointLights[1].linear = 0.045f;
+    pointLights[1].quadratic = 0.0075f;
+    std::vector<ClusterLight> extraLights = buildLightField(settings.lights);
+    pointLights.insert(pointLights.end(), extraLights.begin(), extraLights.end());
+    for (ClusterLight& light : pointLights) {
+        light.range = ClusterLightRange(light);
+    }
+
+    // rotating to make a floor
+    glm::mat4 planeModel = glm::mat4(1.0f);
+    planeModel = glm::rotate(planeModel, glm::radians(-60.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+    planeModel = glm::translate(planeModel, glm::vec3(0.0, 1.0f, -0.7f));
+    planeModel = glm::scale(planeModel, glm::vec3(18.0f, 18.0f, 1.0f));
+    // the original cube first, then any extra copies
+    std::vector<glm::mat4> cubeModels;
+    cubeModels.push_back(glm::rotate(glm::mat4(1.0f), glm::radians(-55.0f), glm::vec3(1.0f, 0.0f, 0.0f)));
+    std::vector<glm::mat4> cubeGrid = buildCubeGrid(settings.cubes);
+    cubeModels.insert(cubeModels.end(), cubeGrid.begin(), cubeGrid.end());
+    // a marker cube for every point light, then the spot light
+    std::vector<glm::vec3> lightCubePositions;
+    for (const ClusterLight& light : pointLights) {
+        lightCubePositions.push_back(light.position);
+    }
+    lightCubePositions.push_back(lights.spotLight.position);
+    std::vector<glm::mat4> lightCubeModels;
+    for (const glm::vec3& position : lightCubePositions) {
+        glm::mat4 model = glm::mat4(1.0f);
+        model = glm::translate(model, position);
+        model = glm::scale(model, glm::vec3(0.2f, 0.2f, 0.2f));
+        model = glm::rotate(model, glm::radians(-60.0f), glm::vec3(1.0f, -0.3f, 0.0f));
+        lightCubeModels.push_back(model);
+    }
+    if (settings.software) {
+        // nothing past this point touches GL, the textures are decoded into memory and every frame is rendered on the CPU
+        SoftwareTexture softwareTextures[4];
+        const std::string* textureLocations[4] = { &texture1Location, &texture1SpecularLocation, &texture2Location, &texture2SpecularLocation };
+        jobs.ParallelFor(4, 1, [&](unsigned int begin, unsigned int end, unsigned int) {
+            for (unsigned int i = begin; i < end; i++) {
+                if (!softwareTextures[i].Load(*textureLocations[i])) {
+                    std::cout << "Failed to load texture" << std::endl;
+                }
+            }
+        });
+        std::vector<SoftwareDraw> draws;
+        draws.push_back({ &planeMesh, { &softwareTextures[0], &softwareTextures[1] }, InstanceBuffer::Pack(&planeModel, 1) });
+        draws.push_back({ &cubeMesh, { &softwareTextures[2], &softwareTextures[3] }, InstanceBuffer::Pack(cubeModels.data(), (unsigned int)cubeModels.size(), jobs) });
+        draws.push_back({ &lightCubeMesh, { nullptr, nullptr }, InstanceBuffer::Pack(lightCubeModels.data(), (unsigned int)lightCubeModels.size(), jobs) });
+        return renderSoftware(settings, jobs, draws, lights, pointLights);
+    }
+
+    GLFWwindow* window = NULL;
+    HeadlessContext headlessContext; // declared first so it outlives every GL object below
+    if (settings.headless) {
+        // render nodes and CI have no display, so create a context without a window
+        if (!headlessContext.Create(settings.width, settings.height)) {
+            std::cout << "Failed to create headless OpenGL context" << std::endl;
+            return -1;
+        }
+    }
+    else {
+        glfwInit();
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+        // Initialize window through GLFW
+        window = glfwCreateWindow(settings.width, settings.height, "Learning OpenGL Project", NULL, NULL);
+        if (window == NULL) {
+            std::cout << "Failed to create GLFW window. " << std::endl; // System.out.println(); equivalent
+            glfwTerminate();
+            return -1;
+        }
+        glfwMakeContextCurrent(window);
+        glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+        glfwSetCursorPosCallback(window, mouse_callback);
+        glfwSetScrollCallback(window, scroll_callback);
+
+        // ensures the mouse cursor doesn't display and applies to window
+        glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+    }
+    
+    // Ensure GLAD is initialized
+    GLADloadproc loader = settings.headless ? (GLADloadproc)HeadlessContext::GetProcAddress : (GLADloadproc)glfwGetProcAddress;
+    if (!gladLoadGLLoader(loader)) {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+
+    // headless frames go into an offscreen framebuffer since there is no window to present to
+    std::unique_ptr<Framebuffer> offscreen;
+    if (settings.headless) {
+        offscreen.reset(new Framebuffer(settings.width, settings.height));
+        if (!offscreen->IsComplete()) {
+            std::cout << "Offscreen framebuffer is incomplete" << std::endl;
+            return -1;
+        }
+        offscreen->Bind();
+        glViewport(0, 0, settings.width, settings.height);
+    }
+
+    // the textures stream in while everything else is set up and over the first frames: each starts out as a 1x1 placeholder
+    // (grey for the diffuse maps, no highlights for the specular ones) and the workers decode the images meanwhile
+    TextureStreamer textureStreamer(jobs);
+    unsigned int texture1 = textureStreamer.Request(texture1Location, glm::vec4(0.5f, 0.5f, 0.5f, 1.0f));
+    unsigned int texture1Specular = textureStreamer.Request(texture1SpecularLocation, glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+    unsigned int texture2 = textureStreamer.Request(texture2Location, glm::vec4(0.5f, 0.5f, 0.5f, 1.0f));
+    unsigned int texture2Specular = textureStreamer.Request(texture2SpecularLocation, glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+
+    // enable depth testing
+    glEnable(GL_DEPTH_TEST); 
+
+    // read in shader from file
+    Shader shader("res/shaders/BasicShaders.shader");
+    Shader lightShader("res/shaders/BasicShadersLight.shader");
+    Shader depthShader("res/shaders/DepthOnly.shader");
+    Shader boxShader("res/shaders/BoundingBox.shader");
+
+    // the deferred path writes the textured meshes into a G-buffer and lights every pixel once in a fullscreen pass
+    std::unique_ptr<GBuffer> gbuffer;
+    std::unique_ptr<Shader> gbufferShader;
+    std::unique_ptr<Shader> deferredShader;
+    unsigned int fullscreenVAO = 0; // core profile needs a vao bound even when the vertex shader makes up its own positions
+    unsigned int outputFramebuffer = offscreen ? offscreen->GetID() : 0;
+    if (settings.deferred) {
+        gbuffer.reset(new GBuffer(settings.width, settings.height));
+        if (!gbuffer->IsComplete()) {
+            std::cout << "G-buffer is incomplete" << std::endl;
+            return -1;
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, outputFramebuffer);
+        gbufferShader.reset(new Shader("res/shaders/GBuffer.shader"));
+        deferredShader.reset(new Shader("res/shaders/DeferredLighting.shader"));
+        glGenVertexArrays(1, &fullscreenVAO);
+    }
+
+    // the index buffers are created while their vao is bound, so the vao remembers them
+    unsigned int VAO0, VAO1, VAO2;
+    glGenVertexArrays(1, &VAO0);
+    RenderState::BindVertexArray(VAO0);
+    VertexBuffer vbo0(planeMesh.vertices.data(), (unsigned int)(planeMesh.vertices.size() * sizeof(float)));
+    IndexBuffer ibo0(planeMesh.indices.data(), (unsigned int)planeMesh.indices.size(), planeMesh.IndexType());
+    handleVAO();
+    glGenVertexArrays(1, &VAO1);
+    RenderState::BindVertexArray(VAO1);
+    VertexBuffer vbo1(cubeMesh.vertices.data(), (unsigned int)(cubeMesh.vertices.size() * sizeof(float)));
+    IndexBuffer ibo1(cubeMesh.indices.data(), (unsigned int)cubeMesh.indices.size(), cubeMesh.IndexType());
+    handleVAO();
+    glGenVertexArrays(1, &VAO2);
+    RenderState::BindVertexArray(VAO2);
+    VertexBuffer vbo2(lightCubeMesh.vertices.data(), (unsigned int)(lightCubeMesh.vertices.size() * sizeof(float)));
+    IndexBuffer ibo2(lightCubeMesh.indices.data(), (unsigned int)lightCubeMesh.indices.size(), lightCubeMesh.IndexType());
+    handleLightVAO();
+
+    RenderState::BindVertexArray(VAO0);
+
+    // creating the view matrix (transform to camera view), and the projection matrix (transform to screen)
+    // model matrices (transform to global world space) are per instance and set up below with the instance buffers
+    //glm::mat4 view = glm::mat4(1.0f);
+    glm::mat4 view = camera.GetViewMatrix();
+    glm::mat4 projection = glm::mat4(1.0f);
+    projection = glm::perspective(glm::radians(camera.Zoom), (float)settings.width / (float)settings.height, NEAR_PLANE, FAR_PLANE);
+
+    // uniform locations are reflected when each Shader links, the sampler units never change so they're set once here
+    shader.Bind();
+    shader.SetInt("material.diffuse"_uniform, 0);
+    shader.SetInt("material.specular"_uniform, 1);
+    shader.SetInt("clusterLights"_uniform, CLUSTER_LIGHT_UNIT);
+    shader.SetInt("clusterGrid"_uniform, CLUSTER_GRID_UNIT);
+    shader.SetInt("clusterLightIndices"_uniform, CLUSTER_INDEX_UNIT);
+
+    // camera and light data live in uniform buffers shared by both programs instead of per program uniforms
+    shader.BindUniformBlock("FrameData", FRAME_BLOCK_BINDING);
+    shader.BindUniformBlock("LightData", LIGHT_BLOCK_BINDING);
+    lightShader.BindUniformBlock("FrameData", FRAME_BLOCK_BINDING);
+    lightShader.BindUniformBlock("LightData", LIGHT_BLOCK_BINDING);
+    depthShader.BindUniformBlock("FrameData", FRAME_BLOCK_BINDING);
+    boxShader.BindUniformBlock("FrameData", FRAME_BLOCK_BINDING);
+    if (settings.deferred) {
+        gbufferShader->Bind();
+        gbufferShader->SetInt("material.diffuse"_uniform, 0);
+        gbufferShader->SetInt("material.specular"_uniform, 1);
+        gbufferShader->BindUniformBlock("FrameData", FRAME_BLOCK_BINDING);
+        deferredShader->Bind();
+        deferredShader->SetInt("clusterLights"_uniform, CLUSTER_LIGHT_UNIT);
+        deferredShader->SetInt("clusterGrid"_uniform, CLUSTER_GRID_UNIT);
+        deferredShader->SetInt("clusterLightIndices"_uniform, CLUSTER_INDEX_UNIT);
+        deferredShader->SetInt("gAlbedo"_uniform, GBUFFER_FIRST_UNIT);
+        deferredShader->SetInt("gSpecular"_uniform, GBUFFER_FIRST_UNIT + 1);
+        deferredShader->SetInt("gNormal"_uniform, GBUFFER_FIRST_UNIT + 2);
+        deferredShader->SetInt("gDepth"_uniform, GBUFFER_FIRST_UNIT + 3);
+        deferredShader->BindUniformBlock("FrameData", FRAME_BLOCK_BINDING);
+        deferredShader->BindUniformBlock("LightData", LIGHT_BLOCK_BINDING);
+    }
+    UniformBuffer frameBuffer(sizeof(FrameBlock), FRAME_BLOCK_BINDING);
+    UniformBuffer lightBuffer(sizeof(LightBlock), LIGHT_BLOCK_BINDING);
+
+    ClusteredLights clusteredLights(jobs);
+
+    // every mesh is drawn instanced, the model matrices come from a per instance buffer attached to its vao
+    InstanceBuffer planeInstances(&planeModel, 1);
+    InstanceBuffer cubeInstances(cubeModels.data(), (unsigned int)cubeModels.size());
+    InstanceBuffer lightCubeInstances(lightCubeModels.data(), (unsigned int)lightCubeModels.size());
+    RenderState::BindVertexArray(VAO0);
+    planeInstances.AttachToVertexArray();
+    RenderState::BindVertexArray(VAO1);
+    cubeInstances.AttachToVertexArray();
+    RenderState::BindVertexArray(VAO2);
+    lightCubeInstances.AttachToVertexArray();
+
+    // position only copies of the plane and cube for the depth pre-pass, sharing the index and instance buffers
+    // a 12 byte stride instead of 32 means far fewer bytes fetched per vertex when only depth is wanted
+    std::vector<float> planePositions = planeMesh.Positions();
+    std::vector<float> cubePositions = cubeMesh.Positions();
+    unsigned int depthVAO0, depthVAO1;
+    glGenVertexArrays(1, &depthVAO0);
+    RenderState::BindVertexArray(depthVAO0);
+    VertexBuffer depthVbo0(planePositions.data(), (unsigned int)(planePositions.size() * sizeof(float)));
+    handleLightVAO(); // the light cube layout is position only as well
+    ibo0.Bind();
+    planeInstances.AttachToVertexArray();
+    glGenVertexArrays(1, &depthVAO1);
+    RenderState::BindVertexArray(depthVAO1);
+    VertexBuffer depthVbo1(cubePositions.data(), (unsigned int)(cubePositions.size() * sizeof(float)));
+    handleLightVAO();
+    ibo1.Bind();
+    cubeInstances.AttachToVertexArray();
+    // the light cube again without instance attributes, stretched over object boxes for occlusion queries
+    unsigned int boxVAO;
+    glGenVertexArrays(1, &boxVAO);
+    RenderState::BindVertexArray(boxVAO);
+    vbo2.Bind();
+    handleLightVAO();
+    ibo2.Bind();
+    RenderState::BindVertexArray(VAO0);
+
+    // benchmark mode replays a scripted camera path so every run renders exactly the same frames
+    bool benchmarking = !settings.benchmarkPath.empty();
+    CameraPath cameraPath;
+    std::unique_ptr<Benchmark> benchmark;
+    if (benchmarking) {
+        if (!cameraPath.Load(settings.benchmarkPath)) {
+            std::cout << "Failed to load camera path " << settings.benchmarkPath << std::endl;
+            return -1;
+        }
+        benchmark.reset(new Benchmark());
+        benchmark->AddSetting("render_path", settings.deferred ? "deferred" : "forward");
+        benchmark->AddSetting("depth_prepass", settings.depthPrepass ? "on" : "off");
+        benchmark->AddSetting("culling", std::string(settings.flatCull ? "flat" : "bvh") + (settings.occlusionCull ? " + occlusion" : "") + (settings.occlusionQueries ? " + queries" : ""));
+        benchmark->AddSetting("cubes", std::to_string(settings.cubes));
+        benchmark->AddSetting("lights", std::to_string(settings.lights));
+        for (const MeshOptimizeReport& report : meshReports) {
+            benchmark->AddMeshReport(report);
+        }
+        if (!settings.headless) {
+            glfwSwapInterval(0); // vsync would cap the measured frame rate
+        }
+    }
+    bool recording = !settings.recordPath.empty() && !benchmarking && !settings.headless;
+    GpuProfiler profiler(settings.profileGpu || benchmarking, benchmarking);
+    float lastProfileReport = 0.0f;
+    CameraPath recordedPath;
+
+    // every object is submitted to the render queue each frame and drawn in key order instead of a fixed order
+    // the plane and cube pass draws are timed on their own, the other passes as a whole
+    RenderQueue renderQueue(profiler);
+    unsigned int sceneProgram = settings.deferred ? gbufferShader->GetID() : shader.GetID();
+    std::vector<unsigned int> planeBatches, cubeBatches, lightCubeBatches; // every pass each object is drawn in
+    planeBatches.push_back(renderQueue.AddBatch({ "plane", SCENE_PASS, sceneProgram, VAO0, texture1, texture1Specular, &planeInstances, ibo0.GetCount(), ibo0.GetType() }));
+    cubeBatches.push_back(renderQueue.AddBatch({ "cube", SCENE_PASS, sceneProgram, VAO1, texture2, texture2Specular, &cubeInstances, ibo1.GetCount(), ibo1.GetType() }));
+    lightCubeBatches.push_back(renderQueue.AddBatch({ nullptr, LIGHT_CUBE_PASS, lightShader.GetID(), VAO2, 0, 0, &lightCubeInstances, ibo2.GetCount(), ibo2.GetType() }));
+    if (settings.depthPrepass) {
+        planeBatches.push_back(renderQueue.AddBatch({ nullptr, DEPTH_PREPASS, depthShader.GetID(), depthVAO0, 0, 0, &planeInstances, ibo0.GetCount(), ibo0.GetType() }));
+        cubeBatches.push_back(renderQueue.AddBatch({ nullptr, DEPTH_PREPASS, depthShader.GetID(), depthVAO1, 0, 0, &cubeInstances, ibo1.GetCount(), ibo1.GetType() }));
+    }
+    // the queue draws from these, the normal matrices are worked out once here instead of every frame
+    std::vector<InstanceData> planeInstanceData = InstanceBuffer::Pack(&planeModel, 1);
+    std::vector<InstanceData> cubeInstanceData = InstanceBuffer::Pack(cubeModels.data(), (unsigned int)cubeModels.size(), jobs);
+    std::vector<InstanceData> lightCubeInstanceData = InstanceBuffer::Pack(lightCubeModels.data(), (unsigned int)lightCubeModels.size(), jobs);
+    // every object gets a world space box for frustum culling and picking, none of them move so the boxes are built once
+    // the BVH's ids are indices into sceneObjects, the flat set is only filled for --flat-cull
+    std::vector<SceneObject> sceneObjects;
+    std::vector<BoundingBox> sceneBounds;
+    OccluderMesh planeOccluder = { &planePositions, &planeMesh.indices };
+    OccluderMesh cubeOccluder = { &cubePositions, &cubeMesh.indices };
+    auto addSceneObjects = [&](const char* name, const std::vector<unsigned int>& batches, const std::vector<InstanceData>& instances, const BoundingBox& localBounds, const OccluderMesh* occluder) {
+        size_t first = sceneBounds.size();
+        sceneBounds.resize(first + instances.size());
+        for (const InstanceData& instance : instances) {
+            sceneObjects.push_back({ name, &batches, &instance, occluder });
+        }
+        jobs.ParallelFor((unsigned int)instances.size(), 1024, [&](unsigned int begin, unsigned int end, unsigned int) {
+            for (unsigned int i = begin; i < end; i++) {
+                sceneBounds[first + i] = TransformBounds(localBounds, instances[i].model);
+            }
+        });
+    };
+    addSceneObjects("plane", planeBatches, planeInstanceData, ComputeBounds(planePositions), &planeOccluder);
+    addSceneObjects("cube", cubeBatches, cubeInstanceData, ComputeBounds(cubePositions), &cubeOccluder);
+    addSceneObjects("light cube", lightCubeBatches, lightCubeInstanceData, ComputeBounds(lightCubeMesh.Positions()), nullptr);
+    Bvh sceneBvh;
+    sceneBvh.Build(sceneBounds);
+    CullingSet cullingSet;
+    if (settings.flatCull) {
+        for (const BoundingBox& box : sceneBounds) {
+            cullingSet.Add(box);
+        }
+    }
+    OcclusionBuffer occlusionBuffer;
+    std::vector<std::pair<float, unsigned int>> occluderCandidates; // screen size estimate and object
+    std::vector<unsigned int> unoccludedObjects;
+    std::unique_ptr<OcclusionQueries> occlusionQueries;
+    std::vector<unsigned int> queriedObjects;
+    std::vector<unsigned int> objectSlots; // first render queue slot of each drawn object
+    if (settings.occlusionQueries) {
+        occlusionQueries.reset(new OcclusionQueries((unsigned int)sceneObjects.size(), boxShader, boxVAO, ibo2.GetCount(), ibo2.GetType(),
+            ComputeBounds(lightCubeMesh.Positions())));
+    }
+    bool picking = false; // left mouse button state last frame, a pick happens on the press
+
+    // fills the depth buffer with the textured meshes and leaves depth testing on GL_EQUAL with writes off,
+    // so the shading pass that follows only runs on the fragments that end up visible
+    auto drawDepthPrepass = [&]() {
+        profiler.BeginPass("depth prepass");
+        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+        renderQueue.Execute(DEPTH_PREPASS);
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+        glDepthFunc(GL_EQUAL);
+        glDepthMask(GL_FALSE);
+        profiler.EndPass();
+    };
+    // back to normal depth testing for everything drawn after the shading pass
+    auto endDepthPrepass = [&]() {
+        glDepthFunc(GL_LESS);
+        glDepthMask(GL_TRUE);
+    };
+
+    // keep the window open in the render loop until instructed to close
+    // glfwWindowShouldClose checks whether the window should close each loop iteration
+    // headless and benchmark runs instead stop after the requested number of frames
+    bool fixedFrameCount = settings.headless || benchmarking;
+    if (fixedFrameCount) {
+        textureStreamer.Finish(); // their frames have to come out the same however long the textures take to load
+    }
+    unsigned int frameCount = 0;
+    float renderStart = currentTime();
+    lastFrame = renderStart;
+    while (fixedFrameCount ? frameCount < settings.frames : !glfwWindowShouldClose(window)) {
+        // time calculations
+        float timeOfCurrentFrame = currentTime();
+        deltaTime = timeOfCurrentFrame - lastFrame;
+        lastFrame = timeOfCurrentFrame;
+
+        if (benchmarking) {
+            benchmark->BeginFrame();
+            // the path is spread evenly over the frames, so the camera doesn't depend on how fast they render
+            float pathTime = settings.frames > 1 ? cameraPath.Duration() * frameCount / (settings.frames - 1) : 0.0f;
+            cameraPath.Apply(camera, pathTime);
+        }
+        else if (!settings.headless) {
+            processInput(window); // handles input - currently checking for closing via escape key
+            // left click picks whatever object box is straight ahead of the camera
+            bool pickPressed = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS;
+            if (pickPressed && !picking) {
+                unsigned int picked;
+                float pickDistance;
+                if (sceneBvh.Raycast(camera.Position, camera.Front, FAR_PLANE, picked, pickDistance)) {
+                    std::cout << "Picked " << sceneObjects[picked].name << " (object " << picked << ") at " << pickDistance << std::endl;
+                }
+                else {
+                    std::cout << "Picked nothing" << std::endl;
+                }
+            }
+            picking = pickPressed;
+            if (recording) {
+                recordedPath.AddKeyframe(timeOfCurrentFrame - renderStart, camera);
+            }
+        }
+
+        textureStreamer.Update(); // whatever the workers finished decoding or copying since last frame goes to the GPU
+        // rendering commands should appear below here, above glfwSwapBuffers(window)
+        profiler.BeginFrame();
+        RenderState::BeginFrame();
+        profiler.BeginPass("clear");
+        glClearColor(0.2f, 0.3f, 0.3f, 1.0f); // test that rendering commands are working - clears color buffer with color specified in this function
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); // the actual clear instruction, specified to the color buffer bit
+        profiler.EndPass();
+
+        // passing uniforms to the shaders
+        projection = glm::perspective(glm::radians(camera.Zoom), (float)settings.width / (float)settings.height, NEAR_PLANE, FAR_PLANE);
+        view = camera.GetViewMatrix();
+        frameData.view = view;
+        frameData.projection = projection;
+        frameData.viewPosition = camera.Position;
+
+        // the frustum cull and, when nothing has to filter its result on this thread, the render queue fill after it run as jobs
+        // while this thread bins the point lights and uploads the uniform blocks
+        // objects get their queue slots up front in the order a serial loop would submit them, so the view depths and keys
+        // are worked out in parallel and the sorted queue comes out the same
+        Frustum frustum = camera.GetFrustum(projection);
+        auto fillRenderQueue = [&](const std::vector<unsigned int>& objects) {
+            renderQueue.Begin();
+            objectSlots.resize(objects.size());
+            unsigned int itemCount = 0;
+            for (size_t i = 0; i < objects.size(); i++) {
+                objectSlots[i] = itemCount;
+                itemCount += (unsigned int)sceneObjects[objects[i]].batches->size();
+            }
+            unsigned int firstSlot = renderQueue.Reserve(itemCount);
+            jobs.ParallelFor((unsigned int)objects.size(), 1024, [&](unsigned int begin, unsigned int end, unsigned int) {
+                for (unsigned int i = begin; i < end; i++) {
+                    const SceneObject& object = sceneObjects[objects[i]];
+                    float viewDepth = -(view * object.instance->model[3]).z;
+                    unsigned int slot = firstSlot + objectSlots[i];
+                    for (unsigned int batch : *object.batches) {
+                        renderQueue.SubmitAt(slot++, batch, *object.instance, viewDepth);
+                    }
+                }
+            });
+        };
+        JobCounter culled, filled;
+        jobs.Run([&](unsigned int) {
+            if (settings.flatCull) {
+                cullingSet.Cull(frustum, jobs);
+            }
+            else {
+                sceneBvh.Cull(frustum);
+            }
+        }, &culled);
+        const std::vector<unsigned int>& visibleObjects = settings.flatCull ? cullingSet.Visible() : sceneBvh.Visible();
+        bool fillAfterCull = !settings.occlusionCull && !settings.occlusionQueries;
+        if (fillAfterCull) {
+            jobs.RunAfter(culled, [&](unsigned int) { fillRenderQueue(visibleObjects); }, &filled);
+        }
+
+        clusteredLights.Update(pointLights, view, glm::radians(camera.Zoom), (float)settings.width / (float)settings.height, NEAR_PLANE, FAR_PLANE);
+        clusteredLights.FillFrameBlock(frameData, settings.width, settings.height, NEAR_PLANE, FAR_PLANE);
+        frameBuffer.SetData(&frameData, sizeof(frameData));
+        if (lightsDirty) {
+            lightBuffer.SetData(&lights, sizeof(lights));
+            lightsDirty = false;
+        }
+        clusteredLights.Bind(CLUSTER_LIGHT_UNIT, CLUSTER_GRID_UNIT, CLUSTER_INDEX_UNIT);
+
+        // only what survives frustum culling is submitted, sorted by how far its origin is in front of the camera
+        jobs.Wait(culled);
+        CullStats cullStats = settings.flatCull ? cullingSet.Stats() : sceneBvh.Stats();
+        const std::vector<unsigned int>* drawnObjects = &visibleObjects;
+        if (settings.occlusionCull) {
+            // the occluders that cover the most screen, estimated as box size over distance
+            occlusionBuffer.Begin(projection * view);
+            occluderCandidates.clear();
+            for (unsigned int index : visibleObjects) {
+                if (sceneObjects[index].occluder != nullptr) {
+                    float distance = std::max(glm::length(sceneBounds[index].center - camera.Position), NEAR_PLANE);
+                    occluderCandidates.push_back(std::make_pair(glm::length(sceneBounds[index].extents) / distance, index));
+                }
+            }
+            size_t occluderCount = std::min((size_t)MAX_OCCLUDERS, occluderCandidates.size());
+            std::partial_sort(occluderCandidates.begin(), occluderCandidates.begin() + occluderCount, occluderCandidates.end(),
+                [](const std::pair<float, unsigned int>& a, const std::pair<float, unsigned int>& b) { return a.first > b.first; });
+            for (size_t i = 0; i < occluderCount; i++) {
+                const SceneObject& object = sceneObjects[occluderCandidates[i].second];
+                occlusionBuffer.RasterizeOccluder(*object.occluder->positions, *object.occluder->indices, object.instance->model);
+            }
+            occlusionBuffer.BuildHierarchy();
+            occlusionBuffer.FilterVisible(visibleObjects, sceneBounds, unoccludedObjects);
+            drawnObjects = &unoccludedObjects;
+        }
+        if (settings.occlusionQueries) {
+            occlusionQueries->Filter(*drawnObjects, sceneBounds, camera.Position, NEAR_PLANE, queriedObjects);
+            drawnObjects = &queriedObjects;
+        }
+        if (fillAfterCull) {
+            jobs.Wait(filled);
+        }
+        else {
+            fillRenderQueue(*drawnObjects);
+        }
+        renderQueue.Sort();
+
+        if (settings.deferred) {
+            // geometry pass, only surface data goes into the G-buffer
+            gbuffer->Bind();
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            if (settings.depthPrepass) {
+                drawDepthPrepass();
+            }
+            profiler.BeginPass("gbuffer");
+            renderQueue.Execute(SCENE_PASS);
+            profiler.EndPass();
+            if (settings.depthPrepass) {
+                endDepthPrepass();
+            }
+
+            // lighting pass, one fullscreen triangle into the real target
+            glBindFramebuffer(GL_FRAMEBUFFER, outputFramebuffer);
+            profiler.BeginPass("deferred lighting");
+            glDisable(GL_DEPTH_TEST);
+            deferredShader->Bind();
+            deferredShader->SetMat4("inverseViewProjection"_uniform, glm::inverse(projection * view));
+            gbuffer->BindTextures(GBUFFER_FIRST_UNIT);
+            RenderState::BindVertexArray(fullscreenVAO);
+            glDrawArrays(GL_TRIANGLES, 0, 3);
+            glEnable(GL_DEPTH_TEST);
+            profiler.EndPass();
+
+            // the light cubes are still drawn forward, so they need the scene's depth
+            gbuffer->BlitDepth(outputFramebuffer);
+        }
+        else {
+            if (settings.depthPrepass) {
+                drawDepthPrepass();
+            }
+            // drawing the triangle
+            renderQueue.Execute(SCENE_PASS);
+            if (settings.depthPrepass) {
+                endDepthPrepass();
+            }
+        }
+
+        if (settings.occlusionQueries) {
+            // the scene's depth is complete here, the results are read next frame
+            profiler.BeginPass("occlusion queries");
+            occlusionQueries->IssueQueries(sceneBounds);
+            profiler.EndPass();
+        }
+
+        profiler.BeginPass("light cubes");
+        renderQueue.Execute(LIGHT_CUBE_PASS);
+        profiler.EndPass();
+        profiler.EndFrame();
+
+        frameCount++;
+        if (benchmarking) {
+            benchmark->SetCullCounts((unsigned int)drawnObjects->size(), cullStats.tested - (unsigned int)drawnObjects->size());
+            benchmark->EndCpu();
+            benchmark->EndFrame();
+        }
+        if (settings.profileGpu && timeOfCurrentFrame - lastProfileReport >= 1.0f) {
+            profiler.Report(std::cout);
+            RenderStateStats stateStats = RenderState::Stats();
+            std::cout << "State changes per frame  issued: " << stateStats.issued << "  elided: " << stateStats.elided << std::endl;
+            ClusterStats clusterStats = clusteredLights.Stats();
+            std::cout << "Clustered lights  visible: " << clusterStats.lights << "/" << pointLights.size() << "  assignments: " << clusterStats.assignments
+                << "  max per cluster: " << clusterStats.maxPerCluster << "  binning: " << clusterStats.binMs << " ms" << std::endl;
+            std::cout << "Frustum culling  visible: " << cullStats.visible << "/" << cullStats.tested << "  culled: " << cullStats.tested - cullStats.visible
+                << "  boxes tested: " << cullStats.boxTests << "  time: " << cullStats.cullMs << " ms" << std::endl;
+            if (settings.occlusionCull) {
+                OcclusionStats occlusionStats = occlusionBuffer.Stats();
+                std::cout << "Occlusion culling  occluders: " << occlusionStats.occluders << "  triangles: " << occlusionStats.triangles
+                    << "  occluded: " << occlusionStats.occluded << "/" << occlusionStats.tested << "  raster: " << occlusionStats.rasterMs
+                    << " ms  test: " << occlusionStats.testMs << " ms" << std::endl;
+            }
+            if (settings.occlusionQueries) {
+                OcclusionQueryStats queryStats = occlusionQueries->Stats();
+                std::cout << "Occlusion queries  occluded: " << queryStats.occluded << "/" << queryStats.tested << "  issued: " << queryStats.issued
+                    << "  results read: " << queryStats.resultsRead << "  waiting: " << queryStats.waiting
+                    << (occlusionQueries->Conservative() ? "  (conservative)" : "") << std::endl;
+            }
+            TextureStreamStats streamStats = textureStreamer.Stats();
+            if (streamStats.pending > 0) {
+                std::cout << "Texture streaming  pending: " << streamStats.pending << "  levels uploaded: " << streamStats.levelsUploaded
+                    << "  bytes uploaded: " << streamStats.bytesUploaded << std::endl;
+            }
+            else {
+                std::cout << "Texture streaming  every texture resident after " << streamStats.residentMs << " ms" << std::endl;
+            }
+            RenderQueueStats queueStats = renderQueue.Stats();
+            std::cout << "Render queue  items: " << queueStats.items << "  draws: " << queueStats.draws << "  instance uploads: " << queueStats.uploads
+                << "  sort: " << queueStats.sortMs << " ms" << std::endl;
+            lastProfileReport = timeOfCurrentFrame;
+        }
+        if (settings.headless) {
+            continue; // nothing to present, the frame stays in the offscreen framebuffer
+        }
+
+        // a single buffer image draws the image pixel by pixel, which can cause flickering. double buffered images handle this with back and front buffers
+        // the back buffer goes pixel by pixel, while the front buffer is what is shown on screen in the window. the back is swapped to front when ready
+        glfwSwapBuffers(window); // handles the buffer containing the window's pixel color values and swaps it ouch each frame for the new one
+        glfwPollEvents(); // checks for keyboard/mouse inputs
+    }
+
+    profiler.Finish();
+    if (settings.profileGpu) {
+        profiler.Report(std::cout);
+    }
+    if (benchmarking) {
+        benchmark->Finish();
+        if (benchmark->WriteReport(settings.reportPath, settings.benchmarkPath, settings.width, settings.height, profiler)) {
+            std::cout << "Benchmark results written to " << settings.reportPath << std::endl;
+        }
+        else {
+            std::cout << "Failed to write " << settings.reportPath << std::endl;
+        }
+    }
+    if (recording && !recordedPath.Save(settings.recordPath)) {
+        std::cout << "Failed to write " << settings.recordPath << std::endl;
+    }
+
+    if (settings.headless) {
+        glFinish(); // wait for the GPU (or llvmpipe) so the timing covers the actual rendering
+        float renderSeconds = currentTime() - renderStart;
+        std::cout << "Rendered " << frameCount << " frames at " << settings.width << "x" << settings.height
+            << " in " << renderSeconds << " s (" << frameCount / renderSeconds << " fps)" << std::endl;
+        if (!settings.outputPath.empty() && !offscreen->WritePPM(settings.outputPath)) {
+            std::cout << "Failed to write " << settings.outputPath << std::endl;
+        }
+    }
+
+    // cleanly de allocating no longer needed buffers and vertex arrays
+    RenderState::ForgetVertexArray(VAO0);
+    RenderState::ForgetVertexArray(VAO1);
+    RenderState::ForgetVertexArray(VAO2);
+    glDeleteVertexArrays(1, &VAO0);
+    //glDeleteBuffers(1, &VBO0);
+    glDeleteVertexArrays(1, &VAO1);
+    //glDeleteBuffers(1, &VBO1);
+    glDeleteVertexArrays(1, &VAO2);
+    occlusionQueries.reset();
+    RenderState::ForgetVertexArray(boxVAO);
+    glDeleteVertexArrays(1, &boxVAO);
+    RenderState::ForgetVertexArray(depthVAO0);
+    RenderState::ForgetVertexArray(depthVAO1);
+    glDeleteVertexArrays(1, &depthVAO0);
+    glDeleteVertexArrays(1, &depthVAO1);
+    if (fullscreenVAO != 0) {
+        RenderState::ForgetVertexArray(fullscreenVAO);
+        glDeleteVertexArrays(1, &fullscreenVAO);
+    }
+    //glDeleteBuffers(1, &VBO2);
+
+    if (!settings.headless) {
+        glfwTerminate();// properly de-allocate allocated resources in GLFW, called when render loop is over
+    }
+    return 0;
+}
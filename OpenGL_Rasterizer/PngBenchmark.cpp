@@ -0,0 +1,182 @@
+// benchmark for PngDecoder against stb_image, built as its own console program by PngBenchmark.vcxproj
+// every file is read into memory first so only decoding is timed, then decoded to RGBA with stbi_load_from_memory and with
+// PngDecoder on one worker and on --threads workers, one image at a time and all of them at once (one job per image)
+// throughput is decoded RGBA MB/s, and every PngDecoder output is checked byte for byte against stb_image's
+// PNGs written with full flushes (zlib's Z_FULL_FLUSH, e.g. every few rows) show the within image inflate split
+#include "JobSystem.h"
+#include "PngDecoder.h"
+
+#include "stb_image.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// one file and its decoded pixels
+struct Image {
+    std::string path;
+    std::vector<unsigned char> file;
+    std::vector<unsigned char> reference; // stb_image's RGBA
+    std::vector<unsigned char> pixels; // PngDecoder writes here, as it would into a mapped pixel buffer
+    PngDecodeStats stats;
+};
+
+static bool readFile(const std::string& path, std::vector<unsigned char>& data) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        return false;
+    }
+    data.resize((size_t)file.tellg());
+    file.seekg(0);
+    return (bool)file.read((char*)data.data(), data.size());
+}
+
+static double msSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static double megabytesPerSecond(size_t bytes, double ms) {
+    return (double)bytes / (ms * 1000.0);
+}
+
+static bool decodeStb(Image& image) {
+    int width, height, channels;
+    unsigned char* data = stbi_load_from_memory(image.file.data(), (int)image.file.size(), &width, &height, &channels, 4);
+    if (!data) {
+        return false;
+    }
+    image.reference.assign(data, data + (size_t)width * height * 4);
+    stbi_image_free(data);
+    return true;
+}
+
+static bool decodePng(Image& image, JobSystem& jobs) {
+    PngDecoder png;
+    if (!png.Open(image.file.data(), image.file.size())) {
+        return false;
+    }
+    image.pixels.resize(png.DecodedSize());
+    bool decoded = png.Decode(image.pixels.data(), jobs);
+    image.stats = png.Stats();
+    return decoded;
+}
+
+// best time of repeats for one image decoded with PngDecoder, -1 if it can't
+static double timePng(Image& image, JobSystem& jobs, unsigned int repeats) {
+    double best = -1.0;
+    for (unsigned int repeat = 0; repeat < repeats; repeat++) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        if (!decodePng(image, jobs)) {
+            return -1.0;
+        }
+        double ms = msSince(start);
+        best = repeat == 0 ? ms : std::min(best, ms);
+    }
+    if (image.pixels != image.reference) {
+        std::cout << "  " << image.path << " decoded differently from stb_image" << std::endl;
+    }
+    return best;
+}
+
+int main(int argc, char** argv) {
+    unsigned int threads = std::max(std::thread::hardware_concurrency(), 1u);
+    unsigned int repeats = 3;
+    std::vector<Image> images;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) {
+            threads = (unsigned int)std::max(std::atoi(argv[++i]), 1);
+        }
+        else if (arg == "--repeat" && i + 1 < argc) {
+            repeats = (unsigned int)std::max(std::atoi(argv[++i]), 1);
+        }
+        else if (arg.compare(0, 2, "--") != 0) {
+            images.push_back(Image());
+            images.back().path = arg;
+        }
+        else {
+            std::cout << "Usage: " << argv[0] << " [--threads N] [--repeat N] [file.png]..." << std::endl;
+            return -1;
+        }
+    }
+    if (images.empty()) {
+        const char* textures[] = { "res/textures/carpet_texture.png", "res/textures/carpet_texture_specular.png",
+            "res/textures/blanket_texture.png", "res/textures/blanket_texture_specular.png" };
+        for (const char* path : textures) {
+            images.push_back(Image());
+            images.back().path = path;
+        }
+    }
+
+    std::vector<Image> loaded;
+    for (Image& image : images) {
+        if (!readFile(image.path, image.file) || !decodeStb(image)) {
+            std::cout << "Failed to load " << image.path << std::endl;
+            continue;
+        }
+        loaded.push_back(std::move(image));
+    }
+    if (loaded.empty()) {
+        return -1;
+    }
+
+    JobSystem serial(1);
+    JobSystem parallel(threads);
+    std::cout << "PNG decode to RGBA, best of " << repeats << " runs, " << threads << " threads" << std::endl;
+    size_t totalBytes = 0;
+    for (Image& image : loaded) {
+        totalBytes += image.reference.size();
+        double stbMs = 0.0;
+        for (unsigned int repeat = 0; repeat < repeats; repeat++) {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            decodeStb(image);
+            double ms = msSince(start);
+            stbMs = repeat == 0 ? ms : std::min(stbMs, ms);
+        }
+        std::cout << "  " << image.path << " (" << image.reference.size() / 4 << " px)  stbi_load " << megabytesPerSecond(image.reference.size(), stbMs) << " MB/s";
+        double serialMs = timePng(image, serial, repeats);
+        double parallelMs = timePng(image, parallel, repeats);
+        if (serialMs < 0.0 || parallelMs < 0.0) {
+            std::cout << "  not handled by PngDecoder" << std::endl;
+            continue;
+        }
+        std::cout << "  PngDecoder 1 thread " << megabytesPerSecond(image.reference.size(), serialMs) << " MB/s"
+            << "  " << threads << " threads " << megabytesPerSecond(image.reference.size(), parallelMs) << " MB/s"
+            << " (" << image.stats.segments << " inflate segments, " << image.stats.chains << " filter chains, inflate "
+            << image.stats.inflateMs << " ms, unfilter " << image.stats.unfilterMs << " ms)" << std::endl;
+    }
+
+    // every image at once: stb_image one after another, PngDecoder with a job per image on top of the splits inside each
+    double stbMs = 0.0, pngMs = 0.0;
+    for (unsigned int repeat = 0; repeat < repeats; repeat++) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (Image& image : loaded) {
+            decodeStb(image);
+        }
+        double ms = msSince(start);
+        stbMs = repeat == 0 ? ms : std::min(stbMs, ms);
+
+        start = std::chrono::steady_clock::now();
+        parallel.ParallelFor((unsigned int)loaded.size(), 1, [&](unsigned int begin, unsigned int end, unsigned int) {
+            for (unsigned int i = begin; i < end; i++) {
+                decodePng(loaded[i], parallel);
+            }
+        });
+        ms = msSince(start);
+        pngMs = repeat == 0 ? ms : std::min(pngMs, ms);
+    }
+    std::cout << "  all " << loaded.size() << " images  stbi_load " << megabytesPerSecond(totalBytes, stbMs) << " MB/s"
+        << "  PngDecoder " << megabytesPerSecond(totalBytes, pngMs) << " MB/s" << std::endl;
+    for (Image& image : loaded) {
+        if (!image.pixels.empty() && image.pixels != image.reference) {
+            std::cout << "  " << image.path << " decoded differently from stb_image with every image at once" << std::endl;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,409 @@
+#include "PngDecoder.h"
+
+#include "stb_image.h"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+static const unsigned char SIGNATURE[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+static const unsigned char FINAL_BLOCK[5] = { 0x01, 0x00, 0x00, 0xFF, 0xFF }; // an empty stored block with BFINAL set, ends a cut off piece
+static const size_t MIN_SEGMENT = 64 << 10; // compressed bytes, smaller pieces aren't worth a job
+static const unsigned int ADLER_BASE = 65521;
+
+static unsigned int readBigEndian(const unsigned char* bytes) {
+    return ((unsigned int)bytes[0] << 24) | ((unsigned int)bytes[1] << 16) | ((unsigned int)bytes[2] << 8) | bytes[3];
+}
+
+static unsigned int adler32(const unsigned char* data, size_t size) {
+    unsigned int a = 1, b = 0;
+    while (size > 0) {
+        size_t block = std::min(size, (size_t)5552); // the most bytes before b can overflow 32 bits
+        for (size_t i = 0; i < block; i++) {
+            a += data[i];
+            b += a;
+        }
+        a %= ADLER_BASE;
+        b %= ADLER_BASE;
+        data += block;
+        size -= block;
+    }
+    return (b << 16) | a;
+}
+
+// the checksum of two pieces back to back from the checksums of each, the same sums zlib's adler32_combine does
+static unsigned int adler32Combine(unsigned int first, unsigned int second, size_t secondSize) {
+    unsigned int remainder = (unsigned int)(secondSize % ADLER_BASE);
+    unsigned int a = first & 0xFFFF;
+    unsigned int b = (unsigned int)(((unsigned long long)remainder * a) % ADLER_BASE);
+    a += (second & 0xFFFF) + ADLER_BASE - 1;
+    b += (first >> 16) + (second >> 16) + ADLER_BASE - remainder;
+    if (a >= ADLER_BASE) a -= ADLER_BASE;
+    if (a >= ADLER_BASE) a -= ADLER_BASE;
+    if (b >= 2 * ADLER_BASE) b -= 2 * ADLER_BASE;
+    if (b >= ADLER_BASE) b -= ADLER_BASE;
+    return (b << 16) | a;
+}
+
+static unsigned char paeth(int a, int b, int c) {
+    int p = a + b - c;
+    int pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc) {
+        return (unsigned char)a;
+    }
+    else if (pb <= pc) {
+        return (unsigned char)b;
+    }
+    return (unsigned char)c;
+}
+
+PngDecoder::PngDecoder() : width(0), height(0), colorType(0), channels(0), hasKey(false), key(), stats() {
+}
+
+bool PngDecoder::Open(const std::string& path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        return false;
+    }
+    std::vector<unsigned char> data((size_t)file.tellg());
+    file.seekg(0);
+    if (!file.read((char*)data.data(), data.size())) {
+        return false;
+    }
+    return parse(data.data(), data.size());
+}
+
+bool PngDecoder::Open(const unsigned char* data, size_t size) {
+    return parse(data, size);
+}
+
+// walks the chunks, anything stb_image would read differently (16 bit, interlaced, Apple's CgBI) is turned down
+bool PngDecoder::parse(const unsigned char* data, size_t size) {
+    stream.clear();
+    flushes.clear();
+    palette.assign(256 * 4, 0);
+    width = height = 0;
+    hasKey = false;
+    if (size < 8 || std::memcmp(data, SIGNATURE, 8) != 0) {
+        return false;
+    }
+    unsigned int paletteSize = 0;
+    size_t position = 8;
+    while (true) {
+        if (size - position < 12) {
+            return false; // no IEND
+        }
+        unsigned int length = readBigEndian(data + position);
+        const unsigned char* type = data + position + 4;
+        const unsigned char* chunk = data + position + 8;
+        if (length > size - position - 12) {
+            return false;
+        }
+        position += 12 + (size_t)length;
+
+        if (std::memcmp(type, "IHDR", 4) == 0) {
+            if (length != 13) {
+                return false;
+            }
+            width = readBigEndian(chunk);
+            height = readBigEndian(chunk + 4);
+            colorType = chunk[9];
+            // depth, compression, filter method, interlace
+            if (width == 0 || height == 0 || width > (1u << 24) || height > (1u << 24) || chunk[8] != 8 || chunk[10] != 0 || chunk[11] != 0 || chunk[12] != 0) {
+                return false;
+            }
+            switch (colorType) {
+            case 0: channels = 1; break;
+            case 2: channels = 3; break;
+            case 3: channels = 1; break;
+            case 4: channels = 2; break;
+            case 6: channels = 4; break;
+            default: return false;
+            }
+            // the RGBA result and the filtered rows both have to fit an int, the same limit stb_image puts on its buffers,
+            // so a header claiming a huge image is turned down here instead of failing an allocation inside a job
+            if ((unsigned long long)width * height * 4 > INT_MAX || (unsigned long long)height * ((unsigned long long)width * channels + 1) > INT_MAX) {
+                return false;
+            }
+        }
+        else if (width == 0) {
+            return false; // IHDR has to come first
+        }
+        else if (std::memcmp(type, "PLTE", 4) == 0) {
+            if (length % 3 != 0 || length / 3 > 256) {
+                return false;
+            }
+            paletteSize = length / 3;
+            for (unsigned int i = 0; i < paletteSize; i++) {
+                palette[i * 4 + 0] = chunk[i * 3 + 0];
+                palette[i * 4 + 1] = chunk[i * 3 + 1];
+                palette[i * 4 + 2] = chunk[i * 3 + 2];
+                palette[i * 4 + 3] = 255;
+            }
+        }
+        else if (std::memcmp(type, "tRNS", 4) == 0) {
+            if (colorType == 3) {
+                if (paletteSize == 0 || length > paletteSize) {
+                    return false;
+                }
+                for (unsigned int i = 0; i < length; i++) {
+                    palette[i * 4 + 3] = chunk[i];
+                }
+            }
+            else if (colorType == 0 || colorType == 2) {
+                if (length != channels * 2) {
+                    return false;
+                }
+                // 16 bit samples, stb_image compares against the low byte at depth 8
+                for (unsigned int c = 0; c < channels; c++) {
+                    key[c] = chunk[c * 2 + 1];
+                }
+                hasKey = true;
+            }
+            else {
+                return false; // the image has alpha already
+            }
+        }
+        else if (std::memcmp(type, "IDAT", 4) == 0) {
+            stream.insert(stream.end(), chunk, chunk + length);
+        }
+        else if (std::memcmp(type, "IEND", 4) == 0) {
+            break;
+        }
+        else if ((type[0] & 0x20) == 0) {
+            return false; // an unknown chunk marked critical
+        }
+    }
+    if (stream.size() < 6 || (colorType == 3 && paletteSize == 0)) {
+        return false;
+    }
+    // full flush points, zlib header and Adler-32 trailer left out
+    for (size_t i = 2; i + 4 + 4 <= stream.size(); i++) {
+        if (stream[i] == 0x00 && stream[i + 1] == 0x00 && stream[i + 2] == 0xFF && stream[i + 3] == 0xFF) {
+            flushes.push_back(i + 4);
+        }
+    }
+    return true;
+}
+
+unsigned int PngDecoder::Width() const {
+    return width;
+}
+
+unsigned int PngDecoder::Height() const {
+    return height;
+}
+
+size_t PngDecoder::DecodedSize() const {
+    return (size_t)width * height * 4;
+}
+
+// inflates into filtered, which has to come out exactly filteredSize bytes
+bool PngDecoder::inflateStream(unsigned char* filtered, size_t filteredSize, JobSystem& jobs) {
+    // the raw deflate data sits between the 2 byte zlib header and the checksum
+    size_t deflateBegin = 2, deflateEnd = stream.size() - 4;
+    unsigned int header = stream[0] * 256u + stream[1];
+    bool plainHeader = header % 31 == 0 && (stream[0] & 15) == 8 && (stream[1] & 32) == 0;
+
+    // cut at the flush points nearest to equal shares of the compressed data
+    std::vector<size_t> cuts(1, deflateBegin);
+    unsigned int pieces = (unsigned int)std::min<size_t>(jobs.WorkerCount(), (deflateEnd - deflateBegin) / MIN_SEGMENT);
+    if (plainHeader && filteredSize < (size_t)0x7FFFFFFF) {
+        for (unsigned int i = 1; i < pieces && !flushes.empty(); i++) {
+            size_t target = deflateBegin + (deflateEnd - deflateBegin) * i / pieces;
+            std::vector<size_t>::const_iterator above = std::lower_bound(flushes.begin(), flushes.end(), target);
+            size_t cut;
+            if (above == flushes.end()) {
+                cut = flushes.back();
+            }
+            else if (above != flushes.begin() && target - *(above - 1) < *above - target) {
+                cut = *(above - 1);
+            }
+            else {
+                cut = *above;
+            }
+            if (cut > cuts.back() && cut < deflateEnd) {
+                cuts.push_back(cut);
+            }
+        }
+    }
+    stats.segments = (unsigned int)cuts.size();
+
+    if (cuts.size() > 1) {
+        // the last piece keeps the checksum after it, stb_image reads a little past the final block the same as in one go
+        cuts.push_back(stream.size());
+        unsigned int segments = (unsigned int)cuts.size() - 1;
+        std::vector<char*> outputs(segments, nullptr);
+        std::vector<int> outputSizes(segments, -1);
+        std::vector<unsigned int> checksums(segments, 0);
+        jobs.ParallelFor(segments, 1, [&](unsigned int begin, unsigned int end, unsigned int) {
+            for (unsigned int s = begin; s < end; s++) {
+                std::vector<unsigned char> piece(stream.begin() + cuts[s], stream.begin() + cuts[s + 1]);
+                if (s + 1 < segments) {
+                    piece.insert(piece.end(), FINAL_BLOCK, FINAL_BLOCK + sizeof(FINAL_BLOCK));
+                }
+                // a piece reaching back into the one before fails here, stb_image checks every distance against what it has written
+                outputs[s] = stbi_zlib_decode_noheader_malloc((const char*)piece.data(), (int)piece.size(), &outputSizes[s]);
+                if (outputs[s] != nullptr) {
+                    checksums[s] = adler32((const unsigned char*)outputs[s], outputSizes[s]);
+                }
+            }
+        });
+        // a 00 00 FF FF in the middle of compressed data looks like a flush too, the checksum over the joined pieces catches that
+        bool joined = true;
+        std::vector<size_t> offsets(1, 0);
+        unsigned int checksum = 1;
+        for (unsigned int s = 0; s < segments && joined; s++) {
+            joined = outputs[s] != nullptr && offsets.back() + outputSizes[s] <= filteredSize;
+            if (joined) {
+                checksum = adler32Combine(checksum, checksums[s], outputSizes[s]);
+                offsets.push_back(offsets.back() + outputSizes[s]);
+            }
+        }
+        joined = joined && offsets.back() == filteredSize && checksum == readBigEndian(&stream[deflateEnd]);
+        if (joined) {
+            jobs.ParallelFor(segments, 1, [&](unsigned int begin, unsigned int end, unsigned int) {
+                for (unsigned int s = begin; s < end; s++) {
+                    std::memcpy(filtered + offsets[s], outputs[s], outputSizes[s]);
+                }
+            });
+        }
+        for (char* output : outputs) {
+            free(output);
+        }
+        if (joined) {
+            return true;
+        }
+        stats.segments = 1;
+    }
+    // one stream, or cuts that didn't hold
+    if (filteredSize > (size_t)0x7FFFFFFF) {
+        return false;
+    }
+    int written = stbi_zlib_decode_buffer((char*)filtered, (int)filteredSize, (const char*)stream.data(), (int)stream.size());
+    return written == (int)filteredSize;
+}
+
+// rows [firstRow, endRow), firstRow is 0 or filtered with None or Sub so the row above it isn't needed
+bool PngDecoder::unfilterRows(const unsigned char* filtered, unsigned int firstRow, unsigned int endRow, unsigned char* rgba) const {
+    size_t rowBytes = (size_t)width * channels;
+    size_t stride = rowBytes + 1;
+    std::vector<unsigned char> prior(rowBytes, 0), current(rowBytes), expanded(colorType == 6 ? 0 : (size_t)width * 4);
+    for (unsigned int row = firstRow; row < endRow; row++) {
+        const unsigned char* raw = filtered + row * stride + 1;
+        unsigned char* out = current.data();
+        switch (raw[-1]) {
+        case 0:
+            std::memcpy(out, raw, rowBytes);
+            break;
+        case 1:
+            std::memcpy(out, raw, channels);
+            for (size_t i = channels; i < rowBytes; i++) {
+                out[i] = (unsigned char)(raw[i] + out[i - channels]);
+            }
+            break;
+        case 2:
+            for (size_t i = 0; i < rowBytes; i++) {
+                out[i] = (unsigned char)(raw[i] + prior[i]);
+            }
+            break;
+        case 3:
+            for (size_t i = 0; i < channels; i++) {
+                out[i] = (unsigned char)(raw[i] + (prior[i] >> 1));
+            }
+            for (size_t i = channels; i < rowBytes; i++) {
+                out[i] = (unsigned char)(raw[i] + ((out[i - channels] + prior[i]) >> 1));
+            }
+            break;
+        case 4:
+            for (size_t i = 0; i < channels; i++) {
+                out[i] = (unsigned char)(raw[i] + prior[i]); // paeth of 0, b, 0 is b
+            }
+            for (size_t i = channels; i < rowBytes; i++) {
+                out[i] = (unsigned char)(raw[i] + paeth(out[i - channels], prior[i], prior[i - channels]));
+            }
+            break;
+        default:
+            return false;
+        }
+
+        // the whole row goes out in one copy, so a write combined destination sees full lines
+        unsigned char* destination = rgba + (size_t)row * width * 4;
+        if (colorType == 6) {
+            std::memcpy(destination, out, rowBytes);
+        }
+        else {
+            unsigned char* pixel = expanded.data();
+            for (unsigned int x = 0; x < width; x++, pixel += 4) {
+                switch (colorType) {
+                case 0:
+                    pixel[0] = pixel[1] = pixel[2] = out[x];
+                    pixel[3] = hasKey && out[x] == key[0] ? 0 : 255;
+                    break;
+                case 2:
+                    pixel[0] = out[x * 3 + 0];
+                    pixel[1] = out[x * 3 + 1];
+                    pixel[2] = out[x * 3 + 2];
+                    pixel[3] = hasKey && pixel[0] == key[0] && pixel[1] == key[1] && pixel[2] == key[2] ? 0 : 255;
+                    break;
+                case 3:
+                    std::memcpy(pixel, &palette[out[x] * 4], 4);
+                    break;
+                case 4:
+                    pixel[0] = pixel[1] = pixel[2] = out[x * 2 + 0];
+                    pixel[3] = out[x * 2 + 1];
+                    break;
+                }
+            }
+            std::memcpy(destination, expanded.data(), expanded.size());
+        }
+        prior.swap(current);
+    }
+    return true;
+}
+
+bool PngDecoder::Decode(unsigned char* rgba, JobSystem& jobs) {
+    stats = PngDecodeStats();
+    if (width == 0) {
+        return false;
+    }
+    size_t stride = (size_t)width * channels + 1;
+    std::vector<unsigned char> filtered((size_t)height * stride);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    if (!inflateStream(filtered.data(), filtered.size(), jobs)) {
+        return false;
+    }
+    std::chrono::steady_clock::time_point inflated = std::chrono::steady_clock::now();
+
+    // every row filtered with None or Sub starts a chain that can be unfiltered without the rows above
+    std::vector<unsigned int> chainStarts(1, 0);
+    for (unsigned int row = 1; row < height; row++) {
+        if (filtered[row * stride] <= 1) {
+            chainStarts.push_back(row);
+        }
+    }
+    chainStarts.push_back(height);
+    unsigned int chains = (unsigned int)chainStarts.size() - 1;
+    stats.chains = chains;
+    // a few chunks per worker, each a handful of whole chains
+    unsigned int grain = std::max(1u, chains / (jobs.WorkerCount() * 4));
+    std::atomic<bool> valid(true);
+    jobs.ParallelFor(chains, grain, [&](unsigned int begin, unsigned int end, unsigned int) {
+        if (!unfilterRows(filtered.data(), chainStarts[begin], chainStarts[end], rgba)) {
+            valid.store(false, std::memory_order_relaxed);
+        }
+    });
+    std::chrono::steady_clock::time_point unfiltered = std::chrono::steady_clock::now();
+
+    stats.inflateMs = std::chrono::duration<double, std::milli>(inflated - start).count();
+    stats.unfilterMs = std::chrono::duration<double, std::milli>(unfiltered - inflated).count();
+    return valid.load();
+}
+
+PngDecodeStats PngDecoder::Stats() const {
+    return stats;
+}
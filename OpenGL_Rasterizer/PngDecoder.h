@@ -0,0 +1,55 @@
+#ifndef PNG_DECODER_H
+#define PNG_DECODER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "JobSystem.h"
+
+// numbers from the last Decode, for the benchmark
+struct PngDecodeStats {
+    unsigned int segments; // pieces of the zlib stream inflated in parallel, 1 unless the encoder full flushed
+    unsigned int chains; // runs of rows unfiltered in parallel
+    double inflateMs;
+    double unfilterMs; // unfiltering and expanding to RGBA
+};
+
+// decodes a PNG straight into memory the caller provides, as RGBA8 rows top to bottom like stbi_load(..., 4) gives them
+// within one image two things run on the job system:
+// - inflating: a zlib stream the encoder full flushed (an empty stored block, 00 00 FF FF, with the window reset) can be cut there
+//   and every piece inflated on its own, the cuts are checked by decoding, a piece that reaches back past its start fails and
+//   the whole stream is inflated in one go instead
+// - unfiltering: a row filtered with None or Sub doesn't read the row above it, so the image is cut into runs of rows that
+//   each start on such a row, and the runs are unfiltered in parallel
+// the destination is only ever written, a row at a time front to back, so it can be write combined memory from glMapBufferRange
+// 8 bit gray, gray alpha, RGB, RGBA and palette images without interlacing, the rest is left to stb_image
+class PngDecoder {
+private:
+    std::vector<unsigned char> stream; // the IDAT chunks' zlib stream joined
+    std::vector<unsigned char> palette; // RGBA, 256 entries
+    std::vector<size_t> flushes; // offsets into stream just past each 00 00 FF FF, candidate cuts
+    unsigned int width, height;
+    unsigned int colorType;
+    unsigned int channels; // samples per pixel in the file
+    bool hasKey; // tRNS color key for gray and RGB
+    unsigned char key[3];
+    PngDecodeStats stats;
+
+    bool parse(const unsigned char* data, size_t size);
+    bool inflateStream(unsigned char* filtered, size_t filteredSize, JobSystem& jobs);
+    bool unfilterRows(const unsigned char* filtered, unsigned int firstRow, unsigned int endRow, unsigned char* rgba) const;
+public:
+    PngDecoder(); // constructor
+
+    // methods
+    bool Open(const std::string& path); // reads and parses the file, false if it isn't a PNG this decoder handles
+    bool Open(const unsigned char* data, size_t size); // same from memory, the data is copied
+    unsigned int Width() const;
+    unsigned int Height() const;
+    size_t DecodedSize() const; // bytes Decode writes, Width() * Height() * 4
+    bool Decode(unsigned char* rgba, JobSystem& jobs); // rgba has DecodedSize() bytes, false if the data is corrupt
+    PngDecodeStats Stats() const;
+};
+
+#endif
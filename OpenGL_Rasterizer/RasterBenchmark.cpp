@@ -0,0 +1,226 @@
+// microbenchmark for the software raster kernels, built as its own console program by RasterBenchmark.vcxproj
+// random triangles of three sizes are set up and depth tested into a tiled depth buffer with every kernel set this CPU supports,
+// and setup + rasterization throughput is printed in Mtri/s and Mpix/s alongside the attribute interpolation rate
+// before that it checks the CPU occlusion buffer on a fixed scene, since that needs no GPU either, and exits with -1 if it's wrong
+#include "OcclusionBuffer.h"
+#include "RasterKernels.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+static const unsigned int TARGET_SIZE = 1024; // pixels, square
+static const unsigned int TARGET_TILES = TARGET_SIZE / RASTER_TILE_SIZE;
+
+// one size class of test triangles
+struct TriangleSet {
+    const char* name;
+    float radius; // vertices lie this far from the centre in pixels
+    std::vector<glm::vec3> vertices; // three per triangle
+};
+
+struct RunResult {
+    double setupMs;
+    double rasterMs;
+    double interpolateMs;
+    unsigned long long pixels; // pixels that passed the depth test, every one does since depth keeps decreasing
+    unsigned long long interpolated; // pixels run through the interpolation kernel
+};
+
+// triangles scattered over the target with random orientation, each one nearer than the last
+static void generateTriangles(TriangleSet& set, unsigned int count, std::mt19937& random) {
+    std::uniform_real_distribution<float> centre(0.0f, (float)TARGET_SIZE);
+    std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+    set.vertices.resize((size_t)count * 3);
+    for (unsigned int i = 0; i < count; i++) {
+        float x = centre(random), y = centre(random), start = angle(random);
+        float depth = 1.0f - (float)(i + 1) / (float)(count + 1);
+        for (unsigned int v = 0; v < 3; v++) {
+            float a = start + (float)v * 2.0943951f; // 120 degrees apart
+            set.vertices[(size_t)i * 3 + v] = glm::vec3(x + std::cos(a) * set.radius, y + std::sin(a) * set.radius, depth);
+        }
+    }
+}
+
+static RunResult run(const TriangleSet& set, const RasterKernels& kernels, std::vector<RasterTriangle>& triangles, std::vector<float>& depth, std::vector<unsigned int>& ids) {
+    RunResult result = RunResult();
+    unsigned int count = (unsigned int)(set.vertices.size() / 3);
+    std::fill(depth.begin(), depth.end(), 1.0f);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    triangles.clear();
+    for (unsigned int i = 0; i < count; i++) {
+        RasterTriangle triangle;
+        unsigned int order[3];
+        if (SetupRasterTriangle(&set.vertices[(size_t)i * 3], TARGET_SIZE, TARGET_SIZE, triangle, order)) {
+            triangles.push_back(triangle);
+        }
+    }
+    std::chrono::steady_clock::time_point setupEnd = std::chrono::steady_clock::now();
+
+    // straight to the tiles instead of binning first, tiles the edges miss are rejected the same way SoftwareRenderer's binning does
+    for (unsigned int i = 0; i < triangles.size(); i++) {
+        const RasterTriangle& triangle = triangles[i];
+        for (unsigned int tileY = triangle.minY / RASTER_TILE_SIZE; tileY <= triangle.maxY / RASTER_TILE_SIZE; tileY++) {
+            for (unsigned int tileX = triangle.minX / RASTER_TILE_SIZE; tileX <= triangle.maxX / RASTER_TILE_SIZE; tileX++) {
+                int x0 = (int)(tileX * RASTER_TILE_SIZE), y0 = (int)(tileY * RASTER_TILE_SIZE);
+                if (!TriangleOverlapsRect(triangle, x0, y0, x0 + (int)RASTER_TILE_SIZE - 1, y0 + (int)RASTER_TILE_SIZE - 1)) {
+                    continue;
+                }
+                size_t tile = ((size_t)tileY * TARGET_TILES + tileX) * RASTER_TILE_SIZE * RASTER_TILE_SIZE;
+                result.pixels += kernels.rasterize(triangle, x0, y0, RASTER_TILE_SIZE, RASTER_TILE_SIZE, &depth[tile], &ids[tile], i);
+            }
+        }
+    }
+    std::chrono::steady_clock::time_point rasterEnd = std::chrono::steady_clock::now();
+
+    // every block row span of each triangle's bounds, the planes are set up outside the timing since only the kernel is measured
+    AttributePlanes planes;
+    float values[3][ATTRIBUTE_PLANES];
+    for (unsigned int v = 0; v < 3; v++) {
+        for (unsigned int k = 0; k < ATTRIBUTE_PLANES; k++) {
+            values[v][k] = 1.0f + (float)(v * ATTRIBUTE_PLANES + k) * 0.1f;
+        }
+    }
+    PixelAttributes attributes;
+    float checksum = 0.0f;
+    std::chrono::steady_clock::duration interpolateTime = std::chrono::steady_clock::duration::zero();
+    for (const RasterTriangle& triangle : triangles) {
+        SetupAttributePlanes(triangle, values, planes);
+        std::chrono::steady_clock::time_point interpolateStart = std::chrono::steady_clock::now();
+        for (int y = triangle.minY; y <= triangle.maxY; y++) {
+            for (int x = triangle.minX & ~7; x <= triangle.maxX; x += RASTER_BLOCK_SIZE) {
+                kernels.interpolate(triangle, planes, x, y, attributes);
+                checksum += attributes.uv[0][0];
+                result.interpolated += RASTER_BLOCK_SIZE;
+            }
+        }
+        interpolateTime += std::chrono::steady_clock::now() - interpolateStart;
+    }
+    if (checksum == 1.0e30f) {
+        std::cout << checksum << std::endl; // keeps the interpolation from being optimized away
+    }
+
+    result.setupMs = std::chrono::duration<double, std::milli>(setupEnd - start).count();
+    result.rasterMs = std::chrono::duration<double, std::milli>(rasterEnd - setupEnd).count();
+    result.interpolateMs = std::chrono::duration<double, std::milli>(interpolateTime).count();
+    return result;
+}
+
+// a 4x4 wall in front of the camera has to hide a box straight behind it and leave one off to the side visible
+static bool checkOcclusion() {
+    const std::vector<float> wall = { -2.0f, -2.0f, 0.0f, 2.0f, -2.0f, 0.0f, 2.0f, 2.0f, 0.0f, -2.0f, 2.0f, 0.0f };
+    const std::vector<unsigned int> wallIndices = { 0, 1, 2, 0, 2, 3 };
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 0.0f, 5.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 projection = glm::perspective(glm::radians(60.0f), 2.0f, 0.1f, 100.0f);
+
+    OcclusionBuffer buffer;
+    buffer.Begin(projection * view);
+    buffer.RasterizeOccluder(wall, wallIndices, glm::mat4(1.0f));
+    buffer.BuildHierarchy();
+    // the wall's shadow at z = -3 reaches x = 3.2, the second box sits at 4.5 to 5.5
+    BoundingBox behind = { glm::vec3(0.0f, 0.0f, -3.0f), glm::vec3(0.5f) };
+    BoundingBox beside = { glm::vec3(5.0f, 0.0f, -3.0f), glm::vec3(0.5f) };
+    bool passed = true;
+    if (buffer.IsVisible(behind)) {
+        std::cout << "Occlusion buffer check failed: a box behind the wall was reported visible" << std::endl;
+        passed = false;
+    }
+    if (!buffer.IsVisible(beside)) {
+        std::cout << "Occlusion buffer check failed: a box beside the wall was reported hidden" << std::endl;
+        passed = false;
+    }
+    return passed;
+}
+
+int main(int argc, char** argv) {
+    unsigned int count = 200000;
+    unsigned int repeats = 5;
+    std::vector<RasterIsa> isas;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--triangles" && i + 1 < argc) {
+            count = (unsigned int)std::max(std::atoi(argv[++i]), 1);
+        }
+        else if (arg == "--repeat" && i + 1 < argc) {
+            repeats = (unsigned int)std::max(std::atoi(argv[++i]), 1);
+        }
+        else if (arg == "--isa" && i + 1 < argc) {
+            RasterIsa isa;
+            if (!ParseRasterIsa(argv[++i], isa) || !RasterIsaSupported(isa)) {
+                std::cout << "Unsupported raster kernels " << argv[i] << std::endl;
+                return -1;
+            }
+            isas.push_back(isa);
+        }
+        else {
+            std::cout << "Usage: " << argv[0] << " [--triangles N] [--repeat N] [--isa scalar|sse4|avx2|avx512]..." << std::endl;
+            return -1;
+        }
+    }
+    if (isas.empty()) {
+        const RasterIsa all[] = { RASTER_SCALAR, RASTER_SSE41, RASTER_AVX2, RASTER_AVX512 };
+        for (RasterIsa isa : all) {
+            if (RasterIsaSupported(isa)) {
+                isas.push_back(isa);
+            }
+        }
+    }
+
+    if (!checkOcclusion()) {
+        return -1;
+    }
+    std::cout << "Occlusion buffer check passed" << std::endl;
+
+    TriangleSet sets[3] = { { "small", 4.0f, {} }, { "medium", 16.0f, {} }, { "large", 64.0f, {} } };
+    std::mt19937 random(592);
+    for (TriangleSet& set : sets) {
+        // fewer of the bigger ones so every size class takes a similar time
+        generateTriangles(set, std::max(count / (unsigned int)(set.radius * set.radius / 16.0f), 1u), random);
+    }
+    std::vector<RasterTriangle> triangles;
+    std::vector<float> depth((size_t)TARGET_SIZE * TARGET_SIZE);
+    std::vector<unsigned int> ids((size_t)TARGET_SIZE * TARGET_SIZE);
+
+    std::cout << "Raster kernels, " << TARGET_SIZE << "x" << TARGET_SIZE << " target, best of " << repeats << " runs, widest supported: " << RasterIsaName(BestRasterIsa()) << std::endl;
+    for (TriangleSet& set : sets) {
+        unsigned long long reference = 0;
+        for (RasterIsa isa : isas) {
+            RasterKernels kernels = GetRasterKernels(isa);
+            RunResult best = RunResult();
+            for (unsigned int repeat = 0; repeat < repeats; repeat++) {
+                RunResult result = run(set, kernels, triangles, depth, ids);
+                if (repeat == 0 || result.setupMs + result.rasterMs < best.setupMs + best.rasterMs) {
+                    best.setupMs = result.setupMs;
+                    best.rasterMs = result.rasterMs;
+                    best.pixels = result.pixels;
+                }
+                if (repeat == 0 || result.interpolateMs < best.interpolateMs) {
+                    best.interpolateMs = result.interpolateMs;
+                    best.interpolated = result.interpolated;
+                }
+            }
+            double triangleCount = (double)(set.vertices.size() / 3);
+            std::cout << "  " << set.name << " (r " << set.radius << " px)  " << RasterIsaName(isa)
+                << "  setup " << triangleCount / (best.setupMs * 1000.0) << " Mtri/s"
+                << "  raster " << triangleCount / ((best.setupMs + best.rasterMs) * 1000.0) << " Mtri/s, "
+                << (double)best.pixels / (best.rasterMs * 1000.0) << " Mpix/s"
+                << "  interpolate " << (double)best.interpolated / (best.interpolateMs * 1000.0) << " Mpix/s" << std::endl;
+            // every kernel set has to cover exactly the same pixels
+            if (reference == 0) {
+                reference = best.pixels;
+            }
+            else if (best.pixels != reference) {
+                std::cout << "  " << RasterIsaName(isa) << " wrote " << best.pixels << " pixels, expected " << reference << std::endl;
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,539 @@
+#include "RasterKernels.h"
+
+#include <algorithm>
+#include <cmath>
+
+// every kernel is compiled into the same binary whatever the compiler flags, and the CPU is asked at runtime which ones it can run
+// gcc and clang need the instruction set on each function, msvc allows any intrinsic anywhere
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define RASTER_X86
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define RASTER_TARGET(isa)
+#else
+#define RASTER_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+// gcc and clang would otherwise fuse the edge function's multiply and add into an fma wherever the target allows it,
+// which moves pixels sitting exactly on an edge between kernel sets (msvc only contracts under /fp:contract)
+#if defined(__clang__)
+#pragma clang fp contract(off)
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+namespace {
+
+enum BlockCoverage {
+    BLOCK_OUTSIDE,
+    BLOCK_PARTIAL, // some pixels may be outside, edges are tested per pixel
+    BLOCK_INSIDE // every pixel centre is strictly inside all three edges
+};
+
+// the edge functions are linear, so over a rectangle of pixel centres they peak at one corner and bottom out at the opposite one
+// the kernels evaluate them with a different operation order, so both answers keep a margin for rounding and stay conservative
+BlockCoverage classifyRect(const RasterTriangle& triangle, int minX, int minY, int maxX, int maxY) {
+    BlockCoverage coverage = BLOCK_INSIDE;
+    for (unsigned int i = 0; i < 3; i++) {
+        float a = triangle.edgeA[i], b = triangle.edgeB[i], c = triangle.edgeC[i];
+        float highX = (float)(a > 0.0f ? maxX : minX) + 0.5f, highY = (float)(b > 0.0f ? maxY : minY) + 0.5f;
+        float lowX = (float)(a > 0.0f ? minX : maxX) + 0.5f, lowY = (float)(b > 0.0f ? minY : maxY) + 0.5f;
+        float margin = (std::fabs(a) * std::max(std::fabs(highX), std::fabs(lowX)) + std::fabs(b) * std::max(std::fabs(highY), std::fabs(lowY)) + std::fabs(c)) * 1.0e-6f;
+        if (a * highX + b * highY + c < -margin) {
+            return BLOCK_OUTSIDE;
+        }
+        if (a * lowX + b * lowY + c <= margin) {
+            coverage = BLOCK_PARTIAL;
+        }
+    }
+    return coverage;
+}
+
+// the triangle's bounds inside the tile, false if they miss it
+bool tileBounds(const RasterTriangle& triangle, int tileX, int tileY, int width, int height, int& minX, int& minY, int& maxX, int& maxY) {
+    minX = std::max(triangle.minX - tileX, 0);
+    minY = std::max(triangle.minY - tileY, 0);
+    maxX = std::min(triangle.maxX - tileX, width - 1);
+    maxY = std::min(triangle.maxY - tileY, height - 1);
+    return minX <= maxX && minY <= maxY;
+}
+
+unsigned int countBits(unsigned int bits) {
+    bits = bits - ((bits >> 1) & 0x55555555u);
+    bits = (bits & 0x33333333u) + ((bits >> 2) & 0x33333333u);
+    return (((bits + (bits >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24;
+}
+
+unsigned int rasterizeScalar(const RasterTriangle& triangle, int tileX, int tileY, int width, int height, float* depth, unsigned int* ids, unsigned int id) {
+    int minX, minY, maxX, maxY;
+    if (!tileBounds(triangle, tileX, tileY, width, height, minX, minY, maxX, maxY)) {
+        return 0;
+    }
+    unsigned int written = 0;
+    for (int blockY = minY & ~7; blockY <= maxY; blockY += 8) {
+        for (int blockX = minX & ~7; blockX <= maxX; blockX += 8) {
+            int lastX = std::min(blockX + 7, width - 1), lastY = std::min(blockY + 7, height - 1);
+            BlockCoverage coverage = classifyRect(triangle, tileX + blockX, tileY + blockY, tileX + lastX, tileY + lastY);
+            if (coverage == BLOCK_OUTSIDE) {
+                continue;
+            }
+            unsigned int block = TilePixelIndex(blockX, blockY);
+            for (int y = blockY; y <= lastY; y++) {
+                float py = (float)(tileY + y) + 0.5f;
+                float edgeRow[3];
+                for (unsigned int i = 0; i < 3; i++) {
+                    edgeRow[i] = triangle.edgeB[i] * py + triangle.edgeC[i];
+                }
+                float depthRow = triangle.depth0 + triangle.depthDy * (py - triangle.refY);
+                for (int x = blockX; x <= lastX; x++) {
+                    float px = (float)(tileX + x) + 0.5f;
+                    if (coverage == BLOCK_PARTIAL) {
+                        bool inside = true;
+                        for (unsigned int i = 0; i < 3 && inside; i++) {
+                            float edge = triangle.edgeA[i] * px + edgeRow[i];
+                            inside = edge > 0.0f || (edge == 0.0f && triangle.includeEdge[i]);
+                        }
+                        if (!inside) {
+                            continue;
+                        }
+                    }
+                    float z = depthRow + triangle.depthDx * (px - triangle.refX);
+                    unsigned int pixel = block + (y - blockY) * 8 + (x - blockX);
+                    if (z < depth[pixel]) {
+                        depth[pixel] = z;
+                        ids[pixel] = id;
+                        written++;
+                    }
+                }
+            }
+        }
+    }
+    return written;
+}
+
+void interpolateScalar(const RasterTriangle& triangle, const AttributePlanes& planes, int x, int y, PixelAttributes& attributes) {
+    float dy = (float)y + 0.5f - triangle.refY;
+    for (unsigned int lane = 0; lane < RASTER_BLOCK_SIZE; lane++) {
+        float dx = (float)(x + (int)lane) + 0.5f - triangle.refX;
+        float plane[ATTRIBUTE_PLANES];
+        for (unsigned int k = 0; k < ATTRIBUTE_PLANES; k++) {
+            plane[k] = planes.value0[k] + planes.dx[k] * dx + planes.dy[k] * dy;
+        }
+        float w = 1.0f / plane[PLANE_INV_W];
+        for (unsigned int c = 0; c < 3; c++) {
+            attributes.position[c][lane] = plane[PLANE_POSITION + c] * w;
+            attributes.normal[c][lane] = plane[PLANE_NORMAL + c] * w;
+        }
+        float wRight = 1.0f / (plane[PLANE_INV_W] + planes.dx[PLANE_INV_W]);
+        float wUp = 1.0f / (plane[PLANE_INV_W] + planes.dy[PLANE_INV_W]);
+        for (unsigned int c = 0; c < 2; c++) {
+            float uv = plane[PLANE_UV + c] * w;
+            attributes.uv[c][lane] = uv;
+            attributes.uvDx[c][lane] = (plane[PLANE_UV + c] + planes.dx[PLANE_UV + c]) * wRight - uv;
+            attributes.uvDy[c][lane] = (plane[PLANE_UV + c] + planes.dy[PLANE_UV + c]) * wUp - uv;
+        }
+    }
+}
+
+#ifdef RASTER_X86
+// 4 pixels at a time, two registers per block row
+RASTER_TARGET("sse4.1")
+unsigned int rasterizeSse41(const RasterTriangle& triangle, int tileX, int tileY, int width, int height, float* depth, unsigned int* ids, unsigned int id) {
+    int minX, minY, maxX, maxY;
+    if (!tileBounds(triangle, tileX, tileY, width, height, minX, minY, maxX, maxY)) {
+        return 0;
+    }
+    const __m128 laneOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128i laneIndices = _mm_setr_epi32(0, 1, 2, 3);
+    __m128 edgeA[3], include[3];
+    for (unsigned int i = 0; i < 3; i++) {
+        edgeA[i] = _mm_set1_ps(triangle.edgeA[i]);
+        include[i] = _mm_castsi128_ps(_mm_set1_epi32(triangle.includeEdge[i] ? -1 : 0));
+    }
+    __m128 depthDx = _mm_set1_ps(triangle.depthDx);
+    __m128 refX = _mm_set1_ps(triangle.refX);
+    __m128 idVector = _mm_castsi128_ps(_mm_set1_epi32((int)id));
+    unsigned int written = 0;
+    for (int blockY = minY & ~7; blockY <= maxY; blockY += 8) {
+        for (int blockX = minX & ~7; blockX <= maxX; blockX += 8) {
+            int lastX = std::min(blockX + 7, width - 1), lastY = std::min(blockY + 7, height - 1);
+            BlockCoverage coverage = classifyRect(triangle, tileX + blockX, tileY + blockY, tileX + lastX, tileY + lastY);
+            if (coverage == BLOCK_OUTSIDE) {
+                continue;
+            }
+            // columns past the framebuffer's right edge in the last tile column
+            __m128 columns[2];
+            for (int half = 0; half < 2; half++) {
+                columns[half] = _mm_castsi128_ps(_mm_cmplt_epi32(laneIndices, _mm_set1_epi32(lastX - blockX - half * 4 + 1)));
+            }
+            unsigned int block = TilePixelIndex(blockX, blockY);
+            for (int y = blockY; y <= lastY; y++) {
+                float py = (float)(tileY + y) + 0.5f;
+                __m128 depthRow = _mm_set1_ps(triangle.depth0 + triangle.depthDy * (py - triangle.refY));
+                for (int half = 0; half < 2; half++) {
+                    __m128 px = _mm_add_ps(_mm_set1_ps((float)(tileX + blockX + half * 4)), laneOffsets);
+                    __m128 mask = columns[half];
+                    if (coverage == BLOCK_PARTIAL) {
+                        for (unsigned int i = 0; i < 3; i++) {
+                            __m128 edge = _mm_add_ps(_mm_mul_ps(edgeA[i], px), _mm_set1_ps(triangle.edgeB[i] * py + triangle.edgeC[i]));
+                            __m128 inside = _mm_or_ps(_mm_cmpgt_ps(edge, zero), _mm_and_ps(_mm_cmpeq_ps(edge, zero), include[i]));
+                            mask = _mm_and_ps(mask, inside);
+                        }
+                    }
+                    __m128 z = _mm_add_ps(depthRow, _mm_mul_ps(depthDx, _mm_sub_ps(px, refX)));
+                    unsigned int pixel = block + (y - blockY) * 8 + half * 4;
+                    __m128 stored = _mm_loadu_ps(depth + pixel);
+                    __m128 pass = _mm_and_ps(mask, _mm_cmplt_ps(z, stored));
+                    int bits = _mm_movemask_ps(pass);
+                    if (bits == 0) {
+                        continue;
+                    }
+                    _mm_storeu_ps(depth + pixel, _mm_blendv_ps(stored, z, pass));
+                    __m128 storedIds = _mm_loadu_ps(reinterpret_cast<const float*>(ids + pixel));
+                    _mm_storeu_ps(reinterpret_cast<float*>(ids + pixel), _mm_blendv_ps(storedIds, idVector, pass));
+                    written += countBits((unsigned int)bits);
+                }
+            }
+        }
+    }
+    return written;
+}
+
+RASTER_TARGET("sse4.1")
+void interpolateSse41(const RasterTriangle& triangle, const AttributePlanes& planes, int x, int y, PixelAttributes& attributes) {
+    const __m128 laneOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+    float dy = (float)y + 0.5f - triangle.refY;
+    for (int half = 0; half < 2; half++) {
+        __m128 dx = _mm_sub_ps(_mm_add_ps(_mm_set1_ps((float)(x + half * 4)), laneOffsets), _mm_set1_ps(triangle.refX));
+        __m128 plane[ATTRIBUTE_PLANES];
+        for (unsigned int k = 0; k < ATTRIBUTE_PLANES; k++) {
+            plane[k] = _mm_add_ps(_mm_set1_ps(planes.value0[k] + planes.dy[k] * dy), _mm_mul_ps(_mm_set1_ps(planes.dx[k]), dx));
+        }
+        __m128 one = _mm_set1_ps(1.0f);
+        __m128 w = _mm_div_ps(one, plane[PLANE_INV_W]);
+        for (unsigned int c = 0; c < 3; c++) {
+            _mm_storeu_ps(attributes.position[c] + half * 4, _mm_mul_ps(plane[PLANE_POSITION + c], w));
+            _mm_storeu_ps(attributes.normal[c] + half * 4, _mm_mul_ps(plane[PLANE_NORMAL + c], w));
+        }
+        __m128 wRight = _mm_div_ps(one, _mm_add_ps(plane[PLANE_INV_W], _mm_set1_ps(planes.dx[PLANE_INV_W])));
+        __m128 wUp = _mm_div_ps(one, _mm_add_ps(plane[PLANE_INV_W], _mm_set1_ps(planes.dy[PLANE_INV_W])));
+        for (unsigned int c = 0; c < 2; c++) {
+            __m128 uv = _mm_mul_ps(plane[PLANE_UV + c], w);
+            _mm_storeu_ps(attributes.uv[c] + half * 4, uv);
+            _mm_storeu_ps(attributes.uvDx[c] + half * 4, _mm_sub_ps(_mm_mul_ps(_mm_add_ps(plane[PLANE_UV + c], _mm_set1_ps(planes.dx[PLANE_UV + c])), wRight), uv));
+            _mm_storeu_ps(attributes.uvDy[c] + half * 4, _mm_sub_ps(_mm_mul_ps(_mm_add_ps(plane[PLANE_UV + c], _mm_set1_ps(planes.dy[PLANE_UV + c])), wUp), uv));
+        }
+    }
+}
+
+// a whole block row per register
+// coverage and depth use a separate multiply and add rather than fma so every kernel set rounds like the scalar one and covers exactly the same pixels
+RASTER_TARGET("avx2,fma")
+unsigned int rasterizeAvx2(const RasterTriangle& triangle, int tileX, int tileY, int width, int height, float* depth, unsigned int* ids, unsigned int id) {
+    int minX, minY, maxX, maxY;
+    if (!tileBounds(triangle, tileX, tileY, width, height, minX, minY, maxX, maxY)) {
+        return 0;
+    }
+    const __m256 laneOffsets = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256i laneIndices = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    __m256 edgeA[3], include[3];
+    for (unsigned int i = 0; i < 3; i++) {
+        edgeA[i] = _mm256_set1_ps(triangle.edgeA[i]);
+        include[i] = _mm256_castsi256_ps(_mm256_set1_epi32(triangle.includeEdge[i] ? -1 : 0));
+    }
+    __m256 depthDx = _mm256_set1_ps(triangle.depthDx);
+    __m256 refX = _mm256_set1_ps(triangle.refX);
+    __m256 idVector = _mm256_castsi256_ps(_mm256_set1_epi32((int)id));
+    unsigned int written = 0;
+    for (int blockY = minY & ~7; blockY <= maxY; blockY += 8) {
+        for (int blockX = minX & ~7; blockX <= maxX; blockX += 8) {
+            int lastX = std::min(blockX + 7, width - 1), lastY = std::min(blockY + 7, height - 1);
+            BlockCoverage coverage = classifyRect(triangle, tileX + blockX, tileY + blockY, tileX + lastX, tileY + lastY);
+            if (coverage == BLOCK_OUTSIDE) {
+                continue;
+            }
+            __m256 columns = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(lastX - blockX + 1), laneIndices));
+            __m256 px = _mm256_add_ps(_mm256_set1_ps((float)(tileX + blockX)), laneOffsets);
+            __m256 depthColumn = _mm256_mul_ps(depthDx, _mm256_sub_ps(px, refX));
+            unsigned int block = TilePixelIndex(blockX, blockY);
+            for (int y = blockY; y <= lastY; y++) {
+                float py = (float)(tileY + y) + 0.5f;
+                __m256 mask = columns;
+                if (coverage == BLOCK_PARTIAL) {
+                    for (unsigned int i = 0; i < 3; i++) {
+                        __m256 edge = _mm256_add_ps(_mm256_mul_ps(edgeA[i], px), _mm256_set1_ps(triangle.edgeB[i] * py + triangle.edgeC[i]));
+                        __m256 inside = _mm256_or_ps(_mm256_cmp_ps(edge, zero, _CMP_GT_OQ), _mm256_and_ps(_mm256_cmp_ps(edge, zero, _CMP_EQ_OQ), include[i]));
+                        mask = _mm256_and_ps(mask, inside);
+                    }
+                }
+                __m256 z = _mm256_add_ps(_mm256_set1_ps(triangle.depth0 + triangle.depthDy * (py - triangle.refY)), depthColumn);
+                unsigned int pixel = block + (y - blockY) * 8;
+                __m256 stored = _mm256_loadu_ps(depth + pixel);
+                __m256 pass = _mm256_and_ps(mask, _mm256_cmp_ps(z, stored, _CMP_LT_OQ));
+                int bits = _mm256_movemask_ps(pass);
+                if (bits == 0) {
+                    continue;
+                }
+                _mm256_storeu_ps(depth + pixel, _mm256_blendv_ps(stored, z, pass));
+                __m256 storedIds = _mm256_loadu_ps(reinterpret_cast<const float*>(ids + pixel));
+                _mm256_storeu_ps(reinterpret_cast<float*>(ids + pixel), _mm256_blendv_ps(storedIds, idVector, pass));
+                written += countBits((unsigned int)bits);
+            }
+        }
+    }
+    return written;
+}
+
+RASTER_TARGET("avx2,fma")
+void interpolateAvx2(const RasterTriangle& triangle, const AttributePlanes& planes, int x, int y, PixelAttributes& attributes) {
+    const __m256 laneOffsets = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+    float dy = (float)y + 0.5f - triangle.refY;
+    __m256 dx = _mm256_sub_ps(_mm256_add_ps(_mm256_set1_ps((float)x), laneOffsets), _mm256_set1_ps(triangle.refX));
+    __m256 plane[ATTRIBUTE_PLANES];
+    for (unsigned int k = 0; k < ATTRIBUTE_PLANES; k++) {
+        plane[k] = _mm256_fmadd_ps(_mm256_set1_ps(planes.dx[k]), dx, _mm256_set1_ps(planes.value0[k] + planes.dy[k] * dy));
+    }
+    __m256 one = _mm256_set1_ps(1.0f);
+    __m256 w = _mm256_div_ps(one, plane[PLANE_INV_W]);
+    for (unsigned int c = 0; c < 3; c++) {
+        _mm256_storeu_ps(attributes.position[c], _mm256_mul_ps(plane[PLANE_POSITION + c], w));
+        _mm256_storeu_ps(attributes.normal[c], _mm256_mul_ps(plane[PLANE_NORMAL + c], w));
+    }
+    __m256 wRight = _mm256_div_ps(one, _mm256_add_ps(plane[PLANE_INV_W], _mm256_set1_ps(planes.dx[PLANE_INV_W])));
+    __m256 wUp = _mm256_div_ps(one, _mm256_add_ps(plane[PLANE_INV_W], _mm256_set1_ps(planes.dy[PLANE_INV_W])));
+    for (unsigned int c = 0; c < 2; c++) {
+        __m256 uv = _mm256_mul_ps(plane[PLANE_UV + c], w);
+        _mm256_storeu_ps(attributes.uv[c], uv);
+        _mm256_storeu_ps(attributes.uvDx[c], _mm256_fmsub_ps(_mm256_add_ps(plane[PLANE_UV + c], _mm256_set1_ps(planes.dx[PLANE_UV + c])), wRight, uv));
+        _mm256_storeu_ps(attributes.uvDy[c], _mm256_fmsub_ps(_mm256_add_ps(plane[PLANE_UV + c], _mm256_set1_ps(planes.dy[PLANE_UV + c])), wUp, uv));
+    }
+}
+
+// two block rows per register, coverage and depth results live in mask registers
+RASTER_TARGET("avx512f")
+unsigned int rasterizeAvx512(const RasterTriangle& triangle, int tileX, int tileY, int width, int height, float* depth, unsigned int* ids, unsigned int id) {
+    int minX, minY, maxX, maxY;
+    if (!tileBounds(triangle, tileX, tileY, width, height, minX, minY, maxX, maxY)) {
+        return 0;
+    }
+    const __m512 laneColumns = _mm512_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f, 0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+    const __m512 laneRows = _mm512_setr_ps(0.5f, 0.5f, 0.5f, 0.5f, 0.5f, 0.5f, 0.5f, 0.5f, 1.5f, 1.5f, 1.5f, 1.5f, 1.5f, 1.5f, 1.5f, 1.5f);
+    const __m512 zero = _mm512_setzero_ps();
+    __m512 edgeA[3], edgeB[3], edgeC[3];
+    __mmask16 include[3];
+    for (unsigned int i = 0; i < 3; i++) {
+        edgeA[i] = _mm512_set1_ps(triangle.edgeA[i]);
+        edgeB[i] = _mm512_set1_ps(triangle.edgeB[i]);
+        edgeC[i] = _mm512_set1_ps(triangle.edgeC[i]);
+        include[i] = triangle.includeEdge[i] ? (__mmask16)0xFFFF : (__mmask16)0;
+    }
+    __m512 depthDx = _mm512_set1_ps(triangle.depthDx);
+    __m512 depthDy = _mm512_set1_ps(triangle.depthDy);
+    __m512 depth0 = _mm512_set1_ps(triangle.depth0);
+    __m512 refX = _mm512_set1_ps(triangle.refX);
+    __m512 refY = _mm512_set1_ps(triangle.refY);
+    __m512i idVector = _mm512_set1_epi32((int)id);
+    unsigned int written = 0;
+    for (int blockY = minY & ~7; blockY <= maxY; blockY += 8) {
+        for (int blockX = minX & ~7; blockX <= maxX; blockX += 8) {
+            int lastX = std::min(blockX + 7, width - 1), lastY = std::min(blockY + 7, height - 1);
+            BlockCoverage coverage = classifyRect(triangle, tileX + blockX, tileY + blockY, tileX + lastX, tileY + lastY);
+            if (coverage == BLOCK_OUTSIDE) {
+                continue;
+            }
+            unsigned int rowBits = (1u << (lastX - blockX + 1)) - 1;
+            __m512 px = _mm512_add_ps(_mm512_set1_ps((float)(tileX + blockX)), laneColumns);
+            __m512 depthColumn = _mm512_mul_ps(depthDx, _mm512_sub_ps(px, refX));
+            unsigned int block = TilePixelIndex(blockX, blockY);
+            for (int y = blockY; y <= lastY; y += 2) {
+                __mmask16 mask = (__mmask16)(rowBits | (y + 1 <= lastY ? rowBits << 8 : 0));
+                __m512 py = _mm512_add_ps(_mm512_set1_ps((float)(tileY + y)), laneRows);
+                if (coverage == BLOCK_PARTIAL) {
+                    for (unsigned int i = 0; i < 3; i++) {
+                        __m512 edge = _mm512_add_ps(_mm512_mul_ps(edgeA[i], px), _mm512_add_ps(_mm512_mul_ps(edgeB[i], py), edgeC[i]));
+                        __mmask16 inside = _mm512_cmp_ps_mask(edge, zero, _CMP_GT_OQ) | (_mm512_cmp_ps_mask(edge, zero, _CMP_EQ_OQ) & include[i]);
+                        mask &= inside;
+                    }
+                }
+                __m512 z = _mm512_add_ps(_mm512_add_ps(depth0, _mm512_mul_ps(depthDy, _mm512_sub_ps(py, refY))), depthColumn);
+                unsigned int pixel = block + (y - blockY) * 8;
+                __m512 stored = _mm512_loadu_ps(depth + pixel);
+                __mmask16 pass = _mm512_mask_cmp_ps_mask(mask, z, stored, _CMP_LT_OQ);
+                if (pass == 0) {
+                    continue;
+                }
+                _mm512_mask_storeu_ps(depth + pixel, pass, z);
+                _mm512_mask_storeu_epi32(ids + pixel, pass, idVector);
+                written += countBits((unsigned int)pass);
+            }
+        }
+    }
+    return written;
+}
+
+// which kernels the CPU has, and whether the OS saves the wider registers on a context switch
+bool cpuSupports(RasterIsa isa) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    int leaves = info[0];
+    __cpuid(info, 1);
+    bool sse41 = (info[2] & (1 << 19)) != 0;
+    bool fma = (info[2] & (1 << 12)) != 0;
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+    bool avx2 = false, avx512 = false;
+    if (leaves >= 7) {
+        __cpuidex(info, 7, 0);
+        avx2 = (info[1] & (1 << 5)) != 0;
+        avx512 = (info[1] & (1 << 16)) != 0;
+    }
+    bool ymmSaved = (xcr0 & 0x6) == 0x6;
+    bool zmmSaved = (xcr0 & 0xE6) == 0xE6;
+    switch (isa) {
+    case RASTER_SSE41:
+        return sse41;
+    case RASTER_AVX2:
+        return avx && avx2 && fma && ymmSaved;
+    case RASTER_AVX512:
+        return avx && avx2 && fma && avx512 && zmmSaved;
+    default:
+        return true;
+    }
+#else
+    // libgcc's checks already include the xgetbv test
+    __builtin_cpu_init();
+    switch (isa) {
+    case RASTER_SSE41:
+        return __builtin_cpu_supports("sse4.1");
+    case RASTER_AVX2:
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    case RASTER_AVX512:
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") && __builtin_cpu_supports("avx512f");
+    default:
+        return true;
+    }
+#endif
+}
+#else
+bool cpuSupports(RasterIsa isa) {
+    return isa == RASTER_SCALAR;
+}
+#endif
+
+}
+
+bool SetupRasterTriangle(const glm::vec3 screen[3], unsigned int width, unsigned int height, RasterTriangle& triangle, unsigned int order[3]) {
+    float x[3], y[3], z[3];
+    for (unsigned int i = 0; i < 3; i++) {
+        order[i] = i;
+        x[i] = screen[i].x;
+        y[i] = screen[i].y;
+        z[i] = screen[i].z;
+    }
+    float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+    if (!(area != 0.0f)) {
+        return false; // degenerate (or nan), covers no pixel centres
+    }
+    if (area < 0.0f) {
+        // nothing is back face culled (GL_CULL_FACE is never enabled), clockwise triangles are just flipped around
+        std::swap(order[1], order[2]);
+        std::swap(x[1], x[2]);
+        std::swap(y[1], y[2]);
+        std::swap(z[1], z[2]);
+        area = -area;
+    }
+    // the same formula from both sides of a shared edge gives exactly negated values, so no pixel is drawn twice or missed
+    for (unsigned int i = 0; i < 3; i++) {
+        unsigned int a = (i + 1) % 3, b = (i + 2) % 3;
+        triangle.edgeA[i] = y[a] - y[b];
+        triangle.edgeB[i] = x[b] - x[a];
+        triangle.edgeC[i] = x[a] * y[b] - y[a] * x[b];
+        triangle.includeEdge[i] = triangle.edgeA[i] > 0.0f || (triangle.edgeA[i] == 0.0f && triangle.edgeB[i] > 0.0f);
+    }
+    float minX = std::min(std::min(x[0], x[1]), x[2]), maxX = std::max(std::max(x[0], x[1]), x[2]);
+    float minY = std::min(std::min(y[0], y[1]), y[2]), maxY = std::max(std::max(y[0], y[1]), y[2]);
+    // pixel centres sit at + 0.5
+    triangle.minX = std::max((int)std::ceil(minX - 0.5f), 0);
+    triangle.minY = std::max((int)std::ceil(minY - 0.5f), 0);
+    triangle.maxX = std::min((int)std::floor(maxX - 0.5f), (int)width - 1);
+    triangle.maxY = std::min((int)std::floor(maxY - 0.5f), (int)height - 1);
+    if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY) {
+        return false;
+    }
+    triangle.invArea = 1.0f / area;
+    triangle.refX = x[0];
+    triangle.refY = y[0];
+    // window depth is affine in screen space, no perspective correction needed
+    triangle.depthDx = ((z[1] - z[0]) * triangle.edgeA[1] + (z[2] - z[0]) * triangle.edgeA[2]) * triangle.invArea;
+    triangle.depthDy = ((z[1] - z[0]) * triangle.edgeB[1] + (z[2] - z[0]) * triangle.edgeB[2]) * triangle.invArea;
+    triangle.depth0 = z[0];
+    return true;
+}
+
+void SetupAttributePlanes(const RasterTriangle& triangle, const float values[3][ATTRIBUTE_PLANES], AttributePlanes& planes) {
+    for (unsigned int k = 0; k < ATTRIBUTE_PLANES; k++) {
+        float delta1 = values[1][k] - values[0][k], delta2 = values[2][k] - values[0][k];
+        planes.dx[k] = (delta1 * triangle.edgeA[1] + delta2 * triangle.edgeA[2]) * triangle.invArea;
+        planes.dy[k] = (delta1 * triangle.edgeB[1] + delta2 * triangle.edgeB[2]) * triangle.invArea;
+        planes.value0[k] = values[0][k];
+    }
+}
+
+bool TriangleOverlapsRect(const RasterTriangle& triangle, int minX, int minY, int maxX, int maxY) {
+    return classifyRect(triangle, minX, minY, maxX, maxY) != BLOCK_OUTSIDE;
+}
+
+RasterIsa BestRasterIsa() {
+    static const RasterIsa best = RasterIsaSupported(RASTER_AVX512) ? RASTER_AVX512 : RasterIsaSupported(RASTER_AVX2) ? RASTER_AVX2
+        : RasterIsaSupported(RASTER_SSE41) ? RASTER_SSE41 : RASTER_SCALAR;
+    return best;
+}
+
+bool RasterIsaSupported(RasterIsa isa) {
+    return cpuSupports(isa);
+}
+
+const char* RasterIsaName(RasterIsa isa) {
+    switch (isa) {
+    case RASTER_SSE41:
+        return "sse4";
+    case RASTER_AVX2:
+        return "avx2";
+    case RASTER_AVX512:
+        return "avx512";
+    default:
+        return "scalar";
+    }
+}
+
+bool ParseRasterIsa(const std::string& name, RasterIsa& isa) {
+    const RasterIsa all[] = { RASTER_SCALAR, RASTER_SSE41, RASTER_AVX2, RASTER_AVX512 };
+    for (RasterIsa candidate : all) {
+        if (name == RasterIsaName(candidate)) {
+            isa = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+RasterKernels GetRasterKernels(RasterIsa isa) {
+    switch (isa) {
+#ifdef RASTER_X86
+    case RASTER_SSE41:
+        return { isa, rasterizeSse41, interpolateSse41 };
+    case RASTER_AVX2:
+        return { isa, rasterizeAvx2, interpolateAvx2 };
+    case RASTER_AVX512:
+        return { isa, rasterizeAvx512, interpolateAvx2 };
+#endif
+    default:
+        return { RASTER_SCALAR, rasterizeScalar, interpolateScalar };
+    }
+}
@@ -0,0 +1,85 @@
+#ifndef RASTER_KERNELS_H
+#define RASTER_KERNELS_H
+
+#include <glm/glm.hpp>
+
+#include <string>
+
+// the inner loops of the software renderer, written once per instruction set and picked at runtime
+// tiles are RASTER_TILE_SIZE pixels square and stored as 8x8 blocks of 64 pixels, rows inside a block contiguous,
+// so a block row is one AVX2 register, two SSE registers, and two rows are one AVX-512 register
+const unsigned int RASTER_TILE_SIZE = 64;
+const unsigned int RASTER_BLOCK_SIZE = 8;
+
+// offset of pixel (x, y) of a tile in the tile buffers
+inline unsigned int TilePixelIndex(unsigned int x, unsigned int y) {
+    return ((y / RASTER_BLOCK_SIZE) * (RASTER_TILE_SIZE / RASTER_BLOCK_SIZE) + x / RASTER_BLOCK_SIZE) * RASTER_BLOCK_SIZE * RASTER_BLOCK_SIZE
+        + (y % RASTER_BLOCK_SIZE) * RASTER_BLOCK_SIZE + x % RASTER_BLOCK_SIZE;
+}
+
+// a screen triangle after setup, counter clockwise with pixel centres at + 0.5 and the origin bottom left like GL
+struct RasterTriangle {
+    float edgeA[3], edgeB[3], edgeC[3]; // edge i is opposite vertex i, A * x + B * y + C is positive inside
+    bool includeEdge[3]; // top left rule, pixels exactly on the edge belong to this triangle
+    int minX, minY, maxX, maxY; // pixel bounds, clamped to the framebuffer
+    float invArea; // 1 / (A * x + B * y + C) of any edge at the opposite vertex
+    float refX, refY; // vertex 0, the planes below are relative to it to keep their precision
+    float depthDx, depthDy, depth0; // window depth = depth0 + depthDx * (x - refX) + depthDy * (y - refY)
+};
+
+// values over w (and 1 / w itself) are affine in screen space, so each attribute is a plane
+// the perspective correct value at a pixel is its plane divided by the 1 / w plane
+const unsigned int PLANE_INV_W = 0;
+const unsigned int PLANE_POSITION = 1; // world space xyz, three planes
+const unsigned int PLANE_NORMAL = 4; // three planes
+const unsigned int PLANE_UV = 7; // two planes
+const unsigned int ATTRIBUTE_PLANES = 9;
+
+struct AttributePlanes {
+    float dx[ATTRIBUTE_PLANES], dy[ATTRIBUTE_PLANES], value0[ATTRIBUTE_PLANES]; // same form as the depth plane
+};
+
+// attributes of the 8 pixels of a block row, structure of arrays
+struct PixelAttributes {
+    float position[3][RASTER_BLOCK_SIZE];
+    float normal[3][RASTER_BLOCK_SIZE]; // not normalized
+    float uv[2][RASTER_BLOCK_SIZE];
+    float uvDx[2][RASTER_BLOCK_SIZE]; // uv one pixel right minus uv here, for the texture lod
+    float uvDy[2][RASTER_BLOCK_SIZE]; // one pixel up
+};
+
+// depth tests one triangle against a tile, pixels inside it and nearer than depth take its depth and id
+// (tileX, tileY) is the tile's bottom left pixel and only the first width x height pixels of the tile are touched
+// 8x8 blocks outside an edge are skipped and blocks inside all three skip the edge tests, returns how many pixels passed
+typedef unsigned int (*RasterizeFunction)(const RasterTriangle& triangle, int tileX, int tileY, int width, int height, float* depth, unsigned int* ids, unsigned int id);
+// attributes of the triangle at pixels (x, y) to (x + 7, y), framebuffer coordinates
+typedef void (*InterpolateFunction)(const RasterTriangle& triangle, const AttributePlanes& planes, int x, int y, PixelAttributes& attributes);
+
+enum RasterIsa {
+    RASTER_SCALAR,
+    RASTER_SSE41,
+    RASTER_AVX2, // with FMA
+    RASTER_AVX512 // AVX-512F rasterization, interpolation shares the AVX2 kernel
+};
+
+struct RasterKernels {
+    RasterIsa isa;
+    RasterizeFunction rasterize;
+    InterpolateFunction interpolate;
+};
+
+// triangle setup, screen holds x, y in pixels and the window depth of each vertex
+// returns false when the triangle covers no pixel centre, clockwise triangles are flipped and order says which input vertex went where
+bool SetupRasterTriangle(const glm::vec3 screen[3], unsigned int width, unsigned int height, RasterTriangle& triangle, unsigned int order[3]);
+// planes of the set up triangle's attributes, values are per vertex in the order setup left them and already divided by w
+void SetupAttributePlanes(const RasterTriangle& triangle, const float values[3][ATTRIBUTE_PLANES], AttributePlanes& planes);
+// whether the triangle can cover a pixel centre in the inclusive pixel rectangle, conservative
+bool TriangleOverlapsRect(const RasterTriangle& triangle, int minX, int minY, int maxX, int maxY);
+
+RasterIsa BestRasterIsa(); // the widest kernels this CPU and OS can run
+bool RasterIsaSupported(RasterIsa isa);
+const char* RasterIsaName(RasterIsa isa);
+bool ParseRasterIsa(const std::string& name, RasterIsa& isa); // "scalar", "sse4", "avx2" or "avx512"
+RasterKernels GetRasterKernels(RasterIsa isa); // isa must be supported
+
+#endif
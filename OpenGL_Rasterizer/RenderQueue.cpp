@@ -0,0 +1,170 @@
+#include "RenderQueue.h"
+#include "RenderState.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+static const unsigned int PASS_SHIFT = 60;
+static const unsigned int PROGRAM_SHIFT = 52;
+static const unsigned int MATERIAL_SHIFT = 42;
+static const unsigned int VERTEX_ARRAY_SHIFT = 32;
+static const uint64_t STATE_MASK = ~(uint64_t)0xFFFFFFFFu;
+
+// index of id in slots, appended if it isn't there yet
+template <typename T>
+static unsigned int findSlot(std::vector<T>& slots, const T& id) {
+    for (unsigned int i = 0; i < slots.size(); i++) {
+        if (slots[i] == id) {
+            return i;
+        }
+    }
+    slots.push_back(id);
+    return (unsigned int)slots.size() - 1;
+}
+
+RenderQueue::RenderQueue(GpuProfiler& profiler) : profiler(profiler), stats() {
+    materials.push_back(std::make_pair(0u, 0u));
+}
+
+unsigned int RenderQueue::AddBatch(const DrawBatch& batch) {
+    uint64_t program = findSlot(programs, batch.program);
+    uint64_t material = findSlot(materials, std::make_pair(batch.diffuseTexture, batch.specularTexture));
+    uint64_t vertexArray = findSlot(vertexArrays, batch.vertexArray);
+    // a slot past its field would alias another state and sort into the wrong draws
+    if (batch.pass >= MAX_PASSES || program >= MAX_PROGRAMS || material >= MAX_MATERIALS || vertexArray >= MAX_VERTEX_ARRAYS) {
+        std::cout << "Failed to add render batch " << (batch.name != nullptr ? batch.name : "") << ", its pass, program, textures or vertex array don't fit the sort key" << std::endl;
+        return INVALID_BATCH;
+    }
+    batchKeys.push_back(((uint64_t)batch.pass << PASS_SHIFT) | (program << PROGRAM_SHIFT) | (material << MATERIAL_SHIFT) | (vertexArray << VERTEX_ARRAY_SHIFT));
+    batches.push_back(batch);
+    return (unsigned int)batches.size() - 1;
+}
+
+void RenderQueue::Begin() {
+    items.clear();
+    for (std::pair<const InstanceBuffer* const, std::vector<const InstanceData*>>& buffer : uploaded) {
+        buffer.second.clear();
+    }
+    stats = RenderQueueStats();
+}
+
+RenderQueue::Item RenderQueue::makeItem(unsigned int batch, const InstanceData& instance, float viewDepth) const {
+    float depth = std::max(viewDepth, 0.0f); // behind the camera sorts first, it is clipped anyway
+    uint32_t depthBits;
+    std::memcpy(&depthBits, &depth, sizeof(depthBits));
+    return { batchKeys[batch] | depthBits, batch, &instance };
+}
+
+void RenderQueue::Submit(unsigned int batch, const InstanceData& instance, float viewDepth) {
+    if (batch == INVALID_BATCH) {
+        return;
+    }
+    items.push_back(makeItem(batch, instance, viewDepth));
+}
+
+unsigned int RenderQueue::Reserve(unsigned int count) {
+    unsigned int first = (unsigned int)items.size();
+    items.resize(items.size() + count);
+    return first;
+}
+
+void RenderQueue::SubmitAt(unsigned int slot, unsigned int batch, const InstanceData& instance, float viewDepth) {
+    if (batch == INVALID_BATCH) {
+        items[slot] = { ~(uint64_t)0, INVALID_BATCH, &instance }; // the slot is there already, it sorts last and Execute skips it
+        return;
+    }
+    items[slot] = makeItem(batch, instance, viewDepth);
+}
+
+void RenderQueue::Sort() {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    radixSort();
+    stats.items = (unsigned int)items.size();
+    stats.sortMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// least significant digit first, 8 bits at a time, each pass is stable so the earlier digits stay in order
+// all eight histograms come from one read of the keys, and a digit every key shares (most of the state bits) is skipped
+void RenderQueue::radixSort() {
+    size_t count = items.size();
+    unsigned int histograms[8][256] = {};
+    for (const Item& item : items) {
+        for (unsigned int digit = 0; digit < 8; digit++) {
+            histograms[digit][(item.key >> (digit * 8)) & 0xFF]++;
+        }
+    }
+    scratch.resize(count);
+    for (unsigned int digit = 0; digit < 8; digit++) {
+        unsigned int* histogram = histograms[digit];
+        if (count == 0 || histogram[(items[0].key >> (digit * 8)) & 0xFF] == count) {
+            continue;
+        }
+        unsigned int offset = 0;
+        for (unsigned int bucket = 0; bucket < 256; bucket++) {
+            unsigned int bucketCount = histogram[bucket];
+            histogram[bucket] = offset;
+            offset += bucketCount;
+        }
+        for (const Item& item : items) {
+            scratch[histogram[(item.key >> (digit * 8)) & 0xFF]++] = item;
+        }
+        items.swap(scratch);
+    }
+}
+
+void RenderQueue::Execute(unsigned int pass) {
+    uint64_t passKey = (uint64_t)(pass & 0xF) << PASS_SHIFT;
+    std::vector<Item>::const_iterator it = std::lower_bound(items.begin(), items.end(), passKey,
+        [](const Item& item, uint64_t key) { return item.key < key; });
+    while (it != items.end() && (it->key >> PASS_SHIFT) == pass) {
+        // a run is every item with the same state bits, so one instanced draw
+        std::vector<Item>::const_iterator runEnd = it;
+        while (runEnd != items.end() && (runEnd->key & STATE_MASK) == (it->key & STATE_MASK)) {
+            runEnd++;
+        }
+        if (it->batch == INVALID_BATCH) {
+            break; // dropped items are the last run of the last pass
+        }
+        const DrawBatch& batch = batches[it->batch];
+
+        // the pre-pass and the shading pass sort the same instances the same way, so the second fill is skipped
+        order.clear();
+        for (std::vector<Item>::const_iterator item = it; item != runEnd; item++) {
+            order.push_back(item->instance);
+        }
+        std::vector<const InstanceData*>& current = uploaded[batch.instances];
+        if (current != order) {
+            staging.resize(order.size());
+            for (size_t i = 0; i < order.size(); i++) {
+                staging[i] = *order[i];
+            }
+            batch.instances->SetInstances(staging.data(), (unsigned int)staging.size());
+            current.assign(order.begin(), order.end());
+            stats.uploads++;
+        }
+
+        RenderState::UseProgram(batch.program);
+        if (batch.diffuseTexture != 0) {
+            RenderState::BindTexture2D(0, batch.diffuseTexture);
+        }
+        if (batch.specularTexture != 0) {
+            RenderState::BindTexture2D(1, batch.specularTexture);
+        }
+        RenderState::BindVertexArray(batch.vertexArray);
+        if (batch.name != nullptr) {
+            profiler.BeginPass(batch.name);
+        }
+        batch.instances->DrawElements(GL_TRIANGLES, batch.indexCount, batch.indexType, 0);
+        if (batch.name != nullptr) {
+            profiler.EndPass();
+        }
+        stats.draws++;
+        it = runEnd;
+    }
+}
+
+RenderQueueStats RenderQueue::Stats() const {
+    return stats;
+}
@@ -0,0 +1,88 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "GpuProfiler.h"
+#include "InstanceBuffer.h"
+
+// everything the draws of one mesh in one pass share, registered once at setup
+struct DrawBatch {
+    const char* name; // GPU profiler pass around the batch's draws, nullptr when the caller times the whole pass instead
+    unsigned int pass; // passes run in the order the caller executes them, 0 to 15
+    unsigned int program;
+    unsigned int vertexArray; // must have the index buffer and instances below attached
+    unsigned int diffuseTexture; // bound to unit 0, 0 leaves the unit alone
+    unsigned int specularTexture; // bound to unit 1, 0 leaves the unit alone
+    InstanceBuffer* instances; // refilled with the batch's visible instances in sorted order
+    unsigned int indexCount;
+    GLenum indexType;
+};
+
+// per frame numbers for the profiler output
+struct RenderQueueStats {
+    unsigned int items; // instances submitted, summed over every pass
+    unsigned int draws; // instanced draw calls issued
+    unsigned int uploads; // instance buffer refills, a buffer shared by two passes with the same order is filled once
+    double sortMs; // CPU time of the radix sort only, the keys are built as items are submitted
+};
+
+// draws submitted per object with a 64 bit key and radix sorted once a frame before they are executed
+// key bits, high to low: pass (4) | program (8) | material (10) | vertex array (10) | view depth (32)
+// so a pass switches program, then textures, then meshes as rarely as possible, and inside a mesh the instances go front to back
+// objects of the same batch that end up next to each other are drawn with one instanced call, GL 3.3 has no base instance
+// so the instance buffer is refilled in sorted order (ints of the depth's float bits compare like the floats, since depth is never negative)
+class RenderQueue {
+private:
+    struct Item {
+        uint64_t key;
+        unsigned int batch;
+        const InstanceData* instance;
+    };
+
+    GpuProfiler& profiler;
+    std::vector<DrawBatch> batches;
+    std::vector<uint64_t> batchKeys; // the state bits of each batch's key, depth left as zero
+    std::vector<unsigned int> programs, vertexArrays; // slot -> id, a slot is the key field for that id
+    std::vector<std::pair<unsigned int, unsigned int>> materials; // slot 0 is the empty material
+    std::vector<Item> items;
+    std::vector<Item> scratch; // the other half of the radix sort's ping pong
+    std::vector<InstanceData> staging;
+    std::vector<const InstanceData*> order; // one run's instances, capacity kept between runs
+    // what each instance buffer holds this frame, emptied rather than erased by Begin so the vectors keep their capacity
+    std::unordered_map<const InstanceBuffer*, std::vector<const InstanceData*>> uploaded;
+    RenderQueueStats stats;
+
+    Item makeItem(unsigned int batch, const InstanceData& instance, float viewDepth) const;
+    void radixSort();
+public:
+    // the key fields' sizes, AddBatch turns down a batch that would need a pass or a slot past them
+    static const unsigned int MAX_PASSES = 16;
+    static const unsigned int MAX_PROGRAMS = 256;
+    static const unsigned int MAX_MATERIALS = 1024; // distinct diffuse and specular texture pairs
+    static const unsigned int MAX_VERTEX_ARRAYS = 1024;
+    static const unsigned int INVALID_BATCH = ~0u; // returned for a batch that didn't fit, Submit and SubmitAt drop it
+
+    RenderQueue(GpuProfiler& profiler); // constructor
+    RenderQueue(const RenderQueue&) = delete;
+    RenderQueue& operator=(const RenderQueue&) = delete;
+
+    // methods
+    unsigned int AddBatch(const DrawBatch& batch); // returns the id Submit takes, or INVALID_BATCH
+    void Begin(); // drops last frame's items
+    void Submit(unsigned int batch, const InstanceData& instance, float viewDepth); // the instance must stay alive until the pass is executed
+    // for filling the queue from several threads: Reserve adds count empty items and returns the first one's slot,
+    // then SubmitAt fills each slot once, any thread may fill any slot, but the items must all be filled before Sort
+    unsigned int Reserve(unsigned int count);
+    void SubmitAt(unsigned int slot, unsigned int batch, const InstanceData& instance, float viewDepth);
+    void Sort();
+    void Execute(unsigned int pass); // draws one pass, Sort() first
+    RenderQueueStats Stats() const;
+};
+
+#endif
@@ -0,0 +1,145 @@
+#include "RenderSettings.h"
+
+#include <iostream>
+#include <cstdlib>
+
+// reads an unsigned value following a flag, advancing the index past it
+static bool readUnsigned(int argc, char** argv, int& i, unsigned int& value) {
+    if (i + 1 >= argc) {
+        return false;
+    }
+    char* end = nullptr;
+    long parsed = std::strtol(argv[++i], &end, 10);
+    if (*end != '\0' || parsed <= 0) {
+        return false;
+    }
+    value = static_cast<unsigned int>(parsed);
+    return true;
+}
+
+// reads the string following a flag, advancing the index past it
+static bool readString(int argc, char** argv, int& i, std::string& value) {
+    if (i + 1 >= argc) {
+        return false;
+    }
+    value = argv[++i];
+    return true;
+}
+
+bool ParseRenderSettings(int argc, char** argv, RenderSettings& settings) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--headless") {
+            settings.headless = true;
+        }
+        else if (arg == "--frames") {
+            if (!readUnsigned(argc, argv, i, settings.frames)) {
+                return false;
+            }
+        }
+        else if (arg == "--width") {
+            if (!readUnsigned(argc, argv, i, settings.width)) {
+                return false;
+            }
+        }
+        else if (arg == "--height") {
+            if (!readUnsigned(argc, argv, i, settings.height)) {
+                return false;
+            }
+        }
+        else if (arg == "--output") {
+            if (!readString(argc, argv, i, settings.outputPath)) {
+                return false;
+            }
+        }
+        else if (arg == "--profile-gpu") {
+            settings.profileGpu = true;
+        }
+        else if (arg == "--benchmark") {
+            if (!readString(argc, argv, i, settings.benchmarkPath)) {
+                return false;
+            }
+        }
+        else if (arg == "--report") {
+            if (!readString(argc, argv, i, settings.reportPath)) {
+                return false;
+            }
+        }
+        else if (arg == "--record") {
+            if (!readString(argc, argv, i, settings.recordPath)) {
+                return false;
+            }
+        }
+        else if (arg == "--cubes") {
+            if (!readUnsigned(argc, argv, i, settings.cubes)) {
+                return false;
+            }
+        }
+        else if (arg == "--lights") {
+            if (!readUnsigned(argc, argv, i, settings.lights)) {
+                return false;
+            }
+        }
+        else if (arg == "--deferred") {
+            settings.deferred = true;
+        }
+        else if (arg == "--depth-prepass") {
+            settings.depthPrepass = true;
+        }
+        else if (arg == "--occlusion-cull") {
+            settings.occlusionCull = true;
+        }
+        else if (arg == "--occlusion-queries") {
+            settings.occlusionQueries = true;
+        }
+        else if (arg == "--flat-cull") {
+            settings.flatCull = true;
+        }
+        else if (arg == "--software") {
+            settings.software = true;
+        }
+        else if (arg == "--threads") {
+            if (!readUnsigned(argc, argv, i, settings.threads)) {
+                return false;
+            }
+        }
+        else if (arg == "--raster-isa") {
+            if (!readString(argc, argv, i, settings.rasterIsa)) {
+                return false;
+            }
+        }
+        else if (arg == "--overdraw-sort") {
+            settings.overdrawSort = true;
+        }
+        else {
+            std::cout << "Unknown argument: " << arg << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+void PrintUsage(const char* program) {
+    std::cout << "Usage: " << program << " [options]" << std::endl;
+    std::cout << "  --headless        render offscreen without a window (EGL surfaceless/pbuffer context)" << std::endl;
+    std::cout << "  --frames N        number of frames to render in headless or benchmark mode (default 300)" << std::endl;
+    std::cout << "  --width N         framebuffer width (default 800)" << std::endl;
+    std::cout << "  --height N        framebuffer height (default 600)" << std::endl;
+    std::cout << "  --output FILE     write the last headless frame to FILE as a binary .ppm" << std::endl;
+    std::cout << "  --profile-gpu     print the GPU time of each draw pass once a second" << std::endl;
+    std::cout << "  --benchmark FILE  replay the camera path in FILE over --frames frames and record timings" << std::endl;
+    std::cout << "  --report FILE     where benchmark results are written as JSON (default benchmark.json)" << std::endl;
+    std::cout << "  --record FILE     record the interactive camera movement as a camera path" << std::endl;
+    std::cout << "  --cubes N         add N instanced copies of the textured cube in a grid behind the scene" << std::endl;
+    std::cout << "  --lights N        add N coloured point lights, each fragment only shades the ones in its cluster" << std::endl;
+    std::cout << "  --deferred        render through a G-buffer and a fullscreen lighting pass instead of forward shading" << std::endl;
+    std::cout << "  --depth-prepass   draw depth only first, then shade with GL_EQUAL so hidden fragments are never lit" << std::endl;
+    std::cout << "  --occlusion-cull  skip objects hidden behind the biggest occluders, tested against a small CPU depth buffer" << std::endl;
+    std::cout << "  --occlusion-queries skip objects whose bounding box occlusion query found no samples in an earlier frame" << std::endl;
+    std::cout << "  --flat-cull       frustum cull with a flat SIMD loop over every object instead of the BVH" << std::endl;
+    std::cout << "  --software        render on the CPU without a GPU, tiled and perspective correct, like --headless there is no window" << std::endl;
+    std::cout << "  --threads N       worker threads for loading, culling, queue building and the --software renderer, up to 64 (default: every hardware thread)" << std::endl;
+    std::cout << "                    with --software --benchmark it is the most threads the scaling run goes up to (default 64)" << std::endl;
+    std::cout << "  --raster-isa NAME force the --software raster kernels: scalar, sse4, avx2 or avx512 (default: the widest this CPU supports)" << std::endl;
+    std::cout << "  --overdraw-sort   sort triangle clusters outside-in when optimizing meshes at load" << std::endl;
+}
@@ -0,0 +1,34 @@
+#ifndef RENDER_SETTINGS_H
+#define RENDER_SETTINGS_H
+
+#include <string>
+
+// options read from the command line, the defaults give the normal interactive window
+struct RenderSettings {
+    unsigned int width = 800;
+    unsigned int height = 600;
+    bool headless = false; // render into an offscreen framebuffer without creating a window
+    unsigned int frames = 300; // how many frames a headless run renders before exiting
+    std::string outputPath; // if set, the last headless frame is written here as a .ppm
+    std::string benchmarkPath; // camera path to replay, turns on benchmark mode
+    std::string reportPath = "benchmark.json"; // where benchmark timings are written
+    std::string recordPath; // if set, the interactive camera is recorded here as a camera path
+    bool profileGpu = false; // print per pass GPU timings once a second, always on while benchmarking
+    unsigned int cubes = 0; // extra textured cube instances laid out in a grid
+    unsigned int lights = 0; // extra point lights scattered over the scene, culled per cluster
+    bool deferred = false; // G-buffer geometry pass plus a fullscreen lighting pass instead of forward shading
+    bool depthPrepass = false; // lay down depth first so the lighting shader only runs on visible fragments
+    bool occlusionCull = false; // rasterize the biggest occluders on the CPU and skip objects hidden behind them
+    bool occlusionQueries = false; // skip objects whose bounding box query found nothing last time, GPU side
+    bool flatCull = false; // test every object box in one SIMD loop instead of walking the BVH, for comparison
+    bool software = false; // render on the CPU with SoftwareRenderer, no GL context or window is created
+    unsigned int threads = 0; // job system threads for both paths, 0 uses every hardware thread (up to 64)
+    std::string rasterIsa; // software raster kernels to use ("scalar", "sse4", "avx2" or "avx512"), empty picks the widest the CPU runs
+    bool overdrawSort = false; // also sort triangle clusters for overdraw when optimizing meshes at load
+};
+
+// fills settings from argv, returns false if an argument is unknown or missing its value
+bool ParseRenderSettings(int argc, char** argv, RenderSettings& settings);
+void PrintUsage(const char* program);
+
+#endif
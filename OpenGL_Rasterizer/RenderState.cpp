@@ -0,0 +1,149 @@
+#include "RenderState.h"
+
+// sentinel meaning the cached binding is unknown, so the next bind is always issued
+static const unsigned int UNKNOWN = 0xFFFFFFFFu;
+
+unsigned int RenderState::program = UNKNOWN;
+unsigned int RenderState::vertexArray = UNKNOWN;
+unsigned int RenderState::activeTextureUnit = UNKNOWN;
+unsigned int RenderState::textures[MAX_TEXTURE_UNITS] = {};
+GLenum RenderState::textureTargets[MAX_TEXTURE_UNITS] = {};
+unsigned int RenderState::buffers[BUFFER_TARGETS] = {};
+RenderStateStats RenderState::stats = { 0, 0 };
+
+int RenderState::bufferSlot(GLenum target) {
+    switch (target) {
+    case GL_ARRAY_BUFFER:
+        return 0;
+    case GL_ELEMENT_ARRAY_BUFFER:
+        return 1;
+    case GL_UNIFORM_BUFFER:
+        return 2;
+    default:
+        return -1;
+    }
+}
+
+bool RenderState::changed(unsigned int& cached, unsigned int id) {
+    if (cached == id) {
+        stats.elided++;
+        return false;
+    }
+    cached = id;
+    stats.issued++;
+    return true;
+}
+
+void RenderState::UseProgram(unsigned int id) {
+    if (changed(program, id)) {
+        glUseProgram(id);
+    }
+}
+
+void RenderState::BindVertexArray(unsigned int id) {
+    if (changed(vertexArray, id)) {
+        glBindVertexArray(id);
+        // the element array binding is part of the vao, so whatever was cached no longer applies
+        buffers[bufferSlot(GL_ELEMENT_ARRAY_BUFFER)] = UNKNOWN;
+    }
+}
+
+void RenderState::ActiveTexture(unsigned int unit) {
+    if (changed(activeTextureUnit, unit)) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+    }
+}
+
+void RenderState::BindTexture2D(unsigned int unit, unsigned int id) {
+    BindTexture(unit, GL_TEXTURE_2D, id);
+}
+
+void RenderState::BindTexture(unsigned int unit, GLenum target, unsigned int id) {
+    if (unit >= MAX_TEXTURE_UNITS) {
+        ActiveTexture(unit);
+        glBindTexture(target, id);
+        stats.issued++;
+        return;
+    }
+    if (textures[unit] == id && textureTargets[unit] == target) {
+        stats.elided++;
+        return;
+    }
+    ActiveTexture(unit);
+    textures[unit] = id;
+    textureTargets[unit] = target;
+    stats.issued++;
+    glBindTexture(target, id);
+}
+
+void RenderState::BindBuffer(GLenum target, unsigned int id) {
+    int slot = bufferSlot(target);
+    if (slot < 0) {
+        glBindBuffer(target, id);
+        stats.issued++;
+        return;
+    }
+    if (changed(buffers[slot], id)) {
+        glBindBuffer(target, id);
+    }
+}
+
+void RenderState::BindBufferBase(GLenum target, unsigned int index, unsigned int id) {
+    // indexed bindings are set up once at load time, so they are always issued
+    glBindBufferBase(target, index, id);
+    stats.issued++;
+    int slot = bufferSlot(target);
+    if (slot >= 0) {
+        buffers[slot] = id;
+    }
+}
+
+void RenderState::ForgetProgram(unsigned int id) {
+    if (program == id) {
+        program = UNKNOWN;
+    }
+}
+
+void RenderState::ForgetVertexArray(unsigned int id) {
+    if (vertexArray == id) {
+        vertexArray = UNKNOWN;
+        buffers[bufferSlot(GL_ELEMENT_ARRAY_BUFFER)] = UNKNOWN;
+    }
+}
+
+void RenderState::ForgetTexture(unsigned int id) {
+    for (unsigned int i = 0; i < MAX_TEXTURE_UNITS; i++) {
+        if (textures[i] == id) {
+            textures[i] = UNKNOWN;
+        }
+    }
+}
+
+void RenderState::ForgetBuffer(unsigned int id) {
+    for (unsigned int i = 0; i < BUFFER_TARGETS; i++) {
+        if (buffers[i] == id) {
+            buffers[i] = UNKNOWN;
+        }
+    }
+}
+
+void RenderState::Invalidate() {
+    program = UNKNOWN;
+    vertexArray = UNKNOWN;
+    activeTextureUnit = UNKNOWN;
+    for (unsigned int i = 0; i < MAX_TEXTURE_UNITS; i++) {
+        textures[i] = UNKNOWN;
+    }
+    for (unsigned int i = 0; i < BUFFER_TARGETS; i++) {
+        buffers[i] = UNKNOWN;
+    }
+}
+
+void RenderState::BeginFrame() {
+    stats.issued = 0;
+    stats.elided = 0;
+}
+
+RenderStateStats RenderState::Stats() {
+    return stats;
+}
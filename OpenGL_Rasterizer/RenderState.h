@@ -0,0 +1,50 @@
+#ifndef RENDER_STATE_H
+#define RENDER_STATE_H
+
+#include <glad/glad.h>
+
+// counts of bind calls made through RenderState since the last BeginFrame
+struct RenderStateStats {
+    unsigned int issued; // binds that reached the driver
+    unsigned int elided; // binds skipped because the object was already bound
+};
+
+// remembers what is bound to the context and skips binds that wouldn't change anything
+// every program/vao/buffer/texture bind in the renderer goes through here so the cache never goes stale,
+// and objects that get deleted must be forgotten since GL may hand their id out again
+class RenderState {
+private:
+    static const unsigned int MAX_TEXTURE_UNITS = 32;
+    static const unsigned int BUFFER_TARGETS = 3; // array, element array, uniform
+
+    static unsigned int program;
+    static unsigned int vertexArray;
+    static unsigned int activeTextureUnit;
+    static unsigned int textures[MAX_TEXTURE_UNITS];
+    static GLenum textureTargets[MAX_TEXTURE_UNITS]; // target of the cached texture, a unit is expected to stick to one target
+    static unsigned int buffers[BUFFER_TARGETS];
+    static RenderStateStats stats;
+
+    static int bufferSlot(GLenum target); // -1 for targets that aren't cached
+    static bool changed(unsigned int& cached, unsigned int id); // updates the cache and counts the bind
+public:
+    // methods
+    static void UseProgram(unsigned int id);
+    static void BindVertexArray(unsigned int id);
+    static void ActiveTexture(unsigned int unit); // unit index, not GL_TEXTURE0 + unit
+    static void BindTexture2D(unsigned int unit, unsigned int id); // switches the active unit only if it has to
+    static void BindTexture(unsigned int unit, GLenum target, unsigned int id); // same for other targets, e.g. GL_TEXTURE_BUFFER
+    static void BindBuffer(GLenum target, unsigned int id);
+    static void BindBufferBase(GLenum target, unsigned int index, unsigned int id); // also moves the generic binding, like GL does
+
+    static void ForgetProgram(unsigned int id); // call before deleting, so a recycled id isn't mistaken for bound
+    static void ForgetVertexArray(unsigned int id);
+    static void ForgetTexture(unsigned int id);
+    static void ForgetBuffer(unsigned int id);
+    static void Invalidate(); // forgets everything, for after code that binds GL objects directly
+
+    static void BeginFrame(); // resets the per frame counters
+    static RenderStateStats Stats();
+};
+
+#endif
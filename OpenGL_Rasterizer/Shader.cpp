@@ -0,0 +1,192 @@
+#include "Shader.h"
+#include "RenderState.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#include <glm/gtc/type_ptr.hpp>
+
+Shader::Shader(const std::string& filepath) {
+    ShaderProgramSource source = ParseShader(filepath);
+    renderer_id = CreateShader(source.VertexSource, source.FragmentSource);
+    reflectUniforms();
+}
+
+Shader::~Shader() {
+    RenderState::ForgetProgram(renderer_id);
+    glDeleteProgram(renderer_id);
+}
+
+// Shader loading in from file methods below (following 3 methods) implemented from openGL lecture series
+ShaderProgramSource Shader::ParseShader(const std::string& filepath) {
+    std::ifstream stream(filepath); // opens the file
+    std::string directory = filepath.substr(0, filepath.find_last_of("/\\") + 1); // #include paths are relative to this file
+
+    enum class ShaderType {
+        NONE = -1, VERTEX = 0, FRAGMENT = 1
+    };
+
+    std::string line;
+    std::stringstream ss[2]; // one array for vertex, another for fragment
+    ShaderType type = ShaderType::NONE; // sets the default shadertype to NONE
+
+    while (getline(stream, line)) {
+        // if #shader HAS been found, then set mode, else set the shader elements
+        if (line.find("#shader") != std::string::npos) {
+            // if vertex is found, set to vertex mode, else if fragment found, fragment mode
+            if (line.find("vertex") != std::string::npos) {
+                type = ShaderType::VERTEX;
+            }
+            else if (line.find("fragment") != std::string::npos) {
+                type = ShaderType::FRAGMENT;
+            }
+        }
+        else if (line.find("#include") == 0) {
+            // pastes the quoted file in place, used for the uniform block definitions every shader shares
+            size_t open = line.find('"');
+            size_t close = line.find('"', open + 1);
+            std::ifstream include(directory + line.substr(open + 1, close - open - 1));
+            if (open == std::string::npos || close == std::string::npos || !include) {
+                std::cout << "Failed to include " << line << " in " << filepath << std::endl;
+                continue;
+            }
+            ss[(int)type] << include.rdbuf() << '\n';
+        }
+        else {
+            // adds the line into the string stream for correct position and adds a new line to cap it off
+            ss[(int)type] << line << '\n'; // cast the shader type to an int in order to index into string stream array for correct shader - clever
+        }
+    }
+
+    return { ss[0].str(), ss[1].str() };
+}
+
+unsigned int Shader::CreateShader(const std::string& vertexShader, const std::string& fragmentShader) {
+    unsigned int program = glCreateProgram();
+    unsigned int vShader = CompileShader(GL_VERTEX_SHADER, vertexShader);
+    unsigned int fShader = CompileShader(GL_FRAGMENT_SHADER, fragmentShader);
+    
+    glAttachShader(program, vShader);
+    glAttachShader(program, fShader);
+    glLinkProgram(program);
+    glValidateProgram(program);
+
+    glDeleteShader(vShader);
+    glDeleteShader(fShader);
+
+    return program;
+}
+
+unsigned int Shader::CompileShader(unsigned int type, const std::string& source) {
+    unsigned int id = glCreateShader(type);
+    const char* src = source.c_str();
+    glShaderSource(id, 1, &src, nullptr);
+    glCompileShader(id);
+
+    // error checking 
+    int result;
+    glGetShaderiv(id, GL_COMPILE_STATUS, &result);
+    if (result == GL_FALSE) {
+        int length;
+        glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> message(length); // allows us to set up a char array of length size
+        glGetShaderInfoLog(id, length, &length, message.data());
+        std::cout << "Failed to compile " << (type == GL_VERTEX_SHADER ? "vertex" : "fragment") << " shader" << std::endl;
+        std::cout << message.data() << std::endl;
+        glDeleteShader(id);
+        return 0;
+    }
+
+    return id;
+}
+
+void Shader::addUniform(const std::string& name, int location) {
+    unsigned int hash = HashUniformName(name.c_str());
+    std::unordered_map<unsigned int, int>::iterator it = uniformLocations.find(hash);
+    if (it != uniformLocations.end() && it->second != location) {
+        std::cout << "Uniform name hash collision on " << name << ", rename one of the uniforms" << std::endl;
+    }
+    uniformLocations[hash] = location;
+}
+
+void Shader::reflectUniforms() {
+    int count = 0;
+    int maxLength = 0;
+    glGetProgramiv(renderer_id, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(renderer_id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    std::vector<char> buffer(maxLength > 0 ? maxLength : 1);
+
+    for (int i = 0; i < count; i++) {
+        int length = 0;
+        int size = 0;
+        GLenum type;
+        glGetActiveUniform(renderer_id, i, (GLsizei)buffer.size(), &length, &size, &type, buffer.data());
+        std::string name(buffer.data(), length);
+        int location = glGetUniformLocation(renderer_id, name.c_str());
+        if (location < 0) {
+            continue; // uniforms inside a uniform block have no location
+        }
+        addUniform(name, location);
+
+        // arrays of basic types are reported once as "name[0]", register "name" and every element too
+        size_t bracket = name.rfind("[0]");
+        if (bracket != std::string::npos && bracket + 3 == name.size()) {
+            std::string base = name.substr(0, bracket);
+            addUniform(base, location);
+            for (int element = 1; element < size; element++) {
+                std::string elementName = base + "[" + std::to_string(element) + "]";
+                addUniform(elementName, glGetUniformLocation(renderer_id, elementName.c_str()));
+            }
+        }
+    }
+}
+
+void Shader::Bind() const {
+    RenderState::UseProgram(renderer_id);
+}
+
+void Shader::Unbind() const {
+    RenderState::UseProgram(0);
+}
+
+unsigned int Shader::GetID() const {
+    return renderer_id;
+}
+
+void Shader::BindUniformBlock(const std::string& name, unsigned int binding) const {
+    unsigned int index = glGetUniformBlockIndex(renderer_id, name.c_str());
+    if (index != GL_INVALID_INDEX) {
+        glUniformBlockBinding(renderer_id, index, binding);
+    }
+}
+
+int Shader::GetUniformLocation(UniformId id) const {
+    std::unordered_map<unsigned int, int>::const_iterator it = uniformLocations.find(id.hash);
+    return it == uniformLocations.end() ? -1 : it->second;
+}
+
+void Shader::SetInt(UniformId id, int value) const {
+    glUniform1i(GetUniformLocation(id), value);
+}
+
+void Shader::SetFloat(UniformId id, float value) const {
+    glUniform1f(GetUniformLocation(id), value);
+}
+
+void Shader::SetVec3(UniformId id, float x, float y, float z) const {
+    glUniform3f(GetUniformLocation(id), x, y, z);
+}
+
+void Shader::SetVec3(UniformId id, const glm::vec3& value) const {
+    glUniform3f(GetUniformLocation(id), value.x, value.y, value.z);
+}
+
+void Shader::SetMat3(UniformId id, const glm::mat3& value) const {
+    glUniformMatrix3fv(GetUniformLocation(id), 1, GL_FALSE, glm::value_ptr(value));
+}
+
+void Shader::SetMat4(UniformId id, const glm::mat4& value) const {
+    glUniformMatrix4fv(GetUniformLocation(id), 1, GL_FALSE, glm::value_ptr(value));
+}
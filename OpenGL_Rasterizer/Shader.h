@@ -0,0 +1,66 @@
+#ifndef SHADER_H
+#define SHADER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <string>
+#include <unordered_map>
+
+// shader struct for convenient returning for ParseShader below
+struct ShaderProgramSource {
+    std::string VertexSource;
+    std::string FragmentSource;
+};
+
+// FNV-1a hash of a uniform name, constexpr so names written as literals hash at compile time
+constexpr unsigned int HashUniformName(const char* name, unsigned int hash = 2166136261u) {
+    return *name == '\0' ? hash : HashUniformName(name + 1, (hash ^ (unsigned int)(unsigned char)*name) * 16777619u);
+}
+
+// identifies a uniform by the hash of its name, e.g. shader.SetMat4("model"_uniform, model)
+struct UniformId {
+    unsigned int hash;
+    constexpr UniformId(unsigned int hash) : hash(hash) {}
+};
+
+constexpr UniformId operator""_uniform(const char* name, size_t) {
+    return UniformId(HashUniformName(name));
+}
+
+// linked shader program loaded from a .shader file with #shader vertex / #shader fragment sections
+// a line starting with #include "file" pastes that file (relative to the .shader) into the current section
+// every active uniform is looked up once after linking, so setting one in the render loop is a hash table lookup instead of a driver string lookup
+class Shader {
+private:
+    unsigned int renderer_id;
+    std::unordered_map<unsigned int, int> uniformLocations; // name hash -> location
+
+    static ShaderProgramSource ParseShader(const std::string& filepath);
+    static unsigned int CreateShader(const std::string& vertexShader, const std::string& fragmentShader);
+    static unsigned int CompileShader(unsigned int type, const std::string& source);
+    void reflectUniforms();
+    void addUniform(const std::string& name, int location);
+public:
+    Shader(const std::string& filepath); // constructor, parses, compiles and links the file
+    ~Shader(); // destructor
+    Shader(const Shader&) = delete;
+    Shader& operator=(const Shader&) = delete;
+
+    // methods
+    void Bind() const; // uses the program
+    void Unbind() const;
+    unsigned int GetID() const;
+    int GetUniformLocation(UniformId id) const; // -1 if the program has no such active uniform
+    void BindUniformBlock(const std::string& name, unsigned int binding) const; // connects a uniform block to a buffer binding point, call once at setup
+
+    // setters apply to the currently bound program, so Bind() first
+    void SetInt(UniformId id, int value) const;
+    void SetFloat(UniformId id, float value) const;
+    void SetVec3(UniformId id, float x, float y, float z) const;
+    void SetVec3(UniformId id, const glm::vec3& value) const;
+    void SetMat3(UniformId id, const glm::mat3& value) const;
+    void SetMat4(UniformId id, const glm::mat4& value) const;
+};
+
+#endif
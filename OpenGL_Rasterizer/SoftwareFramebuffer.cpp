@@ -0,0 +1,59 @@
+#include "SoftwareFramebuffer.h"
+
+#include <algorithm>
+#include <fstream>
+
+SoftwareFramebuffer::SoftwareFramebuffer(unsigned int width, unsigned int height)
+    : width(width), height(height), color((size_t)width * height * 3), depth((size_t)width * height, 1.0f) {
+}
+
+void SoftwareFramebuffer::Clear(const glm::vec3& clearColor) {
+    // converted the way a unorm8 attachment stores a float
+    unsigned char rgb[3];
+    for (unsigned int c = 0; c < 3; c++) {
+        rgb[c] = (unsigned char)(std::min(std::max(clearColor[c], 0.0f), 1.0f) * 255.0f + 0.5f);
+    }
+    for (size_t i = 0; i < (size_t)width * height; i++) {
+        color[i * 3] = rgb[0];
+        color[i * 3 + 1] = rgb[1];
+        color[i * 3 + 2] = rgb[2];
+    }
+    std::fill(depth.begin(), depth.end(), 1.0f);
+}
+
+unsigned char* SoftwareFramebuffer::ColorRow(unsigned int y) {
+    return color.data() + (size_t)y * width * 3;
+}
+
+float* SoftwareFramebuffer::DepthRow(unsigned int y) {
+    return depth.data() + (size_t)y * width;
+}
+
+const unsigned char* SoftwareFramebuffer::ColorRow(unsigned int y) const {
+    return color.data() + (size_t)y * width * 3;
+}
+
+const float* SoftwareFramebuffer::DepthRow(unsigned int y) const {
+    return depth.data() + (size_t)y * width;
+}
+
+unsigned int SoftwareFramebuffer::Width() const {
+    return width;
+}
+
+unsigned int SoftwareFramebuffer::Height() const {
+    return height;
+}
+
+bool SoftwareFramebuffer::WritePPM(const std::string& path) const {
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    file << "P6\n" << width << " " << height << "\n255\n";
+    // rows are stored bottom up, ppm starts at the top row
+    for (unsigned int row = 0; row < height; row++) {
+        file.write(reinterpret_cast<const char*>(ColorRow(height - 1 - row)), width * 3);
+    }
+    return file.good();
+}
@@ -0,0 +1,31 @@
+#ifndef SOFTWARE_FRAMEBUFFER_H
+#define SOFTWARE_FRAMEBUFFER_H
+
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+
+// color and depth in ordinary memory, the software renderer's equivalent of Framebuffer
+// rows are stored bottom up like GL's window coordinates, so pixel (0, 0) is the bottom left in both paths
+class SoftwareFramebuffer {
+private:
+    unsigned int width;
+    unsigned int height;
+    std::vector<unsigned char> color; // RGB8
+    std::vector<float> depth; // window depth in [0, 1], 1 is the far plane
+public:
+    SoftwareFramebuffer(unsigned int width, unsigned int height); // constructor
+
+    // methods
+    void Clear(const glm::vec3& clearColor); // color to clearColor and depth to the far plane
+    unsigned char* ColorRow(unsigned int y); // RGB of row y
+    float* DepthRow(unsigned int y);
+    const unsigned char* ColorRow(unsigned int y) const;
+    const float* DepthRow(unsigned int y) const;
+    unsigned int Width() const;
+    unsigned int Height() const;
+    bool WritePPM(const std::string& path) const; // same output as Framebuffer::WritePPM, so the two paths can be diffed
+};
+
+#endif
@@ -0,0 +1,440 @@
+#include "SoftwareRenderer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+
+const float SoftwareRenderer::GUARD_BAND = 4.0f;
+
+static const unsigned int NO_TRIANGLE = 0xFFFFFFFFu;
+// the last index of the last thread would be NO_TRIANGLE, so a thread sets up one triangle fewer than its index bits hold
+static const unsigned int MAX_THREAD_TRIANGLES = (1u << SoftwareRenderer::THREAD_SHIFT) - 1;
+static_assert(((unsigned long long)(SoftwareRenderer::MAX_THREADS - 1) << SoftwareRenderer::THREAD_SHIFT | (MAX_THREAD_TRIANGLES - 1)) < NO_TRIANGLE,
+    "every binned triangle index has to fit 32 bits and differ from NO_TRIANGLE");
+static const unsigned int TRIANGLES_PER_BATCH = 4096; // about how many triangles one geometry job transforms
+static const unsigned int MAX_CLIPPED_VERTICES = 9; // a triangle clipped by six planes
+
+// clip space planes as (x, y, z, w) weights, a vertex is inside when the dot product is >= 0
+static const glm::vec4 CLIP_PLANES[6] = {
+    glm::vec4(0.0f, 0.0f, 1.0f, 1.0f), // near
+    glm::vec4(0.0f, 0.0f, -1.0f, 1.0f), // far
+    glm::vec4(1.0f, 0.0f, 0.0f, SoftwareRenderer::GUARD_BAND),
+    glm::vec4(-1.0f, 0.0f, 0.0f, SoftwareRenderer::GUARD_BAND),
+    glm::vec4(0.0f, 1.0f, 0.0f, SoftwareRenderer::GUARD_BAND),
+    glm::vec4(0.0f, -1.0f, 0.0f, SoftwareRenderer::GUARD_BAND)
+};
+
+static unsigned int outcode(const glm::vec4& clip) {
+    unsigned int code = 0;
+    for (unsigned int i = 0; i < 6; i++) {
+        if (glm::dot(CLIP_PLANES[i], clip) < 0.0f) {
+            code |= 1u << i;
+        }
+    }
+    return code;
+}
+
+// the lod GL picks for a texture from the uv derivatives across one pixel
+static float textureLod(const SoftwareTexture& texture, const glm::vec2& dx, const glm::vec2& dy) {
+    glm::vec2 size = glm::vec2((float)texture.Width(), (float)texture.Height());
+    glm::vec2 texelsX = dx * size, texelsY = dy * size;
+    float rhoSquared = std::max(glm::dot(texelsX, texelsX), glm::dot(texelsY, texelsY));
+    return 0.5f * std::log2(rhoSquared);
+}
+
+SoftwareRenderer::SoftwareRenderer(unsigned int width, unsigned int height, JobSystem& jobs, RasterIsa isa)
+    : target(width, height), jobs(jobs), kernels(GetRasterKernels(isa)), tilesX((width + TILE_SIZE - 1) / TILE_SIZE),
+    tilesY((height + TILE_SIZE - 1) / TILE_SIZE), viewProjection(1.0f), viewPosition(0.0f), lights(),
+    contexts(jobs.WorkerCount()), stats() {
+    // contexts are indexed by worker and the thread index is packed into THREAD_SHIFT's top bits, more workers can't be told apart
+    assert(jobs.WorkerCount() <= MAX_THREADS);
+    for (ThreadContext& context : contexts) {
+        context.bins.resize(tilesX * tilesY);
+        context.tileDepth.resize(TILE_SIZE * TILE_SIZE);
+        context.tileTriangles.resize(TILE_SIZE * TILE_SIZE);
+    }
+}
+
+void SoftwareRenderer::SetLights(const LightBlock& lights, const std::vector<ClusterLight>& pointLights) {
+    this->lights = lights;
+    this->pointLights = pointLights;
+}
+
+void SoftwareRenderer::BeginFrame(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& viewPosition) {
+    viewProjection = projection * view;
+    this->viewPosition = viewPosition;
+    materials.clear();
+    draws.clear();
+    for (ThreadContext& context : contexts) {
+        context.triangles.clear();
+        for (std::vector<BinEntry>& bin : context.bins) {
+            bin.clear();
+        }
+        context.stats = SoftwareRenderStats();
+    }
+    stats = SoftwareRenderStats();
+    stats.isa = kernels.isa;
+    stats.threads = (unsigned int)contexts.size();
+}
+
+void SoftwareRenderer::Draw(const MeshData& mesh, const SoftwareMaterial& material, const InstanceData* instances, unsigned int count) {
+    if (count == 0) {
+        return;
+    }
+    draws.push_back({ &mesh, (unsigned int)materials.size(), instances, count });
+    materials.push_back(material);
+}
+
+void SoftwareRenderer::transformBatch(ThreadContext& context, unsigned int batchIndex) {
+    const GeometryBatch& batch = batches[batchIndex];
+    const DrawCall& draw = draws[batch.draw];
+    const MeshData& mesh = *draw.mesh;
+    bool lit = mesh.floatsPerVertex >= 8;
+    unsigned int vertexCount = mesh.VertexCount();
+    context.vertices.resize(vertexCount);
+    for (unsigned int instance = batch.firstInstance; instance < batch.firstInstance + batch.instanceCount; instance++) {
+        const glm::mat4& model = draw.instances[instance].model;
+        const NormalMatrix& normalMatrix = draw.instances[instance].normalMatrix;
+        glm::mat4 modelViewProjection = viewProjection * model;
+        // the vertex shader, every vertex once per instance
+        for (unsigned int i = 0; i < vertexCount; i++) {
+            const float* vertex = &mesh.vertices[(size_t)i * mesh.floatsPerVertex];
+            glm::vec4 position = glm::vec4(vertex[0], vertex[1], vertex[2], 1.0f);
+            ShadedVertex& shaded = context.vertices[i];
+            shaded.clip = modelViewProjection * position;
+            shaded.position = glm::vec3(model * position);
+            if (lit) {
+                shaded.normal = glm::vec3(normalMatrix.columns[0]) * vertex[3] + glm::vec3(normalMatrix.columns[1]) * vertex[4] + glm::vec3(normalMatrix.columns[2]) * vertex[5];
+                shaded.uv = glm::vec2(vertex[6], vertex[7]);
+            }
+            else {
+                shaded.normal = glm::vec3(0.0f);
+                shaded.uv = glm::vec2(0.0f);
+            }
+        }
+        for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+            const ShadedVertex& v0 = context.vertices[mesh.indices[i]];
+            const ShadedVertex& v1 = context.vertices[mesh.indices[i + 1]];
+            const ShadedVertex& v2 = context.vertices[mesh.indices[i + 2]];
+            context.stats.triangles++;
+            unsigned int code0 = outcode(v0.clip), code1 = outcode(v1.clip), code2 = outcode(v2.clip);
+            if (code0 & code1 & code2) {
+                continue; // all three outside the same plane
+            }
+            if (code0 | code1 | code2) {
+                context.stats.clipped++;
+                clipTriangle(context, v0, v1, v2, batchIndex, draw.material);
+            }
+            else {
+                setupTriangle(context, v0, v1, v2, batchIndex, draw.material);
+            }
+        }
+    }
+}
+
+void SoftwareRenderer::clipTriangle(ThreadContext& context, const ShadedVertex& v0, const ShadedVertex& v1, const ShadedVertex& v2, unsigned int batch, unsigned int material) {
+    ShadedVertex buffers[2][MAX_CLIPPED_VERTICES];
+    ShadedVertex* polygon = buffers[0];
+    ShadedVertex* clipped = buffers[1];
+    polygon[0] = v0;
+    polygon[1] = v1;
+    polygon[2] = v2;
+    unsigned int count = 3;
+    // sutherland hodgman, one plane at a time
+    for (unsigned int plane = 0; plane < 6 && count >= 3; plane++) {
+        unsigned int clippedCount = 0;
+        for (unsigned int i = 0; i < count; i++) {
+            const ShadedVertex& a = polygon[i];
+            const ShadedVertex& b = polygon[(i + 1) % count];
+            float da = glm::dot(CLIP_PLANES[plane], a.clip);
+            float db = glm::dot(CLIP_PLANES[plane], b.clip);
+            if (da >= 0.0f) {
+                clipped[clippedCount++] = a;
+            }
+            if ((da >= 0.0f) != (db >= 0.0f)) {
+                // always lerped from the inside vertex, so a neighbouring triangle sharing the edge gets exactly the same point
+                const ShadedVertex& inside = da >= 0.0f ? a : b;
+                const ShadedVertex& outside = da >= 0.0f ? b : a;
+                float dInside = da >= 0.0f ? da : db;
+                float dOutside = da >= 0.0f ? db : da;
+                float t = dInside / (dInside - dOutside);
+                ShadedVertex& vertex = clipped[clippedCount++];
+                vertex.clip = inside.clip + (outside.clip - inside.clip) * t;
+                vertex.position = inside.position + (outside.position - inside.position) * t;
+                vertex.normal = inside.normal + (outside.normal - inside.normal) * t;
+                vertex.uv = inside.uv + (outside.uv - inside.uv) * t;
+            }
+        }
+        std::swap(polygon, clipped);
+        count = clippedCount;
+    }
+    for (unsigned int i = 1; i + 1 < count; i++) {
+        setupTriangle(context, polygon[0], polygon[i], polygon[i + 1], batch, material);
+    }
+}
+
+void SoftwareRenderer::setupTriangle(ThreadContext& context, const ShadedVertex& v0, const ShadedVertex& v1, const ShadedVertex& v2, unsigned int batch, unsigned int material) {
+    const ShadedVertex* source[3] = { &v0, &v1, &v2 };
+    float width = (float)target.Width(), height = (float)target.Height();
+    glm::vec3 screen[3];
+    float invW[3];
+    for (unsigned int i = 0; i < 3; i++) {
+        invW[i] = 1.0f / source[i]->clip.w;
+        // viewport transform, window origin bottom left like GL
+        screen[i] = glm::vec3((source[i]->clip.x * invW[i] * 0.5f + 0.5f) * width, (source[i]->clip.y * invW[i] * 0.5f + 0.5f) * height,
+            source[i]->clip.z * invW[i] * 0.5f + 0.5f);
+    }
+    // the thread index shares the binned index's bits, a thread holding that many triangles has no index left to hand out
+    if (context.triangles.size() >= MAX_THREAD_TRIANGLES) {
+        context.stats.dropped++;
+        return;
+    }
+    Triangle triangle;
+    unsigned int order[3];
+    if (!SetupRasterTriangle(screen, target.Width(), target.Height(), triangle.raster, order)) {
+        return;
+    }
+    float values[3][ATTRIBUTE_PLANES];
+    triangle.boundsMin = glm::vec3(1.0e30f);
+    triangle.boundsMax = glm::vec3(-1.0e30f);
+    for (unsigned int i = 0; i < 3; i++) {
+        const ShadedVertex& vertex = *source[order[i]];
+        float w = invW[order[i]];
+        values[i][PLANE_INV_W] = w;
+        for (unsigned int c = 0; c < 3; c++) {
+            values[i][PLANE_POSITION + c] = vertex.position[c] * w;
+            values[i][PLANE_NORMAL + c] = vertex.normal[c] * w;
+        }
+        values[i][PLANE_UV] = vertex.uv.x * w;
+        values[i][PLANE_UV + 1] = vertex.uv.y * w;
+        triangle.boundsMin = glm::min(triangle.boundsMin, vertex.position);
+        triangle.boundsMax = glm::max(triangle.boundsMax, vertex.position);
+    }
+    SetupAttributePlanes(triangle.raster, values, triangle.planes);
+    triangle.material = material;
+
+    unsigned int index = (unsigned int)(&context - contexts.data()) << THREAD_SHIFT | (unsigned int)context.triangles.size();
+    const RasterTriangle& raster = triangle.raster;
+    context.triangles.push_back(triangle);
+    context.stats.setup++;
+    // the bounds of a long thin triangle touch many tiles its edges never reach, those are rejected before binning
+    bool singleTile = raster.minX / TILE_SIZE == raster.maxX / TILE_SIZE && raster.minY / TILE_SIZE == raster.maxY / TILE_SIZE;
+    for (unsigned int tileY = raster.minY / TILE_SIZE; tileY <= raster.maxY / TILE_SIZE; tileY++) {
+        for (unsigned int tileX = raster.minX / TILE_SIZE; tileX <= raster.maxX / TILE_SIZE; tileX++) {
+            int x0 = (int)(tileX * TILE_SIZE), y0 = (int)(tileY * TILE_SIZE);
+            if (!singleTile && !TriangleOverlapsRect(raster, x0, y0, x0 + (int)TILE_SIZE - 1, y0 + (int)TILE_SIZE - 1)) {
+                continue;
+            }
+            context.bins[tileY * tilesX + tileX].push_back({ batch, index });
+            context.stats.binned++;
+        }
+    }
+}
+
+void SoftwareRenderer::EndFrame() {
+    // big draws are cut into batches of instances so the geometry spreads over the threads, a batch never splits an instance
+    batches.clear();
+    for (unsigned int d = 0; d < draws.size(); d++) {
+        unsigned int meshTriangles = std::max((unsigned int)(draws[d].mesh->indices.size() / 3), 1u);
+        unsigned int perBatch = std::max(TRIANGLES_PER_BATCH / meshTriangles, 1u);
+        for (unsigned int first = 0; first < draws[d].count; first += perBatch) {
+            batches.push_back({ d, first, std::min(perBatch, draws[d].count - first) });
+        }
+    }
+    unsigned int stealsBefore = jobs.Steals();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    jobs.ParallelFor((unsigned int)batches.size(), 1, [this](unsigned int begin, unsigned int end, unsigned int worker) {
+        for (unsigned int batch = begin; batch < end; batch++) {
+            transformBatch(contexts[worker], batch);
+        }
+    });
+    std::chrono::steady_clock::time_point geometryEnd = std::chrono::steady_clock::now();
+    // one tile per range, how long a tile takes depends on what landed in it so the ranges are kept small for stealing
+    jobs.ParallelFor(tilesX * tilesY, 1, [this](unsigned int begin, unsigned int end, unsigned int worker) {
+        for (unsigned int tile = begin; tile < end; tile++) {
+            renderTile(contexts[worker], tile);
+        }
+    });
+    std::chrono::steady_clock::time_point tilesEnd = std::chrono::steady_clock::now();
+
+    for (const ThreadContext& context : contexts) {
+        stats.triangles += context.stats.triangles;
+        stats.clipped += context.stats.clipped;
+        stats.setup += context.stats.setup;
+        stats.dropped += context.stats.dropped;
+        stats.binned += context.stats.binned;
+        stats.pixelsShaded += context.stats.pixelsShaded;
+        stats.rasterMs += context.stats.rasterMs;
+        stats.shadeMs += context.stats.shadeMs;
+    }
+    stats.geometryMs = std::chrono::duration<double, std::milli>(geometryEnd - start).count();
+    stats.tilesMs = std::chrono::duration<double, std::milli>(tilesEnd - geometryEnd).count();
+    stats.steals = jobs.Steals() - stealsBefore;
+}
+
+const SoftwareRenderer::Triangle& SoftwareRenderer::binnedTriangle(unsigned int triangle) const {
+    return contexts[triangle >> THREAD_SHIFT].triangles[triangle & ((1u << THREAD_SHIFT) - 1)];
+}
+
+void SoftwareRenderer::renderTile(ThreadContext& context, unsigned int tile) {
+    // a thread keeps each batch's triangles together and in order, but stolen batches can come out of order even within one thread's bin,
+    // so a stable sort by batch puts the tile back in submission order
+    std::vector<BinEntry>& bin = context.tileBin;
+    bin.clear();
+    for (const ThreadContext& source : contexts) {
+        const std::vector<BinEntry>& sourceBin = source.bins[tile];
+        bin.insert(bin.end(), sourceBin.begin(), sourceBin.end());
+    }
+    if (bin.empty()) {
+        return;
+    }
+    auto batchOrder = [](const BinEntry& a, const BinEntry& b) { return a.batch < b.batch; };
+    if (!std::is_sorted(bin.begin(), bin.end(), batchOrder)) {
+        std::stable_sort(bin.begin(), bin.end(), batchOrder);
+    }
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<float>& tileDepth = context.tileDepth;
+    std::vector<unsigned int>& tileTriangles = context.tileTriangles;
+    std::vector<unsigned int>& tileLights = context.tileLights;
+    int x0 = (int)(tile % tilesX * TILE_SIZE), y0 = (int)(tile / tilesX * TILE_SIZE);
+    int width = std::min((int)TILE_SIZE, (int)target.Width() - x0);
+    int height = std::min((int)TILE_SIZE, (int)target.Height() - y0);
+    for (int y = 0; y < height; y++) {
+        const float* depthRow = target.DepthRow(y0 + y);
+        for (int x = 0; x < width; x++) {
+            tileDepth[TilePixelIndex(x, y)] = depthRow[x0 + x];
+        }
+    }
+    std::fill(tileTriangles.begin(), tileTriangles.end(), NO_TRIANGLE);
+
+    // visibility first, in submission order with GL_LESS so ties keep the earlier triangle like the GL path
+    // world bounds of the lit triangles that won a pixel at some point, for picking this tile's point lights
+    glm::vec3 boundsMin = glm::vec3(1.0e30f), boundsMax = glm::vec3(-1.0e30f);
+    for (const BinEntry& entry : bin) {
+        const Triangle& triangle = binnedTriangle(entry.triangle);
+        unsigned int won = kernels.rasterize(triangle.raster, x0, y0, width, height, tileDepth.data(), tileTriangles.data(), entry.triangle);
+        if (won > 0 && materials[triangle.material].diffuse != nullptr) {
+            boundsMin = glm::min(boundsMin, triangle.boundsMin);
+            boundsMax = glm::max(boundsMax, triangle.boundsMax);
+        }
+    }
+    std::chrono::steady_clock::time_point rasterEnd = std::chrono::steady_clock::now();
+    context.stats.rasterMs += std::chrono::duration<double, std::milli>(rasterEnd - start).count();
+
+    // the shader only adds a point light closer than its range, so a light whose sphere misses the tile's bounds can't touch any pixel
+    tileLights.clear();
+    for (unsigned int i = 0; i < pointLights.size(); i++) {
+        const ClusterLight& light = pointLights[i];
+        glm::vec3 closest = glm::clamp(light.position, boundsMin, boundsMax);
+        glm::vec3 offset = light.position - closest;
+        if (glm::dot(offset, offset) < light.range * light.range) {
+            tileLights.push_back(i);
+        }
+    }
+
+    // a block row at a time, the attributes of each triangle in it are interpolated for all 8 lanes at once
+    PixelAttributes attributes;
+    for (int y = 0; y < height; y++) {
+        unsigned char* colorRow = target.ColorRow(y0 + y);
+        float* depthRow = target.DepthRow(y0 + y);
+        for (int blockX = 0; blockX < width; blockX += RASTER_BLOCK_SIZE) {
+            const unsigned int* ids = &tileTriangles[TilePixelIndex(blockX, y)];
+            const float* depth = &tileDepth[TilePixelIndex(blockX, y)];
+            int lanes = std::min((int)RASTER_BLOCK_SIZE, width - blockX);
+            unsigned int shaded = 0; // lanes already written
+            for (int lane = 0; lane < lanes; lane++) {
+                depthRow[x0 + blockX + lane] = depth[lane];
+                if (ids[lane] == NO_TRIANGLE || (shaded & (1u << lane))) {
+                    continue;
+                }
+                const Triangle& triangle = binnedTriangle(ids[lane]);
+                const SoftwareMaterial& material = materials[triangle.material];
+                if (material.diffuse != nullptr) {
+                    kernels.interpolate(triangle.raster, triangle.planes, x0 + blockX, y0 + y, attributes);
+                }
+                for (int other = lane; other < lanes; other++) {
+                    if (ids[other] != ids[lane]) {
+                        continue;
+                    }
+                    glm::vec3 color = material.diffuse != nullptr ? shadePixel(material, attributes, other, tileLights) : glm::vec3(1.0f);
+                    unsigned char* pixel = colorRow + (x0 + blockX + other) * 3;
+                    for (unsigned int c = 0; c < 3; c++) {
+                        pixel[c] = (unsigned char)(std::min(std::max(color[c], 0.0f), 1.0f) * 255.0f + 0.5f);
+                    }
+                    shaded |= 1u << other;
+                    context.stats.pixelsShaded++;
+                }
+            }
+        }
+    }
+    context.stats.shadeMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - rasterEnd).count();
+}
+
+glm::vec3 SoftwareRenderer::shadePixel(const SoftwareMaterial& material, const PixelAttributes& attributes, unsigned int lane, const std::vector<unsigned int>& tileLights) const {
+    glm::vec3 position = glm::vec3(attributes.position[0][lane], attributes.position[1][lane], attributes.position[2][lane]);
+    glm::vec3 normal = glm::vec3(attributes.normal[0][lane], attributes.normal[1][lane], attributes.normal[2][lane]);
+    glm::vec2 uv = glm::vec2(attributes.uv[0][lane], attributes.uv[1][lane]);
+    glm::vec2 dx = glm::vec2(attributes.uvDx[0][lane], attributes.uvDx[1][lane]);
+    glm::vec2 dy = glm::vec2(attributes.uvDy[0][lane], attributes.uvDy[1][lane]);
+
+    // fetchSurface from BasicShaders.shader
+    glm::vec3 albedo = material.diffuse->Sample(uv, textureLod(*material.diffuse, dx, dy));
+    glm::vec3 specularMask = material.specular != nullptr ? material.specular->Sample(uv, textureLod(*material.specular, dx, dy)) : glm::vec3(0.0f);
+    normal = glm::normalize(normal);
+    glm::vec3 viewDirection = glm::normalize(viewPosition - position);
+
+    // calcDirectionalLighting
+    const DirectionalLightBlock& directional = lights.directionalLight;
+    glm::vec3 lightDirection = glm::normalize(-directional.direction);
+    float diffuseVal = std::max(glm::dot(normal, lightDirection), 0.0f);
+    float specularVal = std::pow(std::max(glm::dot(viewDirection, glm::reflect(-lightDirection, normal)), 0.0f), 128.0f);
+    glm::vec3 color = directional.ambient * albedo + directional.diffuse * diffuseVal * albedo + directional.specular * specularVal * specularMask;
+
+    // calcPointLighting for the tile's lights within range
+    for (unsigned int index : tileLights) {
+        const ClusterLight& light = pointLights[index];
+        glm::vec3 toLight = light.position - position;
+        float distance = glm::length(toLight);
+        if (!(distance < light.range)) {
+            continue;
+        }
+        lightDirection = toLight / distance;
+        diffuseVal = std::max(glm::dot(normal, lightDirection), 0.0f);
+        specularVal = std::pow(std::max(glm::dot(viewDirection, glm::reflect(-lightDirection, normal)), 0.0f), 128.0f);
+        float attenuation = 1.0f / (light.constant + light.linear * distance + light.quadratic * distance * distance);
+        glm::vec3 ambientPortion = light.ambient * albedo * attenuation;
+        glm::vec3 diffusePortion = light.diffuse * diffuseVal * albedo * attenuation;
+        glm::vec3 specularPortion = light.specular * specularVal * specularMask * attenuation;
+        if (light.spot > 0.5f) {
+            float theta = glm::dot(lightDirection, glm::normalize(-light.direction));
+            float intensity = glm::clamp((theta - light.outerCutoff) / (light.cutoff - light.outerCutoff), 0.0f, 1.0f);
+            diffusePortion *= intensity;
+            specularPortion *= intensity;
+        }
+        color += ambientPortion + diffusePortion + specularPortion;
+    }
+
+    // calcSpotLighting
+    const SpotLightBlock& spot = lights.spotLight;
+    lightDirection = glm::normalize(spot.position - position);
+    float theta = glm::dot(lightDirection, glm::normalize(-spot.direction));
+    if (theta > spot.cutoff) {
+        float intensity = glm::clamp((theta - spot.outerCutoff) / (spot.cutoff - spot.outerCutoff), 0.0f, 1.0f);
+        diffuseVal = std::max(glm::dot(normal, lightDirection), 0.0f);
+        specularVal = std::pow(std::max(glm::dot(viewDirection, glm::reflect(-lightDirection, normal)), 0.0f), 128.0f);
+        color += spot.ambient * albedo + (spot.diffuse * diffuseVal * albedo + spot.specular * specularVal * specularMask) * intensity;
+    }
+    else {
+        color += spot.ambient * albedo;
+    }
+    return color;
+}
+
+SoftwareFramebuffer& SoftwareRenderer::Target() {
+    return target;
+}
+
+SoftwareRenderStats SoftwareRenderer::Stats() const {
+    return stats;
+}
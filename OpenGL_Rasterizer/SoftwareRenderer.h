@@ -0,0 +1,138 @@
+#ifndef SOFTWARE_RENDERER_H
+#define SOFTWARE_RENDERER_H
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+#include "ClusteredLights.h"
+#include "InstanceBuffer.h"
+#include "JobSystem.h"
+#include "MeshBuilder.h"
+#include "RasterKernels.h"
+#include "SoftwareFramebuffer.h"
+#include "SoftwareTexture.h"
+#include "UniformBlocks.h"
+
+// what a draw is shaded with, both textures nullptr gives the flat white of BasicShadersLight.shader
+struct SoftwareMaterial {
+    const SoftwareTexture* diffuse;
+    const SoftwareTexture* specular;
+};
+
+// per frame numbers for the profiler output
+struct SoftwareRenderStats {
+    unsigned int triangles; // submitted, every instance counted
+    unsigned int clipped; // triangles that crossed the near or far plane or the guard band
+    unsigned int setup; // screen triangles that reached the bins
+    unsigned int dropped; // screen triangles a thread set up past its 2^26 - 1 a frame, not drawn
+    unsigned int binned; // triangle and tile pairs
+    unsigned int pixelsShaded;
+    double geometryMs; // vertex transform, clipping, triangle setup and binning, wall time
+    double tilesMs; // rasterizing and shading every tile, wall time
+    double rasterMs; // depth testing every tile's triangles, summed over the threads
+    double shadeMs; // lighting the pixels that won, summed over the threads
+    RasterIsa isa; // which kernels ran
+    unsigned int threads;
+    unsigned int steals; // work ranges a thread took from another's queue
+};
+
+// renders the scene on the CPU into a SoftwareFramebuffer, no GL context needed
+// sort middle: Draw only records the draw, then EndFrame transforms the meshes (8 float pos/normal/uv vertices as handleVAO lays them out,
+// or 3 float positions for unlit meshes) a batch of instances per job, clips against the near and far planes and a guard band,
+// and bins each screen triangle into the TILE_SIZE tiles its edges reach, every thread into its own bins so binning needs no locks
+// the tiles are then rendered in parallel, each by one thread: its triangles from every thread's bins are put back in submission order,
+// depth tested first with the SIMD kernels from RasterKernels keeping only the nearest triangle per pixel, and the lighting from
+// BasicShaders.shader (directional, point and spot, same math as Lighting.glsl) runs once per pixel that won
+// attributes are interpolated perspective correct a block row at a time and textures sampled trilinear with the lod worked out from the uv derivatives
+// the image doesn't depend on the thread count
+class SoftwareRenderer {
+private:
+    struct ShadedVertex {
+        glm::vec4 clip;
+        glm::vec3 position; // world space
+        glm::vec3 normal;
+        glm::vec2 uv;
+    };
+
+    // a triangle after setup, edges and depth for the raster kernels and the perspective correct attribute planes for shading
+    struct Triangle {
+        RasterTriangle raster;
+        AttributePlanes planes;
+        glm::vec3 boundsMin, boundsMax; // world space, for picking a tile's point lights
+        unsigned int material;
+    };
+
+    // a triangle in a tile's bin, batch is the geometry batch it came from, which orders it against the other threads' triangles
+    struct BinEntry {
+        unsigned int batch;
+        unsigned int triangle; // thread index in the top bits, see THREAD_SHIFT
+    };
+
+    struct DrawCall {
+        const MeshData* mesh;
+        unsigned int material;
+        const InstanceData* instances;
+        unsigned int count;
+    };
+
+    // instances of one draw transformed by a single job
+    struct GeometryBatch {
+        unsigned int draw;
+        unsigned int firstInstance, instanceCount;
+    };
+
+    // everything a thread writes while rendering, nothing in here is shared, aligned so two threads' stats never share a cache line
+    struct alignas(64) ThreadContext {
+        std::vector<ShadedVertex> vertices; // one instance at a time, reused
+        std::vector<Triangle> triangles;
+        std::vector<std::vector<BinEntry>> bins; // per tile, in the order this thread set them up
+        // the tile being rendered, the nearest triangle and its depth per pixel, laid out in 8x8 blocks (TilePixelIndex)
+        std::vector<BinEntry> tileBin; // every thread's bin for the tile merged
+        std::vector<float> tileDepth;
+        std::vector<unsigned int> tileTriangles;
+        std::vector<unsigned int> tileLights; // point lights that can reach something in the tile
+        SoftwareRenderStats stats;
+    };
+
+    SoftwareFramebuffer target;
+    JobSystem& jobs;
+    RasterKernels kernels;
+    unsigned int tilesX, tilesY;
+    glm::mat4 viewProjection;
+    glm::vec3 viewPosition;
+    LightBlock lights;
+    std::vector<ClusterLight> pointLights;
+    std::vector<SoftwareMaterial> materials;
+    std::vector<DrawCall> draws;
+    std::vector<GeometryBatch> batches;
+    std::vector<ThreadContext> contexts; // one per job system worker
+    SoftwareRenderStats stats;
+
+    void transformBatch(ThreadContext& context, unsigned int batch);
+    void clipTriangle(ThreadContext& context, const ShadedVertex& v0, const ShadedVertex& v1, const ShadedVertex& v2, unsigned int batch, unsigned int material);
+    void setupTriangle(ThreadContext& context, const ShadedVertex& v0, const ShadedVertex& v1, const ShadedVertex& v2, unsigned int batch, unsigned int material);
+    void renderTile(ThreadContext& context, unsigned int tile);
+    const Triangle& binnedTriangle(unsigned int triangle) const;
+    glm::vec3 shadePixel(const SoftwareMaterial& material, const PixelAttributes& attributes, unsigned int lane, const std::vector<unsigned int>& tileLights) const;
+public:
+    static const unsigned int TILE_SIZE = RASTER_TILE_SIZE;
+    static const float GUARD_BAND; // clip space x and y may reach this many times w before a triangle is clipped
+    static const unsigned int THREAD_SHIFT = 26; // a binned triangle is thread << THREAD_SHIFT | index into that thread's triangles
+    static const unsigned int MAX_THREADS = 64;
+
+    SoftwareRenderer(unsigned int width, unsigned int height, JobSystem& jobs, RasterIsa isa = BestRasterIsa()); // constructor, jobs must have at most MAX_THREADS workers (asserted) and isa must be supported
+    SoftwareRenderer(const SoftwareRenderer&) = delete;
+    SoftwareRenderer& operator=(const SoftwareRenderer&) = delete;
+
+    // methods
+    void SetLights(const LightBlock& lights, const std::vector<ClusterLight>& pointLights); // copied, point lights need their range filled
+    void BeginFrame(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& viewPosition); // empties the bins, doesn't clear the target
+    // the mesh and instances are only read in EndFrame, so they have to stay alive until then
+    void Draw(const MeshData& mesh, const SoftwareMaterial& material, const InstanceData* instances, unsigned int count);
+    void EndFrame(); // transforms and bins every draw, then rasterizes and shades every tile into the target
+    SoftwareFramebuffer& Target();
+    SoftwareRenderStats Stats() const;
+};
+
+#endif
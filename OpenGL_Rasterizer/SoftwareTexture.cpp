@@ -0,0 +1,111 @@
+#include "SoftwareTexture.h"
+
+#include "stb_image.h"
+
+#include <algorithm>
+#include <cmath>
+
+void DownsampleRGBA(const unsigned char* above, unsigned int width, unsigned int height, unsigned char* below) {
+    unsigned int belowWidth = std::max(1u, width / 2), belowHeight = std::max(1u, height / 2);
+    for (unsigned int y = 0; y < belowHeight; y++) {
+        unsigned int y0 = std::min(y * 2, height - 1), y1 = std::min(y * 2 + 1, height - 1);
+        for (unsigned int x = 0; x < belowWidth; x++) {
+            unsigned int x0 = std::min(x * 2, width - 1), x1 = std::min(x * 2 + 1, width - 1);
+            const unsigned char* t00 = &above[((size_t)y0 * width + x0) * 4];
+            const unsigned char* t10 = &above[((size_t)y0 * width + x1) * 4];
+            const unsigned char* t01 = &above[((size_t)y1 * width + x0) * 4];
+            const unsigned char* t11 = &above[((size_t)y1 * width + x1) * 4];
+            unsigned char* out = &below[((size_t)y * belowWidth + x) * 4];
+            for (unsigned int c = 0; c < 4; c++) {
+                out[c] = (unsigned char)((t00[c] + t10[c] + t01[c] + t11[c] + 2) / 4);
+            }
+        }
+    }
+}
+
+SoftwareTexture::SoftwareTexture() {
+}
+
+bool SoftwareTexture::Load(const std::string& path) {
+    int width, height, channels;
+    unsigned char* data = stbi_load(path.c_str(), &width, &height, &channels, 4); // always expanded to RGBA so every level has one layout
+    if (!data) {
+        return false;
+    }
+    SetPixels((unsigned int)width, (unsigned int)height, data);
+    stbi_image_free(data);
+    return true;
+}
+
+void SoftwareTexture::SetPixels(unsigned int width, unsigned int height, const unsigned char* rgba) {
+    levels.clear();
+    levels.push_back({ width, height, std::vector<unsigned char>(rgba, rgba + (size_t)width * height * 4) });
+    // same chain glGenerateMipmap makes, each level is floor(half) of the one above until 1x1
+    while (levels.back().width > 1 || levels.back().height > 1) {
+        const Level& above = levels.back();
+        Level level;
+        level.width = std::max(1u, above.width / 2);
+        level.height = std::max(1u, above.height / 2);
+        level.texels.resize((size_t)level.width * level.height * 4);
+        DownsampleRGBA(above.texels.data(), above.width, above.height, level.texels.data());
+        levels.push_back(std::move(level));
+    }
+}
+
+glm::vec3 SoftwareTexture::bilinear(const Level& level, const glm::vec2& uv) const {
+    // texel centres sit at half integers, GL_REPEAT wraps the four texels independently
+    float u = uv.x * level.width - 0.5f;
+    float v = uv.y * level.height - 0.5f;
+    float uFloor = std::floor(u), vFloor = std::floor(v);
+    float a = u - uFloor, b = v - vFloor;
+    // wrapped while still a float, far outside [0, 1] the texel index doesn't fit an int
+    float uWrapped = uFloor - (float)level.width * std::floor(uFloor / (float)level.width);
+    float vWrapped = vFloor - (float)level.height * std::floor(vFloor / (float)level.height);
+    // rounding can land on the size itself, and an infinite or NaN coordinate gives NaN
+    if (!(uWrapped >= 0.0f && uWrapped < (float)level.width)) {
+        uWrapped = 0.0f;
+    }
+    if (!(vWrapped >= 0.0f && vWrapped < (float)level.height)) {
+        vWrapped = 0.0f;
+    }
+    int x0 = (int)uWrapped, y0 = (int)vWrapped;
+    int x1 = x0 + 1 == (int)level.width ? 0 : x0 + 1;
+    int y1 = y0 + 1 == (int)level.height ? 0 : y0 + 1;
+    const unsigned char* t00 = &level.texels[((size_t)y0 * level.width + x0) * 4];
+    const unsigned char* t10 = &level.texels[((size_t)y0 * level.width + x1) * 4];
+    const unsigned char* t01 = &level.texels[((size_t)y1 * level.width + x0) * 4];
+    const unsigned char* t11 = &level.texels[((size_t)y1 * level.width + x1) * 4];
+    glm::vec3 bottom = glm::vec3(t00[0], t00[1], t00[2]) * (1.0f - a) + glm::vec3(t10[0], t10[1], t10[2]) * a;
+    glm::vec3 top = glm::vec3(t01[0], t01[1], t01[2]) * (1.0f - a) + glm::vec3(t11[0], t11[1], t11[2]) * a;
+    return (bottom * (1.0f - b) + top * b) * (1.0f / 255.0f);
+}
+
+glm::vec3 SoftwareTexture::Sample(const glm::vec2& uv, float lod) const {
+    if (levels.empty()) {
+        return glm::vec3(0.0f); // an incomplete GL texture samples black too
+    }
+    if (!(lod > 0.0f)) {
+        return bilinear(levels[0], uv); // magnified (or a nan lod from a degenerate derivative)
+    }
+    float maxLevel = (float)(levels.size() - 1);
+    lod = std::min(lod, maxLevel);
+    unsigned int level = (unsigned int)lod;
+    float blend = lod - (float)level;
+    glm::vec3 color = bilinear(levels[level], uv);
+    if (blend > 0.0f) {
+        color = color * (1.0f - blend) + bilinear(levels[level + 1], uv) * blend;
+    }
+    return color;
+}
+
+unsigned int SoftwareTexture::Width() const {
+    return levels.empty() ? 0 : levels[0].width;
+}
+
+unsigned int SoftwareTexture::Height() const {
+    return levels.empty() ? 0 : levels[0].height;
+}
+
+bool SoftwareTexture::IsLoaded() const {
+    return !levels.empty();
+}
@@ -0,0 +1,39 @@
+#ifndef SOFTWARE_TEXTURE_H
+#define SOFTWARE_TEXTURE_H
+
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+
+// the next mip level of an RGBA8 image with a 2x2 box filter, below is max(1, floor(width / 2)) by max(1, floor(height / 2))
+// texels like glGenerateMipmap makes, a side that is already 1 texel only averages along the other one
+void DownsampleRGBA(const unsigned char* above, unsigned int width, unsigned int height, unsigned char* below);
+
+// an RGBA8 image with its mip chain in ordinary memory, for the software renderer
+// sampled the way TextureStreamer sets up the GL textures: GL_REPEAT, trilinear when minified and bilinear when magnified
+// (GL_LINEAR_MIPMAP_LINEAR isn't a valid mag filter, so GL keeps the GL_LINEAR default there)
+class SoftwareTexture {
+private:
+    struct Level {
+        unsigned int width, height;
+        std::vector<unsigned char> texels; // RGBA, rows bottom up like glTexImage2D reads them
+    };
+
+    std::vector<Level> levels; // level 0 is the full image, each next one halves it down to 1x1
+
+    glm::vec3 bilinear(const Level& level, const glm::vec2& uv) const;
+public:
+    SoftwareTexture(); // constructor, empty until Load or SetPixels
+
+    // methods
+    bool Load(const std::string& path); // decodes the image with stb_image and builds the mips
+    void SetPixels(unsigned int width, unsigned int height, const unsigned char* rgba); // copies the image and builds the mips with a 2x2 box filter
+    // rgb at uv, lod is log2 of texels per pixel (as GL works it out from the uv derivatives)
+    glm::vec3 Sample(const glm::vec2& uv, float lod) const;
+    unsigned int Width() const;
+    unsigned int Height() const;
+    bool IsLoaded() const;
+};
+
+#endif
@@ -0,0 +1,248 @@
+#include "TextureStreamer.h"
+#include "PngDecoder.h"
+#include "RenderState.h"
+#include "SoftwareTexture.h"
+
+#include "stb_image.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <limits>
+
+TextureStreamer::TextureStreamer(JobSystem& jobs) : jobs(jobs), stats() {
+}
+
+TextureStreamer::~TextureStreamer() {
+    for (std::unique_ptr<Texture>& texture : textures) {
+        jobs.Wait(texture->busy);
+        if (texture->mapped != nullptr) {
+            RenderState::BindBuffer(GL_PIXEL_UNPACK_BUFFER, texture->buffer);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            RenderState::BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            freeBuffers.push_back(texture->buffer);
+        }
+        RenderState::ForgetTexture(texture->id);
+        glDeleteTextures(1, &texture->id);
+    }
+    for (unsigned int buffer : freeBuffers) {
+        RenderState::ForgetBuffer(buffer);
+        glDeleteBuffers(1, &buffer);
+    }
+}
+
+// runs on a worker, decodes to RGBA and builds every level down to 1x1
+// level 0 is decoded in place by PngDecoder, whose inflating and unfiltering spread over the other workers, stb_image takes what it can't read
+void TextureStreamer::decode(Texture& texture, JobSystem& jobs) {
+    PngDecoder png;
+    unsigned char* data = nullptr;
+    int width, height, channels;
+    if (png.Open(texture.path)) {
+        texture.width = png.Width();
+        texture.height = png.Height();
+    }
+    else {
+        data = stbi_load(texture.path.c_str(), &width, &height, &channels, 4); // always expanded to RGBA so every level has one layout
+        if (!data) {
+            texture.decoded = false;
+            return;
+        }
+        texture.width = (unsigned int)width;
+        texture.height = (unsigned int)height;
+    }
+    texture.offsets.assign(1, 0);
+    for (unsigned int level = 0; ; level++) {
+        unsigned int levelWidth = std::max(1u, texture.width >> level), levelHeight = std::max(1u, texture.height >> level);
+        texture.offsets.push_back(texture.offsets.back() + (size_t)levelWidth * levelHeight * 4);
+        if (levelWidth == 1 && levelHeight == 1) {
+            break;
+        }
+    }
+    texture.pixels.resize(texture.offsets.back());
+    if (data == nullptr && !png.Decode(texture.pixels.data(), jobs)) {
+        data = stbi_load(texture.path.c_str(), &width, &height, &channels, 4);
+        if (!data || (unsigned int)width != texture.width || (unsigned int)height != texture.height) {
+            stbi_image_free(data);
+            texture.decoded = false;
+            return;
+        }
+    }
+    if (data != nullptr) {
+        std::memcpy(texture.pixels.data(), data, texture.offsets[1]);
+        stbi_image_free(data);
+    }
+    for (unsigned int level = 1; level < levelCount(texture); level++) {
+        DownsampleRGBA(&texture.pixels[texture.offsets[level - 1]], std::max(1u, texture.width >> (level - 1)), std::max(1u, texture.height >> (level - 1)),
+            &texture.pixels[texture.offsets[level]]);
+    }
+    texture.decoded = true;
+}
+
+unsigned int TextureStreamer::levelCount(const Texture& texture) {
+    return (unsigned int)texture.offsets.size() - 1;
+}
+
+unsigned int TextureStreamer::Request(const std::string& path, const glm::vec4& placeholder) {
+    if (textures.empty()) {
+        firstRequest = std::chrono::steady_clock::now();
+    }
+    std::unique_ptr<Texture> texture(new Texture());
+    texture->path = path;
+    texture->stage = DECODING;
+    texture->decoded = false;
+    texture->width = 0;
+    texture->height = 0;
+    texture->baseLevel = 0;
+    texture->stagedLevel = 0;
+    texture->buffer = 0;
+    texture->mapped = nullptr;
+
+    glGenTextures(1, &texture->id);
+    RenderState::BindTexture2D(0, texture->id);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    // the placeholder alone is a complete texture, the real levels replace it from the coarsest up
+    unsigned char texel[4];
+    for (unsigned int c = 0; c < 4; c++) {
+        texel[c] = (unsigned char)(glm::clamp(placeholder[c], 0.0f, 1.0f) * 255.0f + 0.5f);
+    }
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, texel);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+
+    Texture* queued = texture.get();
+    JobSystem* system = &jobs;
+    jobs.RunBackground([queued, system](unsigned int) { decode(*queued, *system); }, &queued->busy);
+    textures.push_back(std::move(texture));
+    stats.pending++;
+    stats.residentMs = 0.0;
+    return queued->id;
+}
+
+// the levels just finer than what's in, as many as fit in byteBudget but always at least one, packed into one staging buffer
+size_t TextureStreamer::stageLevels(Texture& texture, size_t byteBudget) {
+    unsigned int end = texture.baseLevel;
+    unsigned int finest = end - 1;
+    while (finest > 0 && texture.offsets[end] - texture.offsets[finest - 1] <= byteBudget) {
+        finest--;
+    }
+    size_t bytes = texture.offsets[end] - texture.offsets[finest];
+
+    unsigned int buffer;
+    if (!freeBuffers.empty()) {
+        buffer = freeBuffers.back();
+        freeBuffers.pop_back();
+    }
+    else {
+        glGenBuffers(1, &buffer);
+    }
+    RenderState::BindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+    // new storage every time, so the mapping never waits on an earlier upload that may still be reading the old one
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+    void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    RenderState::BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    if (mapped == nullptr) {
+        std::cout << "Failed to map a staging buffer for " << texture.path << std::endl;
+        freeBuffers.push_back(buffer);
+        texture.stage = FAILED;
+        return 0;
+    }
+    texture.buffer = buffer;
+    texture.mapped = (unsigned char*)mapped;
+    texture.stagedLevel = finest;
+    texture.stage = COPYING;
+    Texture* copying = &texture;
+    jobs.RunBackground([copying, bytes](unsigned int) {
+        std::memcpy(copying->mapped, &copying->pixels[copying->offsets[copying->stagedLevel]], bytes);
+    }, &texture.busy);
+    return bytes;
+}
+
+void TextureStreamer::uploadLevels(Texture& texture) {
+    RenderState::BindBuffer(GL_PIXEL_UNPACK_BUFFER, texture.buffer);
+    // false when the storage was lost while mapped (e.g. a display mode change), the same levels are staged again
+    bool intact = glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_TRUE;
+    texture.mapped = nullptr;
+    if (intact) {
+        RenderState::BindTexture2D(0, texture.id);
+        size_t start = texture.offsets[texture.stagedLevel];
+        for (unsigned int level = texture.stagedLevel; level < texture.baseLevel; level++) {
+            unsigned int levelWidth = std::max(1u, texture.width >> level), levelHeight = std::max(1u, texture.height >> level);
+            // with a buffer bound the pointer is an offset into it
+            glTexImage2D(GL_TEXTURE_2D, level, GL_RGB, levelWidth, levelHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, (const void*)(texture.offsets[level] - start));
+            stats.levelsUploaded++;
+        }
+        stats.bytesUploaded += texture.offsets[texture.baseLevel] - start;
+        if (texture.baseLevel == levelCount(texture)) {
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount(texture) - 1);
+        }
+        // level 0 still holds the placeholder until the last batch, it is below the base level so it's never sampled
+        texture.baseLevel = texture.stagedLevel;
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, texture.baseLevel);
+    }
+    RenderState::BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    freeBuffers.push_back(texture.buffer);
+    texture.buffer = 0;
+    if (texture.baseLevel == 0) {
+        texture.stage = RESIDENT;
+        std::vector<unsigned char>().swap(texture.pixels);
+    }
+    else {
+        texture.stage = READY;
+    }
+}
+
+void TextureStreamer::Update(size_t byteBudget) {
+    stats.levelsUploaded = 0;
+    stats.bytesUploaded = 0;
+    size_t staged = 0;
+    unsigned int pending = 0;
+    for (std::unique_ptr<Texture>& texture : textures) {
+        if (texture->stage == DECODING && texture->busy.Done()) {
+            if (texture->decoded) {
+                texture->baseLevel = levelCount(*texture);
+                texture->stage = READY;
+            }
+            else {
+                std::cout << "Failed to load texture " << texture->path << std::endl;
+                texture->stage = FAILED;
+            }
+        }
+        if (texture->stage == COPYING && texture->busy.Done()) {
+            uploadLevels(*texture);
+        }
+        if (texture->stage == READY) {
+            // the first batch of the frame always goes, later ones only while their next level still fits
+            size_t nextLevel = texture->offsets[texture->baseLevel] - texture->offsets[texture->baseLevel - 1];
+            if (staged == 0 || (staged < byteBudget && nextLevel <= byteBudget - staged)) {
+                staged += stageLevels(*texture, byteBudget - std::min(staged, byteBudget));
+            }
+        }
+        if (texture->stage != RESIDENT && texture->stage != FAILED) {
+            pending++;
+        }
+    }
+    if (stats.pending > 0 && pending == 0) {
+        stats.residentMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - firstRequest).count();
+    }
+    stats.pending = pending;
+}
+
+void TextureStreamer::Finish() {
+    while (Pending() > 0) {
+        for (std::unique_ptr<Texture>& texture : textures) {
+            jobs.Wait(texture->busy);
+        }
+        Update(std::numeric_limits<size_t>::max());
+    }
+}
+
+unsigned int TextureStreamer::Pending() const {
+    return stats.pending;
+}
+
+TextureStreamStats TextureStreamer::Stats() const {
+    return stats;
+}
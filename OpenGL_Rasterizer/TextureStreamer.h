@@ -0,0 +1,80 @@
+#ifndef TEXTURE_STREAMER_H
+#define TEXTURE_STREAMER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "JobSystem.h"
+
+// per frame numbers for the profiler output
+struct TextureStreamStats {
+    unsigned int pending; // textures still missing some of their levels
+    unsigned int levelsUploaded; // this frame
+    size_t bytesUploaded; // this frame
+    double residentMs; // from the first request until every texture had all its levels, 0 while any is still pending
+};
+
+// loads textures without holding up the first frame: Request hands back a texture id straight away with a 1x1 placeholder in it,
+// a job decodes the image (PngDecoder, parallel within the image too) and builds its mip chain (2x2 box filter, the sizes glGenerateMipmap makes) on a worker,
+// and Update moves the levels in through pixel buffer objects coarsest first, so a texture sharpens over a few frames
+// the base level is raised to the finest level in so far, which keeps the texture complete for trilinear filtering the whole time
+// GL 3.3 has no persistent mapping (GL_MAP_PERSISTENT_BIT needs 4.4), so each staging buffer is orphaned and mapped unsynchronized
+// instead, stays mapped while a worker copies the levels in, and is unmapped and read by glTexImage2D on a later Update
+// the decode and copy jobs go through RunBackground, so only worker threads run them and the GL thread never picks one up while it
+// helps with its own loops; with --threads 1 there are no workers and each job runs as it is queued, inside Request or Update
+// wrapping and filtering are GL_REPEAT and trilinear, the textures are owned by the streamer
+class TextureStreamer {
+private:
+    enum Stage { DECODING, READY, COPYING, RESIDENT, FAILED };
+
+    struct Texture {
+        unsigned int id;
+        std::string path;
+        Stage stage; // only touched on the GL thread
+        JobCounter busy; // the decode or copy job in flight
+        // written by the decode job, read on the GL thread once busy is done
+        bool decoded;
+        unsigned int width, height;
+        std::vector<unsigned char> pixels; // RGBA, every level back to back from level 0, freed once resident
+        std::vector<size_t> offsets; // where each level starts in pixels, plus the end
+        unsigned int baseLevel; // finest level uploaded, the level count until the first upload
+        unsigned int stagedLevel; // finest level in the staging buffer, the batch runs from it to baseLevel - 1
+        unsigned int buffer; // staging buffer while COPYING
+        unsigned char* mapped;
+    };
+
+    JobSystem& jobs;
+    std::vector<std::unique_ptr<Texture>> textures;
+    std::vector<unsigned int> freeBuffers; // staging buffers not holding a batch
+    std::chrono::steady_clock::time_point firstRequest;
+    TextureStreamStats stats;
+
+    static void decode(Texture& texture, JobSystem& jobs);
+    static unsigned int levelCount(const Texture& texture);
+    size_t stageLevels(Texture& texture, size_t byteBudget); // maps a staging buffer and queues the copy, returns the bytes staged
+    void uploadLevels(Texture& texture);
+public:
+    static const size_t DEFAULT_BYTE_BUDGET = 4 << 20; // staged per Update, a level bigger than the budget still goes alone
+
+    TextureStreamer(JobSystem& jobs); // constructor, needs a current GL context
+    ~TextureStreamer(); // destructor, waits for the jobs still running and deletes the textures
+    TextureStreamer(const TextureStreamer&) = delete;
+    TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+    // methods
+    unsigned int Request(const std::string& path, const glm::vec4& placeholder); // returns the texture at once, showing placeholder until levels arrive
+    // once a frame on the GL thread: uploads the batches whose copies finished, then stages the next levels up to byteBudget
+    // uses texture unit 0
+    void Update(size_t byteBudget = DEFAULT_BYTE_BUDGET);
+    void Finish(); // streams everything in before returning, for runs whose frames mustn't depend on load times
+    unsigned int Pending() const;
+    TextureStreamStats Stats() const;
+};
+
+#endif
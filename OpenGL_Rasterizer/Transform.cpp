@@ -0,0 +1,34 @@
+#include "Transform.h"
+
+#include <cmath>
+
+NormalMatrix ComputeNormalMatrix(const glm::mat4& model) {
+    glm::vec3 c0 = glm::vec3(model[0]);
+    glm::vec3 c1 = glm::vec3(model[1]);
+    glm::vec3 c2 = glm::vec3(model[2]);
+    NormalMatrix result;
+
+    // uniform scale: every column has the same length and they're all perpendicular, so the 3x3 is s*R and its inverse transpose is R/s
+    float scale2 = glm::dot(c0, c0);
+    const float tolerance = 1e-5f * scale2;
+    bool uniformScale = std::fabs(glm::dot(c1, c1) - scale2) <= tolerance && std::fabs(glm::dot(c2, c2) - scale2) <= tolerance
+        && std::fabs(glm::dot(c0, c1)) <= tolerance && std::fabs(glm::dot(c0, c2)) <= tolerance && std::fabs(glm::dot(c1, c2)) <= tolerance;
+    if (uniformScale && scale2 > 0.0f) {
+        float inverseScale2 = 1.0f / scale2;
+        result.columns[0] = glm::vec4(c0 * inverseScale2, 0.0f);
+        result.columns[1] = glm::vec4(c1 * inverseScale2, 0.0f);
+        result.columns[2] = glm::vec4(c2 * inverseScale2, 0.0f);
+        return result;
+    }
+
+    // inverse transpose = [c1 x c2, c2 x c0, c0 x c1] / det
+    glm::vec3 r0 = glm::cross(c1, c2);
+    glm::vec3 r1 = glm::cross(c2, c0);
+    glm::vec3 r2 = glm::cross(c0, c1);
+    float determinant = glm::dot(c0, r0);
+    float inverseDeterminant = determinant != 0.0f ? 1.0f / determinant : 0.0f; // a flattened model has no valid normals anyway
+    result.columns[0] = glm::vec4(r0 * inverseDeterminant, 0.0f);
+    result.columns[1] = glm::vec4(r1 * inverseDeterminant, 0.0f);
+    result.columns[2] = glm::vec4(r2 * inverseDeterminant, 0.0f);
+    return result;
+}
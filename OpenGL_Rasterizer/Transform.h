@@ -0,0 +1,16 @@
+#ifndef TRANSFORM_H
+#define TRANSFORM_H
+
+#include <glm/glm.hpp>
+
+// normal matrix of a model matrix, the inverse transpose of its upper 3x3
+// columns are vec4 so each one is a 16 byte aligned load, w is always 0
+struct NormalMatrix {
+    glm::vec4 columns[3];
+};
+
+// rotation with uniform scale (and translation) skips the inverse, the result is the 3x3 divided by the scale squared
+// anything else uses the cofactor form: columns are cross products of the 3x3's columns divided by its determinant
+NormalMatrix ComputeNormalMatrix(const glm::mat4& model);
+
+#endif
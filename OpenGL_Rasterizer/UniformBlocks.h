@@ -0,0 +1,58 @@
+#ifndef UNIFORM_BLOCKS_H
+#define UNIFORM_BLOCKS_H
+
+#include <glm/glm.hpp>
+
+// CPU side mirrors of the std140 blocks in res/shaders/UniformBlocks.glsl, keep the two in sync
+// std140 puts every vec3 on a 16 byte boundary, so the structs pair vec3s with a float (or padding) to match
+
+const unsigned int FRAME_BLOCK_BINDING = 0;
+const unsigned int LIGHT_BLOCK_BINDING = 1;
+
+// camera data, uploaded once per frame
+struct FrameBlock {
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::vec3 viewPosition;
+    float padding;
+    glm::uvec4 clusterDimensions; // tiles x, tiles y, depth slices, filled by ClusteredLights
+    glm::vec4 clusterParams; // tile width and height in pixels, depth slice scale and bias
+};
+
+struct DirectionalLightBlock {
+    glm::vec3 direction;
+    float padding0;
+    glm::vec3 ambient;
+    float padding1;
+    glm::vec3 diffuse;
+    float padding2;
+    glm::vec3 specular;
+    float padding3;
+};
+
+struct SpotLightBlock {
+    glm::vec3 position;
+    float cutoff;
+    glm::vec3 direction;
+    float outerCutoff;
+    glm::vec3 ambient;
+    float padding0;
+    glm::vec3 diffuse;
+    float padding1;
+    glm::vec3 specular;
+    float padding2;
+};
+
+// the lights that reach every fragment, only re-uploaded when one changes
+// point lights (and attenuated spot lights) are culled per cluster instead, see ClusteredLights
+struct LightBlock {
+    DirectionalLightBlock directionalLight;
+    SpotLightBlock spotLight;
+};
+
+static_assert(sizeof(FrameBlock) == 176, "FrameBlock must match the std140 FrameData block");
+static_assert(sizeof(DirectionalLightBlock) == 64, "DirectionalLightBlock must match std140 layout");
+static_assert(sizeof(SpotLightBlock) == 80, "SpotLightBlock must match std140 layout");
+static_assert(sizeof(LightBlock) == 64 + 80, "LightBlock must match the std140 LightData block");
+
+#endif
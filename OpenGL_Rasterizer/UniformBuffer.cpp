@@ -0,0 +1,27 @@
+#include "UniformBuffer.h"
+#include "RenderState.h"
+
+UniformBuffer::UniformBuffer(unsigned int size, unsigned int binding) : binding(binding) {
+    glGenBuffers(1, &renderer_id);
+    RenderState::BindBuffer(GL_UNIFORM_BUFFER, renderer_id);
+    glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+    RenderState::BindBufferBase(GL_UNIFORM_BUFFER, binding, renderer_id);
+}
+
+UniformBuffer::~UniformBuffer() {
+    RenderState::ForgetBuffer(renderer_id);
+    glDeleteBuffers(1, &renderer_id);
+}
+
+void UniformBuffer::SetData(const void* data, unsigned int size, unsigned int offset) const {
+    RenderState::BindBuffer(GL_UNIFORM_BUFFER, renderer_id);
+    glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data);
+}
+
+void UniformBuffer::Bind() const {
+    RenderState::BindBuffer(GL_UNIFORM_BUFFER, renderer_id);
+}
+
+void UniformBuffer::Unbind() const {
+    RenderState::BindBuffer(GL_UNIFORM_BUFFER, 0);
+}
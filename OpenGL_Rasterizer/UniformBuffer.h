@@ -0,0 +1,21 @@
+#ifndef UNIFORM_BUFFER_H
+#define UNIFORM_BUFFER_H
+
+#include <glad/glad.h>
+
+// uniform buffer object attached to a fixed binding point, shared by every program whose block is bound to that point
+class UniformBuffer {
+private:
+    unsigned int renderer_id;
+    unsigned int binding;
+public:
+    UniformBuffer(unsigned int size, unsigned int binding); // constructor, allocates size bytes and attaches them to binding
+    ~UniformBuffer(); // destructor
+
+    // methods
+    void SetData(const void* data, unsigned int size, unsigned int offset = 0) const; // uploads part or all of the block
+    void Bind() const; // binds ubo
+    void Unbind() const; // unbinds ubo
+};
+
+#endif
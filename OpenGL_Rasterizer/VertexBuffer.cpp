@@ -1,19 +1,21 @@
-#include "VertexBuffer.h"
-
-VertexBuffer::VertexBuffer(const void* data, unsigned int size) {
-    glGenBuffers(1, &renderer_id);
-    glBindBuffer(GL_ARRAY_BUFFER, renderer_id);
-    glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
-}
-
-VertexBuffer::~VertexBuffer() {
-    glDeleteBuffers(1, &renderer_id);
-}
-
-void VertexBuffer::Bind() const{
-    glBindBuffer(GL_ARRAY_BUFFER, renderer_id);
-}
-
-void VertexBuffer::Unbind() const{
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+#include "VertexBuffer.h"
+#include "RenderState.h"
+
+VertexBuffer::VertexBuffer(const void* data, unsigned int size) {
+    glGenBuffers(1, &renderer_id);
+    RenderState::BindBuffer(GL_ARRAY_BUFFER, renderer_id);
+    glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
+}
+
+VertexBuffer::~VertexBuffer() {
+    RenderState::ForgetBuffer(renderer_id);
+    glDeleteBuffers(1, &renderer_id);
+}
+
+void VertexBuffer::Bind() const{
+    RenderState::BindBuffer(GL_ARRAY_BUFFER, renderer_id);
+}
+
+void VertexBuffer::Unbind() const{
+    RenderState::BindBuffer(GL_ARRAY_BUFFER, 0);
 }
\ No newline at end of file
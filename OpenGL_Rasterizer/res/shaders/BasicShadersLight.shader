@@ -1,25 +1,24 @@
-#shader vertex
-#version 330 core
-
-layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec2 aTexCoord;
-out vec2 texCoord;
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
-
-void main()
-{
-   gl_Position = projection * view * model * vec4(aPos, 1.0f);
-   texCoord = vec2(aTexCoord.x, aTexCoord.y);
-};
-
-#shader fragment
-#version 330 core
-
-out vec4 FragColor;
-
-void main()
-{
-	FragColor = vec4(1.0);
+#shader vertex
+#version 330 core
+#include "UniformBlocks.glsl"
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexCoord;
+layout (location = 3) in mat4 instanceModel; // per instance, takes locations 3 to 6
+out vec2 texCoord;
+
+void main()
+{
+   gl_Position = projection * view * instanceModel * vec4(aPos, 1.0f);
+   texCoord = vec2(aTexCoord.x, aTexCoord.y);
+};
+
+#shader fragment
+#version 330 core
+
+out vec4 FragColor;
+
+void main()
+{
+	FragColor = vec4(1.0);
 };
\ No newline at end of file
@@ -0,0 +1,20 @@
+#shader vertex
+#version 330 core
+#include "UniformBlocks.glsl"
+
+// an object's bounding box for an occlusion query, the light cube mesh stretched over the box by the model matrix
+layout (location = 0) in vec3 aPos;
+uniform mat4 model;
+
+void main()
+{
+   gl_Position = projection * view * model * vec4(aPos, 1.0f);
+};
+
+#shader fragment
+#version 330 core
+
+// only whether any sample passed the depth test matters, color writes are masked off
+void main()
+{
+};
@@ -0,0 +1,43 @@
+#shader vertex
+#version 330 core
+
+// one triangle covering the whole screen, positions come from gl_VertexID so no vertex buffer is needed
+void main()
+{
+   vec2 corner = vec2(float((gl_VertexID << 1) & 2), float(gl_VertexID & 2));
+   gl_Position = vec4(corner * 2.0 - 1.0, 0.0, 1.0);
+};
+
+#shader fragment
+#version 330 core
+#include "UniformBlocks.glsl"
+#include "Lighting.glsl"
+
+// lighting pass of the deferred path, every pixel is shaded once no matter how much geometry overlapped it
+
+out vec4 fragmentColor;
+
+uniform sampler2D gAlbedo;
+uniform sampler2D gSpecular;
+uniform sampler2D gNormal;
+uniform sampler2D gDepth;
+uniform mat4 inverseViewProjection; // clip space back to world space, for rebuilding positions from depth
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    float depth = texelFetch(gDepth, pixel, 0).r;
+    if(depth == 1.0) {
+        discard; // nothing was drawn here, keep the clear color
+    }
+    vec4 clipPosition = vec4(gl_FragCoord.xy / vec2(textureSize(gDepth, 0)) * 2.0 - 1.0, depth * 2.0 - 1.0, 1.0);
+    vec4 worldPosition = inverseViewProjection * clipPosition;
+
+    Surface surface;
+    surface.albedo = texelFetch(gAlbedo, pixel, 0).rgb;
+    surface.specularMask = texelFetch(gSpecular, pixel, 0).rgb;
+    surface.normal = texelFetch(gNormal, pixel, 0).xyz;
+    surface.position = worldPosition.xyz / worldPosition.w;
+    surface.viewDirection = normalize(viewPosition - surface.position);
+    fragmentColor = vec4(shadeSurface(surface), 1.0);
+};
@@ -0,0 +1,21 @@
+#shader vertex
+#version 330 core
+#include "UniformBlocks.glsl"
+
+// depth pre-pass, reads positions from a position only buffer and nothing else
+layout (location = 0) in vec3 aPos;
+layout (location = 3) in mat4 instanceModel; // per instance, takes locations 3 to 6
+invariant gl_Position; // must match the main pass bit for bit or GL_EQUAL would reject its fragments
+
+void main()
+{
+   gl_Position = projection * view * instanceModel * vec4(aPos, 1.0f);
+};
+
+#shader fragment
+#version 330 core
+
+// nothing to output, color writes are masked off and depth comes from the rasterizer
+void main()
+{
+};
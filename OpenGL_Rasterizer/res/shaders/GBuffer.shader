@@ -0,0 +1,44 @@
+#shader vertex
+#version 330 core
+#include "UniformBlocks.glsl"
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoord;
+layout (location = 3) in mat4 instanceModel; // per instance, takes locations 3 to 6
+layout (location = 7) in mat3 instanceNormalMatrix; // per instance, takes locations 7 to 9, computed on the CPU
+invariant gl_Position; // same position math as DepthOnly.shader, so the depth pre-pass can test with GL_EQUAL
+out vec2 texCoord;
+out vec3 normal;
+
+void main()
+{
+   gl_Position = projection * view * instanceModel * vec4(aPos, 1.0f);
+   texCoord = vec2(aTexCoord.x, aTexCoord.y);
+   normal = instanceNormalMatrix * aNormal;
+};
+
+#shader fragment
+#version 330 core
+
+// geometry pass of the deferred path, only stores what the lighting pass needs
+// world position isn't stored, DeferredLighting.shader rebuilds it from the depth buffer
+struct Material {
+	sampler2D diffuse;
+	sampler2D specular;
+};
+
+layout (location = 0) out vec4 gAlbedo;
+layout (location = 1) out vec4 gSpecular;
+layout (location = 2) out vec4 gNormal;
+in vec2 texCoord;
+in vec3 normal;
+
+uniform Material material;
+
+void main()
+{
+	gAlbedo = vec4(vec3(texture(material.diffuse, texCoord)), 1.0);
+	gSpecular = vec4(vec3(texture(material.specular, texCoord)), 1.0);
+	gNormal = vec4(normalize(normal), 0.0);
+};
@@ -0,0 +1,145 @@
+// light math shared by the forward (BasicShaders.shader) and deferred (DeferredLighting.shader) fragment shaders
+// include after UniformBlocks.glsl, fragment stage only since the cluster lookup uses gl_FragCoord
+
+// clustered lights, filled by ClusteredLights every frame
+uniform samplerBuffer clusterLights; // six texels per light, the layout of ClusterLight in ClusteredLights.h
+uniform usamplerBuffer clusterGrid; // (offset, count) into clusterLightIndices per cluster
+uniform usamplerBuffer clusterLightIndices;
+
+// a point light, or a spot light with a cone when spot is 1
+struct ClusterLight {
+	vec3 position;
+	float range;
+	vec3 ambient;
+	float constant;
+	vec3 diffuse;
+	float linear;
+	vec3 specular;
+	float quadratic;
+	vec3 direction;
+	float cutoff;
+	float outerCutoff;
+	float spot;
+};
+
+// everything the lights need to know about the fragment, filled once (from the material textures or the G-buffer) and shared by every light function
+struct Surface {
+	vec3 albedo; // diffuse texture color
+	vec3 specularMask; // specular map value
+	vec3 normal; // normalized
+	vec3 viewDirection; // normalized, fragment to camera
+	vec3 position; // world space
+};
+
+// GLSL function prototypes
+// return type, function name, parameters
+ClusterLight fetchClusterLight(int index);
+vec3 calcDirectionalLighting(DirectionalLight diLight, Surface surface);
+vec3 calcPointLighting(ClusterLight ptLight, Surface surface);
+vec3 calcSpotLighting(SpotLight sptLight, Surface surface);
+vec3 shadeSurface(Surface surface);
+
+ClusterLight fetchClusterLight(int index) {
+	vec4 texel0 = texelFetch(clusterLights, index * 6);
+	vec4 texel1 = texelFetch(clusterLights, index * 6 + 1);
+	vec4 texel2 = texelFetch(clusterLights, index * 6 + 2);
+	vec4 texel3 = texelFetch(clusterLights, index * 6 + 3);
+	vec4 texel4 = texelFetch(clusterLights, index * 6 + 4);
+	vec4 texel5 = texelFetch(clusterLights, index * 6 + 5);
+	ClusterLight light;
+	light.position = texel0.xyz;
+	light.range = texel0.w;
+	light.ambient = texel1.xyz;
+	light.constant = texel1.w;
+	light.diffuse = texel2.xyz;
+	light.linear = texel2.w;
+	light.specular = texel3.xyz;
+	light.quadratic = texel3.w;
+	light.direction = texel4.xyz;
+	light.cutoff = texel4.w;
+	light.outerCutoff = texel5.x;
+	light.spot = texel5.y;
+	return light;
+}
+
+vec3 calcDirectionalLighting(DirectionalLight diLight, Surface surface) {
+	vec3 lightDirection = normalize(-diLight.direction); // normalize the negative since we do calculations from perspective of light coming from camera
+	float diffuseVal = max(dot(surface.normal, lightDirection), 0.0); // handles diffuse directional light shading
+	vec3 reflectionDirection = reflect(-lightDirection, surface.normal);
+	float specularVal = pow(max(dot(surface.viewDirection, reflectionDirection), 0.0), 128); // handles specular directional light shading
+	vec3 ambientPortion = diLight.ambient * surface.albedo;
+	vec3 diffusePortion = diLight.diffuse * diffuseVal * surface.albedo;
+	vec3 specularPortion = diLight.specular * specularVal * surface.specularMask;
+	return (ambientPortion + diffusePortion + specularPortion);
+}
+
+vec3 calcPointLighting(ClusterLight ptLight, Surface surface) {
+	vec3 lightDirection = normalize(ptLight.position - surface.position);
+	float diffuseVal = max(dot(surface.normal, lightDirection), 0.0); // handles diffuse point light shading
+	vec3 reflectionDirection = reflect(-lightDirection, surface.normal);
+	float specularVal = pow(max(dot(surface.viewDirection, reflectionDirection), 0.0), 128); // handles specular point light shading
+	// calc distance between the point light and the fragment, then calculate the attenuation coefficient using formula 1/(Kc + Kl*d + Kq*d*d)
+	float ptLightDistance = length(ptLight.position - surface.position);
+	float attenuationVal = 1.0 / (ptLight.constant + ptLight.linear * ptLightDistance + ptLight.quadratic * ptLightDistance * ptLightDistance);
+	vec3 ambientPortion = ptLight.ambient * surface.albedo;
+	vec3 diffusePortion = ptLight.diffuse * diffuseVal * surface.albedo;
+	vec3 specularPortion = ptLight.specular * specularVal * surface.specularMask;
+	ambientPortion *= attenuationVal;
+	diffusePortion *= attenuationVal;
+	specularPortion *= attenuationVal;
+	if(ptLight.spot > 0.5) {
+		// attenuated spot light, same cone fade as calcSpotLighting but dark outside the cone
+		float theta = dot(lightDirection, normalize(-ptLight.direction));
+		float intensity = clamp((theta - ptLight.outerCutoff) / (ptLight.cutoff - ptLight.outerCutoff), 0.0, 1.0);
+		diffusePortion *= intensity;
+		specularPortion *= intensity;
+	}
+	return (ambientPortion + diffusePortion + specularPortion);
+}
+
+vec3 calcSpotLighting(SpotLight sptLight, Surface surface) {
+	vec3 lightDirection = normalize(sptLight.position - surface.position);
+	float theta = dot(lightDirection, normalize(-sptLight.direction)); // angle between direction the spotlight is pointing and direction to the current fragment, dot prod between the two
+	float epsilon = sptLight.cutoff - sptLight.outerCutoff; // cutoffs MUST be different to avoid div by 0 errors
+	float intensity = clamp((theta - sptLight.outerCutoff) / epsilon, 0.0, 1.0); // uses clamp to ensure intensity doesn't get outside the 0 to 1 inclusive range
+	vec3 color = vec3(1.0, 1.0, 1.0);
+
+	// if the light is within the cutoff range, perform lighting calcs, otherwise, use ambient lighting
+	// > for comparison since the greater the angle the smaller the cos value
+	if(theta > sptLight.cutoff) {
+		float diffuseVal = max(dot(surface.normal, lightDirection), 0.0);
+		vec3 reflectionDirection = reflect(-lightDirection, surface.normal);
+		float specularVal = pow(max(dot(surface.viewDirection, reflectionDirection), 0.0), 128);
+		vec3 ambientPortion = sptLight.ambient * surface.albedo;
+		vec3 diffusePortion = sptLight.diffuse * diffuseVal * surface.albedo;
+		vec3 specularPortion = sptLight.specular * specularVal * surface.specularMask;
+		// for smooth fade out on edge of cone, uses intensity I = (theta - gamma) / (cutoff - gamma) multiplied by diffuse and specular portion of lighting
+		diffusePortion *= intensity;
+		specularPortion *= intensity;
+		color = ambientPortion + diffusePortion + specularPortion;
+	} else {
+		color = sptLight.ambient * surface.albedo;
+	}
+
+	return color;
+}
+
+// every light that reaches the surface
+vec3 shadeSurface(Surface surface) {
+    // calculate each type of lighting, for as many lights as are provided of each
+    vec3 finalColor = calcDirectionalLighting(directionalLight, surface);
+    // only the lights binned into this fragment's cluster
+    float viewDepth = -(view * vec4(surface.position, 1.0)).z;
+    uvec2 tile = min(uvec2(gl_FragCoord.xy / clusterParams.xy), clusterDimensions.xy - 1u);
+    uint slice = uint(clamp(log(viewDepth) * clusterParams.z + clusterParams.w, 0.0, float(clusterDimensions.z - 1u)));
+    int cluster = int(tile.x + clusterDimensions.x * (tile.y + clusterDimensions.y * slice));
+    uvec2 lightRange = texelFetch(clusterGrid, cluster).xy;
+    for(uint i = 0u; i < lightRange.y; i++) {
+		ClusterLight light = fetchClusterLight(int(texelFetch(clusterLightIndices, int(lightRange.x + i)).x));
+		if(length(light.position - surface.position) < light.range) {
+			finalColor += calcPointLighting(light, surface);
+		}
+    }
+    finalColor += calcSpotLighting(spotLight, surface);
+    return finalColor;
+}
@@ -0,0 +1,37 @@
+// std140 blocks shared by every shader, mirrored on the CPU in UniformBlocks.h
+// vec3s take a full 16 bytes in std140, so floats are placed right after them to fill the gap
+
+struct DirectionalLight {
+	vec3 direction;
+
+	vec3 ambient; 
+	vec3 diffuse;
+	vec3 specular;
+};
+
+struct SpotLight {
+	vec3 position;
+	float cutoff; // cos of cutoff angle for range of angles to be lit or not
+	vec3 direction;
+	float outerCutoff; // also labeled as gamma in comments
+
+	vec3 ambient;
+	vec3 diffuse;
+	vec3 specular;
+};
+
+// binding point 0, uploaded once per frame
+layout (std140) uniform FrameData {
+	mat4 view;
+	mat4 projection;
+	vec3 viewPosition;
+	uvec4 clusterDimensions; // tiles x, tiles y, depth slices
+	vec4 clusterParams; // tile width and height in pixels, depth slice scale and bias
+};
+
+// binding point 1, uploaded only when a light changes
+// point lights are culled per cluster and read from texture buffers instead, see Lighting.glsl
+layout (std140) uniform LightData {
+	DirectionalLight directionalLight;
+	SpotLight spotLight;
+};